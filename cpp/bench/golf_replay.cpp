@@ -0,0 +1,303 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// golf_replay.cpp  –  Offline Tracker / PuttStats Replay of a Recording
+//
+// Feeds the detections stored in a .golfrec recording (golf_sim --record)
+// through Tracker and PuttStats with the recorded frame timing – no camera,
+// no GPU, no decoding – and prints one JSON document with:
+//
+//   * time per frame spent in tracking and putt stats (best of --repeat)
+//   * how far the replayed ball track is from the recorded one, so a
+//     tracker change shows up as a deviation from what the live run did
+//   * the putts the replay detected
+//
+// The same recording can then be replayed through the full pipeline with
+// golf_sim --source rec.golfrec.
+//
+// --compare OTHER diffs two recordings frame by frame instead – e.g. two
+// golf_sim --source rec.golfrec --record runs, which must be identical
+// (same frames, detections, tracks and putt states) for replays to be
+// deterministic; exit status 1 on any difference.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "multi_tracker.h"
+#include "putt_stats.h"
+#include "recording.h"
+#include "tracker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// ─── Configuration ──────────────────────────────────────────────────────────
+struct ReplayConfig {
+    std::string recording;
+    golf::TrackerOptions tracker;
+    bool multi_ball = false;
+    int  repeat = 5;
+    std::string compare;          // second recording to diff against
+    std::string out_path;         // empty = stdout
+};
+
+static void print_usage(const char* prog) {
+    std::cout
+        << "Usage: " << prog << " --recording PATH [OPTIONS]\n"
+        << "\n"
+        << "Required:\n"
+        << "  --recording PATH       .golfrec file written by golf_sim --record\n"
+        << "\n"
+        << "Optional:\n"
+        << "  --tracker MODEL        Motion model: ema | kalman (default: ema)\n"
+        << "  --process-noise Q      Kalman acceleration noise, px^2/s^3 (default: 1e5)\n"
+        << "  --measurement-noise R  Kalman detection noise, px^2 (default: 2)\n"
+        << "  --multi-ball           Track every ball with its own id and putt state\n"
+        << "  --repeat N             Timed passes over the recording (default: 5)\n"
+        << "  --compare PATH         Diff against another recording instead (e.g. a\n"
+        << "                         second replay run); exit 1 if they differ\n"
+        << "  --out PATH             Write JSON to PATH instead of stdout\n"
+        << "  -h, --help             Show this help\n";
+}
+
+static ReplayConfig parse_args(int argc, char** argv) {
+    ReplayConfig cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "--recording") && i + 1 < argc) {
+            cfg.recording = argv[++i];
+        } else if ((arg == "--tracker") && i + 1 < argc) {
+            std::string m = argv[++i];
+            if (!golf::parse_tracker_model(m, cfg.tracker.model)) {
+                std::cerr << "Unknown tracker model: " << m << "\n";
+                std::exit(1);
+            }
+        } else if ((arg == "--process-noise") && i + 1 < argc) {
+            cfg.tracker.kalman.process_noise = std::stof(argv[++i]);
+        } else if ((arg == "--measurement-noise") && i + 1 < argc) {
+            cfg.tracker.kalman.measurement_noise = std::stof(argv[++i]);
+        } else if (arg == "--multi-ball") {
+            cfg.multi_ball = true;
+        } else if ((arg == "--repeat") && i + 1 < argc) {
+            cfg.repeat = std::max(1, std::stoi(argv[++i]));
+        } else if ((arg == "--compare") && i + 1 < argc) {
+            cfg.compare = argv[++i];
+        } else if ((arg == "--out") && i + 1 < argc) {
+            cfg.out_path = argv[++i];
+        } else if (arg == "-h" || arg == "--help") {
+            print_usage(argv[0]);
+            std::exit(0);
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            print_usage(argv[0]);
+            std::exit(1);
+        }
+    }
+    if (cfg.recording.empty()) {
+        std::cerr << "Error: --recording is required\n\n";
+        print_usage(argv[0]);
+        std::exit(1);
+    }
+    return cfg;
+}
+
+// ─── Replay ─────────────────────────────────────────────────────────────────
+struct PassResult {
+    double track_s = 0.0;
+    double stats_s = 0.0;
+    double deviation_max = 0.0;   // replayed vs recorded ball position, px
+    double deviation_sum = 0.0;
+    uint64_t compared = 0;        // frames where both tracks were valid
+    uint64_t validity_mismatches = 0;
+    std::unique_ptr<golf::PuttStats> stats;
+};
+
+static PassResult replay(const golf::RecordingReader& rec, const ReplayConfig& cfg) {
+    PassResult r;
+    r.stats = std::make_unique<golf::PuttStats>(/*motion_threshold=*/5.f, /*stop_frames=*/15);
+    golf::Tracker tracker(cfg.tracker);
+    golf::MultiTracker balls(cfg.tracker);
+    std::vector<golf::Detection> dets;
+
+    // dt exactly as the live loop derived it: source timestamps when the
+    // source had them, the host capture clock otherwise
+    double prev_source = -1.0, prev_capture = 0.0;
+    for (size_t i = 0; i < rec.size(); ++i) {
+        const golf::ChunkHeader& c = rec.chunk(i);
+        double dt = 0.0;
+        if (i > 0) {
+            const double source_dt = c.source_time - prev_source;
+            dt = (c.source_time >= 0.0 && prev_source >= 0.0 && source_dt > 0.0)
+                ? source_dt : c.capture_time - prev_capture;
+        }
+        prev_source = c.source_time;
+        prev_capture = c.capture_time;
+        const golf::Detection* d = rec.detections(i);
+        dets.assign(d, d + c.num_detections);
+
+        const auto t0 = Clock::now();
+        golf::TrackedObject ball;
+        tracker.update(dets, dt);
+        if (cfg.multi_ball) {
+            balls.update(dets, dt);
+            const int primary = balls.primary();
+            if (primary >= 0) ball = balls.track(primary);
+        } else {
+            ball = tracker.ball();
+        }
+        const auto t1 = Clock::now();
+        if (cfg.multi_ball) {
+            for (int slot = 0; slot < golf::MultiTracker::kCapacity; ++slot) {
+                r.stats->update(slot, balls.track(slot), dt);
+            }
+        } else {
+            r.stats->update(ball, dt);
+        }
+        const auto t2 = Clock::now();
+        r.track_s += std::chrono::duration<double>(t1 - t0).count();
+        r.stats_s += std::chrono::duration<double>(t2 - t1).count();
+
+        if (ball.valid != c.ball.valid) {
+            ++r.validity_mismatches;
+        } else if (ball.valid) {
+            const double dev = std::hypot(ball.x - c.ball.x, ball.y - c.ball.y);
+            r.deviation_max = std::max(r.deviation_max, dev);
+            r.deviation_sum += dev;
+            ++r.compared;
+        }
+    }
+    return r;
+}
+
+// ─── Compare ────────────────────────────────────────────────────────────────
+static bool same_object(const golf::TrackedObject& a, const golf::TrackedObject& b) {
+    return a.id == b.id && a.class_id == b.class_id && a.x == b.x && a.y == b.y &&
+           a.vx == b.vx && a.vy == b.vy && a.confidence == b.confidence &&
+           a.frames_since_seen == b.frames_since_seen && a.valid == b.valid;
+}
+
+static bool same_detection(const golf::Detection& a, const golf::Detection& b) {
+    return a.class_id == b.class_id && a.confidence == b.confidence &&
+           a.x1 == b.x1 && a.y1 == b.y1 && a.x2 == b.x2 && a.y2 == b.y2;
+}
+
+// Everything but the host capture clock, which differs between runs.
+static bool same_frame(const golf::RecordingReader& a, const golf::RecordingReader& b,
+                       size_t i) {
+    const golf::ChunkHeader& ca = a.chunk(i);
+    const golf::ChunkHeader& cb = b.chunk(i);
+    if (ca.seq != cb.seq || ca.source_time != cb.source_time ||
+        ca.num_detections != cb.num_detections || ca.putt_number != cb.putt_number ||
+        ca.putt_state != cb.putt_state || !same_object(ca.ball, cb.ball) ||
+        !same_object(ca.putter, cb.putter)) {
+        return false;
+    }
+    const golf::Detection* da = a.detections(i);
+    const golf::Detection* db = b.detections(i);
+    for (uint32_t d = 0; d < ca.num_detections; ++d) {
+        if (!same_detection(da[d], db[d])) return false;
+    }
+    return true;
+}
+
+static int compare(const golf::RecordingReader& rec, const ReplayConfig& cfg) {
+    golf::RecordingReader other;
+    if (!other.open(cfg.compare)) return 1;
+
+    const size_t n = std::min(rec.size(), other.size());
+    long first = -1;
+    uint64_t differences = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (same_frame(rec, other, i)) continue;
+        if (first < 0) first = static_cast<long>(i);
+        ++differences;
+    }
+    if (first < 0 && rec.size() != other.size()) first = static_cast<long>(n);
+
+    char buf[512];
+    std::snprintf(buf, sizeof(buf),
+        "{\"recording\":\"%s\",\"compare\":\"%s\",\"frames\":[%zu,%zu],"
+        "\"differing_frames\":%" PRIu64 ",\"first_difference\":%ld,\"identical\":%s}\n",
+        cfg.recording.c_str(), cfg.compare.c_str(), rec.size(), other.size(),
+        differences, first, first < 0 ? "true" : "false");
+    std::cout << buf;
+    return first < 0 ? 0 : 1;
+}
+
+// ─── JSON ───────────────────────────────────────────────────────────────────
+static std::string putts_json(const golf::PuttStats& stats) {
+    std::string out = "[";
+    char buf[256];
+    const auto hist = stats.history();
+    for (size_t i = 0; i < hist.size(); ++i) {
+        const golf::PuttData& p = hist[i];
+        std::snprintf(buf, sizeof(buf),
+            "%s{\"putt_number\":%d,\"launch_speed\":%.2f,\"peak_speed\":%.2f,"
+            "\"total_distance\":%.2f,\"break_distance\":%.2f,\"time_in_motion\":%.3f}",
+            i ? "," : "", p.putt_number, p.launch_speed, p.peak_speed,
+            p.total_distance, p.break_distance, p.time_in_motion);
+        out += buf;
+    }
+    out += "]";
+    return out;
+}
+
+// ─── Main ───────────────────────────────────────────────────────────────────
+int main(int argc, char** argv) {
+    const ReplayConfig cfg = parse_args(argc, argv);
+
+    golf::RecordingReader rec;
+    if (!rec.open(cfg.recording)) return 1;
+    if (!cfg.compare.empty()) return compare(rec, cfg);
+    if (rec.size() == 0) {
+        std::cerr << "[Replay] " << cfg.recording << " has no frames\n";
+        return 1;
+    }
+
+    // Best pass for timing; every pass produces the same tracks
+    PassResult best;
+    for (int pass = 0; pass < cfg.repeat; ++pass) {
+        PassResult r = replay(rec, cfg);
+        if (pass == 0 || r.track_s + r.stats_s < best.track_s + best.stats_s) {
+            best = std::move(r);
+        }
+    }
+
+    const golf::ChunkHeader& last = rec.chunk(rec.size() - 1);
+    const double frames = static_cast<double>(rec.size());
+    char buf[768];
+    std::snprintf(buf, sizeof(buf),
+        "{\"recording\":\"%s\",\"bay\":%d,\"frames\":%zu,\"duration_s\":%.3f,"
+        "\"tracker\":\"%s\",\"multi_ball\":%s,"
+        "\"track_us_per_frame\":%.3f,\"stats_us_per_frame\":%.3f,"
+        "\"ball_deviation_px\":{\"max\":%.3f,\"mean\":%.3f,\"frames\":%" PRIu64 "},"
+        "\"validity_mismatches\":%" PRIu64 ",\"recorded_putts\":%d,\"putts\":",
+        cfg.recording.c_str(), rec.bay(), rec.size(),
+        last.capture_time - rec.chunk(0).capture_time,
+        cfg.tracker.model == golf::TrackerModel::KALMAN ? "kalman" : "ema",
+        cfg.multi_ball ? "true" : "false",
+        best.track_s / frames * 1e6, best.stats_s / frames * 1e6,
+        best.deviation_max, best.compared ? best.deviation_sum / best.compared : 0.0,
+        best.compared, best.validity_mismatches,
+        last.putt_number);
+    const std::string json = buf + putts_json(*best.stats) + "}\n";
+
+    if (cfg.out_path.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream out(cfg.out_path);
+        out << json;
+        if (!out) {
+            std::cerr << "[Replay] Cannot write " << cfg.out_path << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
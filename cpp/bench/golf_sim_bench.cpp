@@ -0,0 +1,825 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// golf_sim_bench.cpp  –  Offline Inference Throughput / Latency Benchmark
+//
+// Replays a video file or the data/images PNG sets from memory at full
+// speed (no pacing) through TrtEngine, sweeping
+//
+//   engine (precision) × preprocess {cpu, gpu} × mode {sync, async}
+//                      × batch size
+//
+// and prints one JSON document with frames/sec, per-stage latency
+// percentiles and GPU utilization for every combination, so results can be
+// diffed across engine builds and driver updates.
+//
+// Heap allocations are counted process-wide during each measured run
+// (after its warm-up); the steady-state hot path is expected to make none,
+// which --check-allocs enforces.  --pipeline N also drives N in-memory
+// cameras through StagedPipeline (capture → preprocess → infer → track →
+// send, every thread golf_sim runs) under the same check.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "trt_engine.h"
+#include "engine_pool.h"
+#include "frame_pipeline.h"
+#include "gpu_preprocess.h"
+#include "cpu_preprocess.h"
+#include "latency_metrics.h"
+#include "putt_stats.h"
+#include "staged_pipeline.h"
+#include "tracker.h"
+#include "unreal_sender.h"
+
+#include <opencv2/opencv.hpp>
+#include <cuda_runtime_api.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifdef GOLF_HAVE_NVML
+#include <nvml.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct EngineSpec {
+    std::string label;     // e.g. "fp16"
+    std::string path;
+};
+
+struct BenchConfig {
+    std::vector<EngineSpec> engines;
+    std::string video_path;
+    std::string images_dir;
+    int  max_frames  = 1000;      // frames decoded into memory
+    int  frames      = 500;       // frames measured per combination
+    int  warmup      = 50;
+    std::vector<int> batches;     // empty = 1 and the engine's max
+    bool cpu_pre = true, gpu_pre = true;
+    bool sync = true, async = true;
+    bool cuda_graph  = false;
+    bool check_allocs = false;    // fail if a measured run allocates
+    int  pipeline_sources = 0;    // StagedPipeline pass with N cameras (0 = off)
+    golf::CpuKernel cpu_kernel = golf::CpuKernel::AUTO;
+    float conf_thresh = 0.5f;
+    std::string out_path;         // empty = stdout
+};
+
+struct RunSpec {
+    bool gpu_pre;
+    bool async;
+    int  batch;
+};
+
+static void print_usage(const char* prog) {
+    std::cout
+        << "Usage: " << prog << " [OPTIONS]\n"
+        << "\n"
+        << "Required:\n"
+        << "  --engine [LABEL=]PATH  TensorRT engine (repeat to compare builds,\n"
+        << "                         e.g. --engine fp16=a.engine --engine int8=b.engine)\n"
+        << "                         or an .onnx model built at the label's precision\n"
+        << "                         (fp32 | fp16 | int8)\n"
+        << "  --video PATH           Replay frames from a video file, or\n"
+        << "  --images DIR           replay DIR/train/*.png and DIR/val/*.png\n"
+        << "\n"
+        << "Optional:\n"
+        << "  --max-frames N         Frames loaded into memory (default: 1000)\n"
+        << "  --frames N             Frames measured per combination (default: 500)\n"
+        << "  --warmup N             Unmeasured frames per combination (default: 50)\n"
+        << "  --batch LIST           Batch sizes, comma-separated (default: 1,max)\n"
+        << "  --preprocess LIST      cpu,gpu (default: both)\n"
+        << "  --mode LIST            sync,async (default: both)\n"
+        << "  --cuda-graph           Replay inference as a captured CUDA graph\n"
+        << "  --check-allocs         Fail if the measured hot path allocates\n"
+        << "  --pipeline N           Also run N in-memory cameras through the full\n"
+        << "                         StagedPipeline (capture → track → send)\n"
+        << "  --cpu-kernel K         CPU preprocess: auto | scalar | avx2 | neon\n"
+        << "                         (default: auto)\n"
+        << "  --conf THRESH          Detection confidence threshold (default: 0.5)\n"
+        << "  --out PATH             Write JSON to PATH instead of stdout\n"
+        << "  -h, --help             Show this help\n";
+}
+
+static std::vector<std::string> split(const std::string& s) {
+    std::vector<std::string> out;
+    size_t start = 0;
+    while (start <= s.size()) {
+        size_t end = s.find(',', start);
+        if (end == std::string::npos) end = s.size();
+        if (end > start) out.push_back(s.substr(start, end - start));
+        start = end + 1;
+    }
+    return out;
+}
+
+static BenchConfig parse_args(int argc, char** argv) {
+    BenchConfig cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "--engine") && i + 1 < argc) {
+            std::string v = argv[++i];
+            const size_t eq = v.find('=');
+            EngineSpec e;
+            e.label = eq == std::string::npos ? v : v.substr(0, eq);
+            e.path = eq == std::string::npos ? v : v.substr(eq + 1);
+            cfg.engines.push_back(e);
+        } else if ((arg == "--video") && i + 1 < argc) {
+            cfg.video_path = argv[++i];
+        } else if ((arg == "--images") && i + 1 < argc) {
+            cfg.images_dir = argv[++i];
+        } else if ((arg == "--max-frames") && i + 1 < argc) {
+            cfg.max_frames = std::stoi(argv[++i]);
+        } else if ((arg == "--frames") && i + 1 < argc) {
+            cfg.frames = std::stoi(argv[++i]);
+        } else if ((arg == "--warmup") && i + 1 < argc) {
+            cfg.warmup = std::stoi(argv[++i]);
+        } else if ((arg == "--batch") && i + 1 < argc) {
+            for (const auto& b : split(argv[++i])) cfg.batches.push_back(std::stoi(b));
+        } else if ((arg == "--preprocess") && i + 1 < argc) {
+            const auto list = split(argv[++i]);
+            cfg.cpu_pre = std::find(list.begin(), list.end(), "cpu") != list.end();
+            cfg.gpu_pre = std::find(list.begin(), list.end(), "gpu") != list.end();
+        } else if ((arg == "--mode") && i + 1 < argc) {
+            const auto list = split(argv[++i]);
+            cfg.sync = std::find(list.begin(), list.end(), "sync") != list.end();
+            cfg.async = std::find(list.begin(), list.end(), "async") != list.end();
+        } else if (arg == "--cuda-graph") {
+            cfg.cuda_graph = true;
+        } else if (arg == "--check-allocs") {
+            cfg.check_allocs = true;
+        } else if ((arg == "--pipeline") && i + 1 < argc) {
+            cfg.pipeline_sources = std::max(0, std::stoi(argv[++i]));
+        } else if ((arg == "--cpu-kernel") && i + 1 < argc) {
+            std::string k = argv[++i];
+            if (!golf::parse_cpu_kernel(k, cfg.cpu_kernel)) {
+                std::cerr << "Unknown CPU kernel: " << k << "\n";
+                std::exit(1);
+            }
+        } else if ((arg == "--conf") && i + 1 < argc) {
+            cfg.conf_thresh = std::stof(argv[++i]);
+        } else if ((arg == "--out") && i + 1 < argc) {
+            cfg.out_path = argv[++i];
+        } else if (arg == "-h" || arg == "--help") {
+            print_usage(argv[0]);
+            std::exit(0);
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            print_usage(argv[0]);
+            std::exit(1);
+        }
+    }
+    if (cfg.engines.empty() || (cfg.video_path.empty() && cfg.images_dir.empty())) {
+        std::cerr << "Error: --engine and one of --video / --images are required\n\n";
+        print_usage(argv[0]);
+        std::exit(1);
+    }
+    return cfg;
+}
+
+// ─── Allocation counter ─────────────────────────────────────────────────────
+// Replaces global operator new for the whole process and counts calls on
+// every thread – the pipeline's stage threads included.  cv::Mat buffers
+// are covered too: every allocating Mat also news its UMatData header.
+static std::atomic<uint64_t> g_allocations{0};
+
+static uint64_t allocations() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+// ─── Frame loading ──────────────────────────────────────────────────────────
+// Everything is decoded up front so file I/O and decode never show up in
+// the measurements.
+static std::vector<cv::Mat> load_frames(const BenchConfig& cfg) {
+    std::vector<cv::Mat> frames;
+    if (!cfg.video_path.empty()) {
+        cv::VideoCapture cap(cfg.video_path);
+        cv::Mat f;
+        while (static_cast<int>(frames.size()) < cfg.max_frames && cap.read(f)) {
+            frames.push_back(f.clone());
+        }
+    } else {
+        std::vector<std::string> files;
+        for (const char* split_name : {"train", "val"}) {
+            std::vector<std::string> found;
+            cv::glob(cfg.images_dir + "/" + split_name + "/*.png", found);
+            files.insert(files.end(), found.begin(), found.end());
+        }
+        std::sort(files.begin(), files.end());
+        for (const auto& path : files) {
+            if (static_cast<int>(frames.size()) >= cfg.max_frames) break;
+            cv::Mat f = cv::imread(path, cv::IMREAD_COLOR);
+            if (!f.empty()) frames.push_back(f);
+        }
+    }
+    return frames;
+}
+
+// ─── CPU kernel check ───────────────────────────────────────────────────────
+// The vectorised BGR → planar RGB kernel must match the scalar one bit for
+// bit, or the CPU and GPU numbers below compare different networks.
+static bool cpu_kernel_exact(const std::vector<cv::Mat>& frames) {
+    std::vector<float> ref, out;
+    const size_t n = std::min<size_t>(frames.size(), 8);
+    for (size_t i = 0; i < n; ++i) {
+        const size_t len = 3 * frames[i].total();
+        ref.resize(len);
+        out.resize(len);
+        golf::bgr_to_planar_rgb(frames[i], ref.data(), golf::CpuKernel::SCALAR);
+        golf::bgr_to_planar_rgb(frames[i], out.data());
+        if (std::memcmp(ref.data(), out.data(), len * sizeof(float)) != 0) return false;
+    }
+    return true;
+}
+
+// ─── GPU utilization ────────────────────────────────────────────────────────
+// NVML is sampled on a side thread while a combination runs; without NVML
+// the report falls back to GPU busy time from the CUDA events.
+class UtilizationSampler {
+public:
+    void start() {
+#ifdef GOLF_HAVE_NVML
+        if (!device_) {
+            int dev = 0;
+            cudaGetDevice(&dev);
+            if (nvmlInit_v2() != NVML_SUCCESS ||
+                nvmlDeviceGetHandleByIndex_v2(static_cast<unsigned>(dev), &device_) != NVML_SUCCESS) {
+                device_ = nullptr;
+                return;
+            }
+        }
+        sum_ = 0;
+        samples_ = 0;
+        running_ = true;
+        thread_ = std::thread([this]() {
+            while (running_) {
+                nvmlUtilization_t u;
+                if (nvmlDeviceGetUtilizationRates(device_, &u) == NVML_SUCCESS) {
+                    sum_ += u.gpu;
+                    ++samples_;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+        });
+#endif
+    }
+
+    /// Mean utilization in percent, or a negative value if unavailable.
+    double stop() {
+#ifdef GOLF_HAVE_NVML
+        running_ = false;
+        if (thread_.joinable()) thread_.join();
+        if (samples_ > 0) return static_cast<double>(sum_) / samples_;
+#endif
+        return -1.0;
+    }
+
+private:
+#ifdef GOLF_HAVE_NVML
+    nvmlDevice_t device_ = nullptr;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> samples_{0};
+#endif
+};
+
+// ─── Runner ─────────────────────────────────────────────────────────────────
+struct RunResult {
+    uint64_t frames = 0;
+    double seconds = 0.0;
+    double gpu_busy_ms = 0.0;     // sum of per-call GPU time
+    double gpu_util = -1.0;       // NVML, percent
+    uint64_t allocations = 0;     // heap allocations, all threads
+    std::unique_ptr<golf::LatencyMetrics> stages;
+    std::unique_ptr<golf::LatencyHistogram> latency;   // submit → parsed
+};
+
+class Runner {
+public:
+    Runner(golf::TrtEngine& engine, const std::vector<cv::Mat>& frames,
+           float conf_thresh)
+        : engine_(engine), frames_(frames), conf_thresh_(conf_thresh) {}
+
+    bool run(const RunSpec& spec, int num_frames, RunResult& r);
+
+private:
+    struct Slot {
+        bool busy = false;
+        int images = 0;
+        Clock::time_point submitted;
+        std::vector<golf::ImageTransform> xf;
+    };
+
+    bool submit(int s, const RunSpec& spec, RunResult& r);
+    bool collect(int s, RunResult& r);
+
+    golf::TrtEngine& engine_;
+    const std::vector<cv::Mat>& frames_;
+    float conf_thresh_;
+    golf::GpuPreprocessor pre_[golf::TrtEngine::kNumSlots];
+    Slot slots_[golf::TrtEngine::kNumSlots];
+    std::vector<float> blob_;
+    std::vector<golf::Detection> dets_;
+    size_t next_ = 0;
+};
+
+bool Runner::submit(int s, const RunSpec& spec, RunResult& r) {
+    Slot& slot = slots_[s];
+    slot.images = spec.batch;
+    slot.xf.resize(spec.batch);
+    slot.submitted = Clock::now();
+
+    const int net_h = engine_.input_h();
+    const int net_w = engine_.input_w();
+    for (int k = 0; k < spec.batch; ++k) {
+        const cv::Mat& frame = frames_[next_++ % frames_.size()];
+        slot.xf[k] = golf::ImageTransform::stretch(frame.cols, frame.rows, net_w, net_h);
+        if (spec.gpu_pre) {
+            if (!pre_[s].stage(k, frame, engine_.input_buffer(s, k),
+                               net_h, net_w, slot.xf[k])) {
+                return false;
+            }
+        } else {
+            golf::StageTimer timer(r.stages.get(), golf::Stage::PREPROCESS);
+            golf::FramePipeline::preprocess(frame, net_h, net_w, blob_);
+            std::memcpy(engine_.host_input(s, k), blob_.data(),
+                        blob_.size() * sizeof(float));
+        }
+    }
+
+    bool ok;
+    if (spec.gpu_pre) {
+        pre_[s].set_batch(spec.batch);
+        ok = engine_.infer_async(s, nullptr, &pre_[s], spec.batch);
+    } else {
+        ok = engine_.infer_async(s, engine_.host_input(s), nullptr, spec.batch);
+    }
+    slot.busy = ok;
+    return ok;
+}
+
+bool Runner::collect(int s, RunResult& r) {
+    Slot& slot = slots_[s];
+    slot.busy = false;
+    const float* out = engine_.wait(s);
+    if (!out) return false;
+
+    golf::GpuTimings t;
+    if (engine_.timings(s, t)) {
+        golf::LatencyMetrics& m = *r.stages;
+        r.gpu_busy_ms += t.total_ms;
+        m.record_ms(golf::Stage::GPU_TOTAL, t.total_ms);
+        if (t.stage_ms > 0.f)   m.record_ms(golf::Stage::PREPROCESS, t.stage_ms);
+        if (t.h2d_ms >= 0.f)    m.record_ms(golf::Stage::H2D, t.h2d_ms);
+        if (t.infer_ms >= 0.f)  m.record_ms(golf::Stage::INFER, t.infer_ms);
+        if (t.output_ms >= 0.f) m.record_ms(golf::Stage::D2H, t.output_ms);
+    }
+
+    const int len = engine_.output_length();
+    for (int k = 0; k < slot.images; ++k) {
+        golf::StageTimer timer(r.stages.get(), golf::Stage::PARSE);
+        golf::FramePipeline::parse_detections(
+            out + static_cast<size_t>(k) * len, len / 6, conf_thresh_, slot.xf[k], dets_);
+    }
+    r.latency->record(Clock::now() - slot.submitted);
+    r.frames += slot.images;
+    return true;
+}
+
+bool Runner::run(const RunSpec& spec, int num_frames, RunResult& r) {
+    r = RunResult();
+    r.stages = std::make_unique<golf::LatencyMetrics>();
+    r.latency = std::make_unique<golf::LatencyHistogram>();
+
+    const int num_slots = spec.async ? golf::TrtEngine::kNumSlots : 1;
+    UtilizationSampler util;
+    util.start();
+    const uint64_t allocs0 = allocations();
+    const auto t0 = Clock::now();
+
+    // Same schedule as StagedPipeline::infer_loop: refill the oldest slot
+    // as soon as its results are in, so the other one stays busy.
+    int s = 0;
+    bool ok = true;
+    while (ok && static_cast<int>(r.frames) < num_frames) {
+        if (slots_[s].busy) ok = collect(s, r);
+        if (ok) ok = submit(s, spec, r);
+        s = (s + 1) % num_slots;
+    }
+    for (int i = 0; i < num_slots; ++i) {
+        if (slots_[i].busy) ok = collect(i, r) && ok;
+    }
+
+    r.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    r.allocations = allocations() - allocs0;
+    r.gpu_util = util.stop();
+    return ok;
+}
+
+// ─── Pipeline run ───────────────────────────────────────────────────────────
+// The in-memory frames served as a camera: each read copies the next one
+// into the pipeline's recycled frame, so steady-state capture is a memcpy.
+// Only frames of the first frame's size are served, so no read reallocates.
+class MemoryCapture : public golf::CaptureBackend {
+public:
+    MemoryCapture(const std::vector<cv::Mat>& frames, size_t offset, uint64_t count)
+        : next_(offset), remaining_(count) {
+        for (const cv::Mat& f : frames) {
+            if (f.size() == frames.front().size()) frames_.push_back(&f);
+        }
+    }
+
+    bool open(const std::string&, const golf::CaptureOptions&) override {
+        return !frames_.empty();
+    }
+
+    bool read(cv::Mat& frame, golf::DeviceFrame&) override {
+        if (remaining_ == 0) return false;
+        --remaining_;
+        frames_[next_++ % frames_.size()]->copyTo(frame);
+        return true;
+    }
+
+    bool is_open() const override { return !frames_.empty(); }
+    const char* name() const override { return "memory"; }
+
+private:
+    std::vector<const cv::Mat*> frames_;
+    size_t next_;
+    uint64_t remaining_;
+};
+
+// Datagrams go to a socket nobody reads, so sends never fail or block.
+class UdpSink {
+public:
+    UdpSink() {
+        fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        if (fd_ < 0 || bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+            getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len) < 0) {
+            return;
+        }
+        port_ = ntohs(addr.sin_port);
+    }
+    ~UdpSink() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    uint16_t port() const { return port_; }   // 0 if the socket failed
+
+private:
+    int fd_ = -1;
+    uint16_t port_ = 0;
+};
+
+struct PipelineResult {
+    int sources = 0;
+    uint64_t frames = 0;          // measured, i.e. after the warm-up
+    double seconds = 0.0;
+    uint64_t allocations = 0;     // heap allocations, all threads
+    std::unique_ptr<golf::LatencyMetrics> stages;
+};
+
+/// Drive `sources` cameras through StagedPipeline the way golf_sim's main
+/// loop does.  Allocations are counted between the end of the warm-up and
+/// the last measured frame, on every thread.
+static bool run_pipeline(const EngineSpec& e, const golf::BuildOptions& build,
+                         const BenchConfig& cfg, const std::vector<cv::Mat>& frames,
+                         PipelineResult& r) {
+    r = PipelineResult();
+    r.sources = cfg.pipeline_sources;
+    r.stages = std::make_unique<golf::LatencyMetrics>();
+
+    golf::EnginePool engines;
+    if (!engines.load(e.path, build, golf::EnginePoolOptions{})) return false;
+    engines.enable_cuda_graph(cfg.cuda_graph);
+
+    // Every frame is processed, so each camera yields exactly its share
+    const uint64_t per_source = (cfg.warmup + cfg.frames + r.sources - 1) / r.sources;
+    std::vector<std::unique_ptr<golf::FramePipeline>> pipelines;
+    std::vector<golf::FramePipeline*> sources;
+    for (int i = 0; i < r.sources; ++i) {
+        pipelines.push_back(std::make_unique<golf::FramePipeline>());
+        auto capture = std::make_unique<MemoryCapture>(frames, i * frames.size() / r.sources,
+                                                       per_source);
+        if (!pipelines.back()->open(std::move(capture), "memory:" + std::to_string(i))) {
+            return false;
+        }
+        sources.push_back(pipelines.back().get());
+    }
+
+    UdpSink sink;
+    golf::UnrealSender sender;
+    if (sink.port() == 0 || !sender.init("127.0.0.1", sink.port())) return false;
+
+    golf::PipelineOptions opts;
+    opts.conf_thresh = cfg.conf_thresh;
+    opts.drop_policy = golf::DropPolicy::BLOCK;
+    std::vector<golf::Tracker> trackers(r.sources);
+    std::vector<golf::PuttStats> stats(r.sources);
+    std::vector<Clock::time_point> prev(r.sources);
+
+    golf::StagedPipeline stages(sources, engines, opts, r.stages.get());
+    stages.start();
+
+    golf::FrameItem item;
+    uint64_t seen = 0, allocs0 = 0, allocs1 = 0;
+    Clock::time_point t0, t1;
+    int queued = 0;
+    while (stages.next(item)) {
+        if (seen == static_cast<uint64_t>(cfg.warmup)) {
+            allocs0 = allocations();
+            t0 = Clock::now();
+        }
+        const int s = item.source;
+        const double dt = prev[s] == Clock::time_point{} ? 0.0
+            : std::chrono::duration<double>(item.capture_time - prev[s]).count();
+        prev[s] = item.capture_time;
+
+        golf::Tracker& tracker = trackers[s];
+        {
+            golf::StageTimer timer(r.stages.get(), golf::Stage::TRACK);
+            if (item.gpu_decoded) {
+                tracker.update(item.best_ball, item.best_putter, dt);
+            } else {
+                tracker.update(item.detections, dt);
+            }
+        }
+        stats[s].update(tracker.ball(), dt);
+        {
+            golf::StageTimer timer(r.stages.get(), golf::Stage::SEND);
+            sender.queue(tracker.ball(), tracker.putter(), stats[s].current(), s,
+                         item.capture_time);
+            if (++queued == r.sources || !stages.has_ready()) {
+                sender.flush();
+                queued = 0;
+            }
+        }
+
+        if (++seen > static_cast<uint64_t>(cfg.warmup)) {
+            allocs1 = allocations();
+            t1 = Clock::now();
+        }
+    }
+    stages.stop();
+
+    r.frames = seen > static_cast<uint64_t>(cfg.warmup) ? seen - cfg.warmup : 0;
+    r.seconds = r.frames ? std::chrono::duration<double>(t1 - t0).count() : 0.0;
+    r.allocations = allocs1 - allocs0;
+    return r.frames > 0;
+}
+
+// ─── JSON ───────────────────────────────────────────────────────────────────
+static std::string snapshot_json(const golf::LatencyHistogram::Snapshot& s) {
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+        "{\"count\":%" PRIu64 ",\"mean_ms\":%.4f,\"p50_ms\":%.4f,"
+        "\"p95_ms\":%.4f,\"p99_ms\":%.4f,\"max_ms\":%.4f}",
+        s.count, s.mean_ms, s.p50_ms, s.p95_ms, s.p99_ms, s.max_ms);
+    return buf;
+}
+
+static std::string stages_json(const golf::LatencyMetrics& m) {
+    std::string out = "{";
+    bool first = true;
+    for (int i = 0; i < static_cast<int>(golf::Stage::kCount); ++i) {
+        const auto st = static_cast<golf::Stage>(i);
+        const auto s = m.snapshot(st);
+        if (s.count == 0) continue;
+        out += first ? "" : ",";
+        out += "\"" + std::string(golf::stage_name(st)) + "\":" + snapshot_json(s);
+        first = false;
+    }
+    return out + "}";
+}
+
+static std::string result_json(const EngineSpec& e, const golf::TrtEngine& engine,
+                               const RunSpec& spec, bool cuda_graph,
+                               const RunResult& r) {
+    const double fps = r.seconds > 0 ? r.frames / r.seconds : 0.0;
+    const double busy = r.seconds > 0 ? r.gpu_busy_ms / (r.seconds * 1e3) : 0.0;
+
+    std::string out;
+    char buf[512];
+    std::snprintf(buf, sizeof(buf),
+        "{\"engine\":\"%s\",\"precision\":\"%s\",\"input\":\"%dx%dx%d\","
+        "\"preprocess\":\"%s\",\"cpu_kernel\":\"%s\",\"mode\":\"%s\",\"batch\":%d,"
+        "\"cuda_graph\":%s,"
+        "\"frames\":%" PRIu64 ",\"seconds\":%.4f,\"fps\":%.2f,"
+        "\"allocations\":%" PRIu64 ",\"allocs_per_frame\":%.3f,"
+        "\"gpu_busy\":%.4f,\"gpu_util_percent\":",
+        e.path.c_str(), e.label.c_str(),
+        engine.input_c(), engine.input_h(), engine.input_w(),
+        spec.gpu_pre ? "gpu" : "cpu",
+        spec.gpu_pre ? "none" : golf::cpu_kernel_name(golf::cpu_kernel()),
+        spec.async ? "async" : "sync", spec.batch, cuda_graph && engine.cuda_graph_active() ? "true" : "false",
+        r.frames, r.seconds, fps, r.allocations,
+        r.frames ? static_cast<double>(r.allocations) / r.frames : 0.0,
+        std::min(busy, 1.0));
+    out += buf;
+    if (r.gpu_util >= 0) {
+        std::snprintf(buf, sizeof(buf), "%.1f", r.gpu_util);
+        out += buf;
+    } else {
+        out += "null";
+    }
+
+    out += ",\"latency\":" + snapshot_json(r.latency->snapshot());
+    out += ",\"stages\":" + stages_json(*r.stages) + "}";
+    return out;
+}
+
+static std::string pipeline_json(const EngineSpec& e, bool cuda_graph,
+                                 const PipelineResult& r) {
+    const double fps = r.seconds > 0 ? r.frames / r.seconds : 0.0;
+    char buf[512];
+    std::snprintf(buf, sizeof(buf),
+        "{\"engine\":\"%s\",\"precision\":\"%s\",\"mode\":\"pipeline\","
+        "\"sources\":%d,\"cuda_graph\":%s,"
+        "\"frames\":%" PRIu64 ",\"seconds\":%.4f,\"fps\":%.2f,"
+        "\"allocations\":%" PRIu64 ",\"allocs_per_frame\":%.3f,\"stages\":",
+        e.path.c_str(), e.label.c_str(), r.sources, cuda_graph ? "true" : "false",
+        r.frames, r.seconds, fps, r.allocations,
+        r.frames ? static_cast<double>(r.allocations) / r.frames : 0.0);
+    return buf + stages_json(*r.stages) + "}";
+}
+
+static std::string device_json() {
+    int dev = 0, driver = 0, runtime = 0;
+    cudaDeviceProp prop{};
+    cudaGetDevice(&dev);
+    cudaGetDeviceProperties(&prop, dev);
+    cudaDriverGetVersion(&driver);
+    cudaRuntimeGetVersion(&runtime);
+
+    char buf[512];
+    std::snprintf(buf, sizeof(buf),
+        "{\"name\":\"%s\",\"compute\":\"%d.%d\",\"cuda_driver\":%d,"
+        "\"cuda_runtime\":%d,\"tensorrt\":%d}",
+        prop.name, prop.major, prop.minor, driver, runtime,
+        static_cast<int>(getInferLibVersion()));
+    return buf;
+}
+
+// ─── Main ───────────────────────────────────────────────────────────────────
+int main(int argc, char** argv) {
+    BenchConfig cfg = parse_args(argc, argv);
+
+    std::vector<cv::Mat> frames = load_frames(cfg);
+    if (frames.empty()) {
+        std::cerr << "[Bench] No frames loaded\n";
+        return 1;
+    }
+    std::cerr << "[Bench] " << frames.size() << " frames in memory ("
+              << frames[0].cols << "x" << frames[0].rows << ")\n";
+
+    if (!golf::set_cpu_kernel(cfg.cpu_kernel)) {
+        std::cerr << "[Bench] CPU kernel " << golf::cpu_kernel_name(cfg.cpu_kernel)
+                  << " not supported here\n";
+        return 1;
+    }
+    const bool cpu_exact = cpu_kernel_exact(frames);
+    std::cerr << "[Bench] CPU kernel " << golf::cpu_kernel_name(golf::cpu_kernel())
+              << (cpu_exact ? " matches scalar" : " DIFFERS from scalar") << "\n";
+
+    std::vector<std::string> results;
+    bool all_ok = cpu_exact;
+
+    for (const EngineSpec& e : cfg.engines) {
+        // An .onnx model is built at the precision its label names
+        golf::BuildOptions build;
+        golf::parse_precision(e.label, build.precision);
+        if (!cfg.batches.empty()) {
+            build.max_batch = *std::max_element(cfg.batches.begin(), cfg.batches.end());
+        }
+        if (!cfg.images_dir.empty()) build.calib_dir = cfg.images_dir;
+
+        golf::TrtEngine engine;
+        if (!engine.load(e.path, build)) {
+            all_ok = false;
+            continue;
+        }
+        engine.enable_cuda_graph(cfg.cuda_graph);
+        engine.enable_timing(true);
+
+        std::vector<int> batches = cfg.batches;
+        if (batches.empty()) batches = {1, engine.max_batch()};
+        std::sort(batches.begin(), batches.end());
+        batches.erase(std::unique(batches.begin(), batches.end()), batches.end());
+
+        Runner runner(engine, frames, cfg.conf_thresh);
+        for (int batch : batches) {
+            if (batch < 1 || batch > engine.max_batch()) {
+                std::cerr << "[Bench] " << e.label << ": skipping batch " << batch
+                          << " (engine max " << engine.max_batch() << ")\n";
+                continue;
+            }
+            for (bool gpu_pre : {false, true}) {
+                if (gpu_pre ? !cfg.gpu_pre : !cfg.cpu_pre) continue;
+                for (bool async : {false, true}) {
+                    if (async ? !cfg.async : !cfg.sync) continue;
+
+                    const RunSpec spec{gpu_pre, async, batch};
+                    RunResult r;
+                    if (!runner.run(spec, cfg.warmup, r) ||
+                        !runner.run(spec, cfg.frames, r)) {
+                        std::cerr << "[Bench] " << e.label << ": run failed\n";
+                        all_ok = false;
+                        continue;
+                    }
+                    std::cerr << "[Bench] " << e.label << " "
+                              << (gpu_pre ? "gpu" : "cpu") << "/"
+                              << (async ? "async" : "sync") << " b" << batch
+                              << ": " << r.frames / r.seconds << " fps, "
+                              << r.allocations << " allocations\n";
+                    if (cfg.check_allocs && r.allocations > 0) {
+                        std::cerr << "[Bench] " << e.label
+                                  << ": hot path allocated after warm-up\n";
+                        all_ok = false;
+                    }
+                    results.push_back(result_json(e, engine, spec, cfg.cuda_graph, r));
+                }
+            }
+        }
+
+        if (cfg.pipeline_sources > 0) {
+            PipelineResult r;
+            if (!run_pipeline(e, build, cfg, frames, r)) {
+                std::cerr << "[Bench] " << e.label << ": pipeline run failed\n";
+                all_ok = false;
+                continue;
+            }
+            std::cerr << "[Bench] " << e.label << " pipeline x" << r.sources << ": "
+                      << r.frames / r.seconds << " fps, " << r.allocations
+                      << " allocations\n";
+            if (cfg.check_allocs && r.allocations > 0) {
+                std::cerr << "[Bench] " << e.label
+                          << ": pipeline allocated after warm-up\n";
+                all_ok = false;
+            }
+            results.push_back(pipeline_json(e, cfg.cuda_graph, r));
+        }
+    }
+
+    std::string json = "{\"device\":" + device_json();
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+        ",\"source\":{\"frames\":%zu,\"width\":%d,\"height\":%d},"
+        "\"cpu_kernel\":{\"name\":\"%s\",\"exact\":%s}",
+        frames.size(), frames[0].cols, frames[0].rows,
+        golf::cpu_kernel_name(golf::cpu_kernel()), cpu_exact ? "true" : "false");
+    json += buf;
+    json += ",\"results\":[";
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (i > 0) json += ",";
+        json += results[i];
+    }
+    json += "]}\n";
+
+    if (cfg.out_path.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream out(cfg.out_path);
+        out << json;
+        if (!out) {
+            std::cerr << "[Bench] Cannot write " << cfg.out_path << "\n";
+            return 1;
+        }
+    }
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// capture_backend.h  –  Pluggable Frame Sources
+//
+// FramePipeline delegates capture to one of these backends:
+//
+//   opencv     cv::VideoCapture (any OpenCV-supported source, CPU decode)
+//   gstreamer  cv::VideoCapture on a GStreamer pipeline with hardware decode
+//              (nvh264dec / nvv4l2decoder); a source containing '!' is used
+//              verbatim as the pipeline description
+//   v4l2       direct V4L2 mmap streaming – the frame is converted straight
+//              out of the driver's buffer (no intermediate copy)
+//   nvdec      cv::cudacodec::VideoReader – NVDEC decodes into device
+//              memory and the frame reaches the GPU pre-processor without
+//              touching host RAM (requires OpenCV built with cudacodec)
+//
+// A .golfrec source is always replayed by the recording backend
+// (recording.h), whatever the selected API.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <opencv2/opencv.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+struct CUevent_st;                       // cudaEvent_t, without the CUDA headers
+
+namespace golf {
+
+enum class CaptureApi { OPENCV, GSTREAMER, V4L2, NVDEC };
+
+/// Parse "opencv" / "gstreamer" / "v4l2" / "nvdec".  Returns false if unknown.
+bool parse_capture_api(const std::string& name, CaptureApi& api);
+const char* capture_api_name(CaptureApi api);
+
+struct CaptureOptions {
+    CaptureApi  api = CaptureApi::OPENCV;
+    int         width = 1920;            // requested capture size
+    int         height = 1080;
+    double      fps = 0.0;               // 0 = device default
+    std::string pixel_format = "MJPG";   // V4L2 FOURCC (MJPG, YUYV, BGR3, …)
+    bool        host_copy = true;        // device backends: also fill the
+                                         // host cv::Mat (GUI / CPU path)
+    int         gpu = -1;                // device backends: CUDA device to
+                                         // decode on (-1 = the current one)
+    std::function<bool()> host_wanted;   // device backends without host_copy:
+                                         // fill it for frames read while this
+                                         // returns true (e.g. a /api/video
+                                         // viewer watches the source)
+    double      replay_speed = 1.0;      // recordings: timing scale, 0 = fast
+};
+
+/// A frame resident in device memory (packed BGR8 / BGRA8 rows).
+/// `hold` keeps the underlying allocation alive while the frame is in use.
+struct DeviceFrame {
+    const uint8_t* data = nullptr;
+    size_t pitch = 0;                    // bytes per row
+    int width = 0, height = 0;
+    int channels = 3;                    // 3 = BGR, 4 = BGRA
+    int gpu = 0;                         // CUDA device holding `data`
+    CUevent_st* ready = nullptr;         // recorded once `data` is written;
+                                         // wait on it before reading (null:
+                                         // already complete)
+    std::shared_ptr<void> hold;
+
+    explicit operator bool() const { return data != nullptr; }
+
+    /// Sub-region view (shares `hold`).
+    DeviceFrame crop(const cv::Rect& r) const {
+        DeviceFrame f = *this;
+        f.data = data + r.y * pitch + static_cast<size_t>(r.x) * channels;
+        f.width = r.width;
+        f.height = r.height;
+        return f;
+    }
+};
+
+// ─── Capture Backend ────────────────────────────────────────────────────────
+class CaptureBackend {
+public:
+    virtual ~CaptureBackend() = default;
+
+    virtual bool open(const std::string& source, const CaptureOptions& opts) = 0;
+
+    /// Grab the next frame.  Host backends fill `frame`; device backends
+    /// fill `device` (and `frame` too when CaptureOptions::host_copy or
+    /// host_wanted() asks for it, leaving it empty otherwise).
+    /// Returns false when the stream ends.
+    virtual bool read(cv::Mat& frame, DeviceFrame& device) = 0;
+
+    /// Source timestamp of the frame last read, in seconds on the source's
+    /// own clock (V4L2: driver capture time, files: media position), or a
+    /// negative value if the source has none.  Only differences are used.
+    virtual double timestamp() const { return -1.0; }
+
+    virtual bool is_open() const = 0;
+    virtual const char* name() const = 0;
+};
+
+/// Create the backend for `api`; nullptr if it isn't compiled in.
+std::unique_ptr<CaptureBackend> make_capture_backend(CaptureApi api);
+
+// Defined in their own translation units (null when unavailable).
+std::unique_ptr<CaptureBackend> make_v4l2_capture();
+std::unique_ptr<CaptureBackend> make_nvdec_capture();
+
+}  // namespace golf
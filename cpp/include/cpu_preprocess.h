@@ -0,0 +1,51 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// cpu_preprocess.h  –  Vectorised CPU Pre-processing (no-GPU bays)
+//
+// On bays with an integrated or shared GPU pre-processing stays on the CPU.
+// After the resize, FramePipeline::preprocess turns the BGR8 image into the
+// network's planar RGB float input.  The kernels here do the colour swap,
+// the u8 → f32 scaling and the HWC → CHW de-interleave in one pass over
+// the image.  Rows are split across the OpenCV thread pool.
+//
+//   AVX2    x86-64, chosen at run time (cv::checkHardwareSupport)
+//   NEON    aarch64 (always available there)
+//   SCALAR  everything else
+//
+// Every kernel computes float(v) * float(1/255), which is how convertTo
+// scales, so they all produce bit-identical blobs.  cpu_preprocess_test
+// holds every supported kernel to the original OpenCV path, and
+// golf_sim_bench checks the active kernel against SCALAR before it
+// measures anything.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <opencv2/opencv.hpp>
+
+#include <string>
+
+namespace golf {
+
+enum class CpuKernel : int { AUTO, SCALAR, AVX2, NEON };
+
+bool parse_cpu_kernel(const std::string& name, CpuKernel& out);
+const char* cpu_kernel_name(CpuKernel kernel);
+
+/// Whether this build and this CPU can run `kernel` (AUTO always can).
+bool cpu_kernel_supported(CpuKernel kernel);
+
+/// Kernel that AUTO resolves to: the best supported one, unless
+/// set_cpu_kernel() forced another.  Never AUTO.
+CpuKernel cpu_kernel();
+
+/// Pick the kernel for the whole process (AUTO = best supported).
+/// @return false, leaving the selection alone, if it is not supported here
+bool set_cpu_kernel(CpuKernel kernel);
+
+/// BGR8 HWC image → RGB float CHW planes scaled to [0, 1].
+/// @param bgr     CV_8UC3 image (rows may be padded, e.g. an ROI)
+/// @param dst     3 × rows × cols floats: the R plane, then G, then B
+/// @param kernel  implementation to run (AUTO = cpu_kernel())
+void bgr_to_planar_rgb(const cv::Mat& bgr, float* dst,
+                       CpuKernel kernel = CpuKernel::AUTO);
+
+}  // namespace golf
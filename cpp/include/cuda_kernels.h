@@ -0,0 +1,77 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// cuda_kernels.h  –  Host-side launchers for the project's CUDA kernels
+//
+// Kept free of OpenCV / TensorRT headers so the .cu files stay cheap for
+// nvcc to compile.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <cuda_runtime_api.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace golf {
+
+// ─── Pre-processing ─────────────────────────────────────────────────────────
+/// Geometry of the resize / letterbox applied by the preprocessing kernel.
+struct PreprocessParams {
+    float scale_x = 1.f, scale_y = 1.f;    // network px per source px
+    int   pad_x = 0, pad_y = 0;            // letterbox offset (network px)
+    int   content_w = 0, content_h = 0;    // resized image size
+    float pad_value = 114.f / 255.f;       // normalized border fill
+    int   src_channels = 3;                // 3 = BGR8, 4 = BGRA8
+};
+
+/// Fused resize + BGR→RGB + /255 + HWC→CHW.
+/// @param src        device pointer to packed BGR8 (or BGRA8) image
+/// @param src_pitch  bytes per source row
+/// @param dst        device pointer to 3 × net_h × net_w floats
+cudaError_t launch_preprocess_bgr8(const uint8_t* src, int src_w, int src_h,
+                                   size_t src_pitch, float* dst,
+                                   int net_w, int net_h,
+                                   const PreprocessParams& params,
+                                   cudaStream_t stream);
+
+// ─── Detection decoding ─────────────────────────────────────────────────────
+constexpr int kNumClasses = 2;              // 0 = golf_ball, 1 = putter
+constexpr int kMaxCompactDetections = 32;   // survivors copied back per image
+
+/// Maps network boxes back to the original frame (see ImageTransform).
+struct DecodeParams {
+    float scale_x = 1.f, scale_y = 1.f;    // network px per original px
+    float pad_x = 0.f, pad_y = 0.f;        // letterbox border (network px)
+    float offset_x = 0.f, offset_y = 0.f;  // crop origin (original px)
+    float conf_thresh = 0.5f;
+};
+
+/// Same field layout as golf::Detection, without the OpenCV dependency.
+struct CompactDetection {
+    int   class_id = -1;                   // -1 = empty
+    float confidence = 0.f;
+    float x1 = 0.f, y1 = 0.f, x2 = 0.f, y2 = 0.f;
+};
+
+/// Fixed-size decode result for one image – this is all that crosses PCIe.
+struct CompactDetections {
+    int count = 0;     // entries in dets (row order, like parse_detections)
+    int total = 0;     // detections above threshold before truncation
+    CompactDetection best[kNumClasses];    // highest confidence per class
+    CompactDetection dets[kMaxCompactDetections];
+};
+
+/// Threshold, rescale and compact YOLOv10 rows
+/// ([x1, y1, x2, y2, conf, class_id]) for a batch of images, and pick the
+/// best detection per class with the same tie-break as Tracker::update().
+/// @param output      device pointer to images × stride floats
+/// @param num_dets    rows per image
+/// @param stride      floats between consecutive images
+/// @param params      device pointer to one DecodeParams per image
+/// @param results     device pointer to one CompactDetections per image
+cudaError_t launch_decode_detections(const float* output, int num_dets,
+                                     int stride, int images,
+                                     const DecodeParams* params,
+                                     CompactDetections* results,
+                                     cudaStream_t stream);
+
+}  // namespace golf
@@ -0,0 +1,58 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// engine_builder.h  –  ONNX → TensorRT Engine Build & Cache
+//
+// A serialized engine is only valid for the GPU model and TensorRT version
+// it was built with, so instead of shipping one .engine per machine the
+// ONNX model is built on first start and the result cached.  The cache file
+// name carries everything that makes an engine incompatible or different:
+//
+//   <stem>.<gpu>-sm<cc>.trt<version>.<precision>.b<batch>[.lb].<onnx hash>.engine
+//
+// so a driver / TensorRT upgrade, another GPU, other build flags or an
+// edited model each get (and keep) their own engine.
+//
+// INT8 runs entropy calibration (IInt8EntropyCalibrator2) over frames from
+// a directory – normally data/images – pre-processed exactly like the live
+// CPU path.  The calibration table is cached next to the engines and reused
+// for rebuilds on other GPUs.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <NvInfer.h>
+
+#include <cstddef>
+#include <string>
+
+namespace golf {
+
+enum class Precision { FP32, FP16, INT8 };
+
+bool parse_precision(const std::string& name, Precision& out);
+const char* precision_name(Precision precision);
+
+struct BuildOptions {
+    Precision   precision    = Precision::FP16;
+    int         max_batch    = 1;        // dynamic-batch models: profile max
+    size_t      workspace_mb = 1024;
+    std::string cache_dir;               // empty: next to the ONNX file
+
+    // INT8 calibration
+    std::string calib_dir    = "data/images";
+    int         calib_batch  = 8;
+    int         calib_images = 512;      // at most this many frames
+    bool        letterbox    = false;    // match the live pre-processing
+};
+
+/// True if `path` names an ONNX model rather than a serialized engine.
+bool is_onnx_model(const std::string& path);
+
+/// Cache file for `onnx_path` built with `opts` on the current CUDA device.
+/// Empty if the model cannot be read or the device cannot be queried.
+std::string engine_cache_path(const std::string& onnx_path, const BuildOptions& opts);
+
+/// Parse `onnx_path`, build a serialized engine and write it to
+/// `engine_path` (atomically: a partial build never shadows the cache).
+bool build_engine(const std::string& onnx_path, const BuildOptions& opts,
+                  const std::string& engine_path, nvinfer1::ILogger& logger);
+
+}  // namespace golf
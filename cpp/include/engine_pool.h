@@ -0,0 +1,106 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// engine_pool.h  –  Engines on Several GPUs & Least-loaded Context Choice
+//
+// Loads the model once per selected CUDA device, each engine with a number
+// of inference slots (execution context + stream + buffers).  Every slot of
+// every device is one "context" of the pool, numbered 0 .. size()-1:
+//
+//   GPU 0: ctx 0, ctx 2, …      GPU 1: ctx 1, ctx 3, …
+//
+// The inference stage acquire()s an idle context for each batch – the one
+// on the device with the fewest images in flight – and release()s it once
+// the results are collected.  Ordering of results is the caller's business
+// (StagedPipeline re-orders them per camera).
+//
+// acquire() / release() are called from one thread; the counters behind
+// to_json() / to_prometheus() may be read from any thread.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "trt_engine.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace golf {
+
+struct EnginePoolOptions {
+    std::vector<int> devices;            // CUDA devices; empty = the current one
+    int contexts = TrtEngine::kNumSlots; // inference slots per device
+};
+
+class EnginePool {
+public:
+    EnginePool() = default;
+
+    EnginePool(const EnginePool&) = delete;
+    EnginePool& operator=(const EnginePool&) = delete;
+
+    /// Load `model_path` on every device (an .onnx model is built and
+    /// cached per GPU model).  Fails unless all engines take the same input
+    /// and produce the same output.
+    bool load(const std::string& model_path, const BuildOptions& build,
+              const EnginePoolOptions& opts);
+
+    void enable_cuda_graph(bool enable);
+    void enable_timing(bool enable);
+
+    /// Inference contexts over all devices.
+    int size() const { return static_cast<int>(contexts_.size()); }
+    int num_devices() const { return static_cast<int>(engines_.size()); }
+    /// CUDA device of the i-th engine (0 <= i < num_devices()).
+    int device_id(int i) const { return engines_[i]->device(); }
+
+    TrtEngine& engine(int ctx) { return *engines_[contexts_[ctx]->engine]; }
+    const TrtEngine& engine(int ctx) const { return *engines_[contexts_[ctx]->engine]; }
+    int slot(int ctx) const { return contexts_[ctx]->slot; }
+    int device(int ctx) const { return engine(ctx).device(); }
+
+    /// Idle context on the least-loaded device (ties: the context that has
+    /// served the fewest images), marked busy with `images`.
+    /// @param device  only consider this CUDA device (-1 = any)
+    /// @return context index, or -1 if every candidate is busy
+    int acquire(int images, int device = -1);
+
+    /// Hand a context back after its results were collected.
+    /// @param gpu_ms  GPU time of the batch (negative if not measured)
+    void release(int ctx, float gpu_ms = -1.f);
+
+    bool busy(int ctx) const { return contexts_[ctx]->busy; }
+    uint64_t batches(int ctx) const { return contexts_[ctx]->batches.load(); }
+    uint64_t images(int ctx) const { return contexts_[ctx]->served.load(); }
+
+    /// Whether any context lives on `device`.
+    bool has_device(int device) const;
+
+    // Network shape – the same on every device
+    int max_batch() const { return engines_.front()->max_batch(); }
+    int input_volume() const { return engines_.front()->input_volume(); }
+    int output_length() const { return engines_.front()->output_length(); }
+    int input_h() const { return engines_.front()->input_h(); }
+    int input_w() const { return engines_.front()->input_w(); }
+
+    /// Per-context batches, images and GPU time.
+    std::string to_json() const;
+    std::string to_prometheus() const;
+
+private:
+    struct Context {
+        int  engine = 0;                  // index into engines_
+        int  slot = 0;
+        bool busy = false;                // inference thread only
+        int  images = 0;                  // in the current batch
+        std::atomic<uint64_t> batches{0}; // dispatched
+        std::atomic<uint64_t> served{0};  // images dispatched
+        std::atomic<uint64_t> gpu_us{0};
+    };
+
+    std::vector<std::unique_ptr<TrtEngine>> engines_;
+    std::vector<std::unique_ptr<Context>> contexts_;
+    std::vector<int> in_flight_;          // images per engine
+};
+
+}  // namespace golf
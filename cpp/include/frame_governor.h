@@ -0,0 +1,107 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// frame_governor.h  –  Adaptive Inference Rate (Duty Cycling) per Bay
+//
+// Most of a session nothing happens: the ball sits on the mat and nobody is
+// near it.  Running the network on every frame then only takes GPU time
+// away from the Unreal renderer sharing the card.  The governor lets each
+// bay drop to a low inference rate while idle and go back to full rate the
+// moment something happens:
+//
+//   FULL ── no activity for hold_s ──> IDLE
+//   IDLE ── frame difference, putter near ball, or IN_MOTION ──> FULL
+//
+// Capture threads ask admit() for every frame; while idle it runs a cheap
+// frame-difference check on a downscaled grey copy against the last frame
+// that was inferred, so a putter entering the scene wakes the bay on that
+// very frame rather than at the next idle tick.  The tracking stage reports
+// putt state and putter / ball positions back through report(); a putt in
+// motion keeps the bay at full rate.
+//
+// Counters, mode and the effective inference rate per bay are published
+// with StatsApi on /api/metrics.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "putt_stats.h"
+#include "tracker.h"
+
+#include <opencv2/opencv.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace golf {
+
+enum class GovernorMode : int { FULL, IDLE };
+
+const char* governor_mode_name(GovernorMode mode);
+
+struct GovernorOptions {
+    double idle_fps      = 5.0;      // inference rate while idle
+    double hold_s        = 2.0;      // activity-free time before idling
+    float  wake_distance = 200.f;    // putter–ball distance that wakes, px
+    int    motion_width  = 160;      // frame-difference image width, px
+    int    motion_delta  = 15;       // grey-level change counted as motion
+    int    motion_pixels = 4;        // changed pixels needed to wake
+};
+
+class FrameGovernor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    FrameGovernor(int sources, const GovernorOptions& opts);
+
+    FrameGovernor(const FrameGovernor&) = delete;
+    FrameGovernor& operator=(const FrameGovernor&) = delete;
+
+    /// Capture thread of `source`, once per captured frame: whether this
+    /// frame goes on to inference.  Without a host frame (device decoding)
+    /// the motion check is skipped and only report() wakes the bay.
+    bool admit(int source, const cv::Mat& frame, Clock::time_point now);
+
+    /// Tracking stage, after each processed frame of `source`.
+    void report(int source, PuttState state, const TrackedObject& ball,
+                const TrackedObject& putter, Clock::time_point now);
+
+    GovernorMode mode(int source) const;
+
+    /// Frames admitted per second over the last second.
+    double effective_fps(int source) const;
+
+    /// {"idle_fps":…, "bays":[{"bay":0, "mode":"idle", "fps":…, …}, …]}
+    std::string to_json() const;
+
+    /// Prometheus text: mode / fps gauges and frame counters per bay.
+    std::string to_prometheus() const;
+
+private:
+    struct Source {
+        std::atomic<GovernorMode> mode{GovernorMode::FULL};
+        std::atomic<int64_t>  last_active{0};     // Clock ticks
+        std::atomic<double>   fps{0.0};
+        std::atomic<uint64_t> admitted{0};
+        std::atomic<uint64_t> skipped{0};
+        std::atomic<uint64_t> wakeups{0};         // IDLE → FULL transitions
+
+        // Capture thread only
+        cv::Mat reference;                        // last inferred, downscaled grey
+        bool    has_reference = false;
+        cv::Mat scaled, small, diff;
+        Clock::time_point next_idle{};
+        Clock::time_point window_start{};
+        uint64_t window_admitted = 0;
+    };
+
+    bool motion(Source& s, const cv::Mat& frame);
+    void wake(Source& s, Clock::time_point now);
+    void count(Source& s, bool admitted, Clock::time_point now);
+
+    GovernorOptions opts_;
+    std::vector<std::unique_ptr<Source>> sources_;
+};
+
+}  // namespace golf
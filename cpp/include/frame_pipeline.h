@@ -3,8 +3,11 @@
 // frame_pipeline.h  –  OpenCV Frame Capture & Pre-processing
 // ─────────────────────────────────────────────────────────────────────────────
 
+#include "capture_backend.h"
+
 #include <opencv2/opencv.hpp>
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -22,22 +25,55 @@ struct Detection {
     float height() const { return y2 - y1; }
 };
 
+/// Maps network-input pixel coordinates back to the original frame.
+/// Covers both a plain stretch resize and an aspect-preserving letterbox,
+/// optionally of a crop whose origin is (offset_x, offset_y).
+struct ImageTransform {
+    float scale_x = 1.f, scale_y = 1.f;   // network px per original px
+    float pad_x = 0.f, pad_y = 0.f;       // letterbox border (network px)
+    int content_w = 0, content_h = 0;     // resized image size inside input
+    float offset_x = 0.f, offset_y = 0.f; // crop origin (original px)
+
+    static ImageTransform stretch(int orig_w, int orig_h, int net_w, int net_h);
+    static ImageTransform letterbox(int orig_w, int orig_h, int net_w, int net_h);
+
+    float to_orig_x(float nx) const { return (nx - pad_x) / scale_x + offset_x; }
+    float to_orig_y(float ny) const { return (ny - pad_y) / scale_y + offset_y; }
+};
+
 // ─── Frame Pipeline ─────────────────────────────────────────────────────────
 class FramePipeline {
 public:
-    /// Open a video source (camera index as string, or file path / RTSP URL).
-    bool open(const std::string& source);
+    /// Open a video source (camera index as string, or file path / RTSP URL)
+    /// through the backend selected in `opts`.
+    bool open(const std::string& source, const CaptureOptions& opts = {});
+
+    /// Same, through a backend the caller supplies (e.g. frames served from
+    /// memory by the benchmark).
+    bool open(std::unique_ptr<CaptureBackend> backend, const std::string& source,
+              const CaptureOptions& opts = {});
 
     /// Grab the next frame.  Returns false when stream ends.
     bool read(cv::Mat& frame);
 
+    /// Same, also returning the device-resident copy when the backend
+    /// decodes on the GPU (`device` stays empty otherwise).
+    bool read(cv::Mat& frame, DeviceFrame& device);
+
+    /// Source timestamp of the frame last read (see CaptureBackend).
+    double timestamp() const { return backend_ ? backend_->timestamp() : -1.0; }
+
     /// Pre-process a BGR frame into a float blob (NCHW, 0-1 normalized).
     /// @param frame      input BGR image (any size)
     /// @param net_h      network input height
     /// @param net_w      network input width
     /// @param blob       output float vector (1 × 3 × net_h × net_w)
+    /// @param letterbox  keep aspect ratio and pad with grey (114)
+    /// The colour / scale / de-interleave pass runs the vectorised kernel
+    /// from cpu_preprocess.h.  Scratch images are per thread, and `blob`
+    /// keeps its capacity, so repeated calls of one size do not allocate.
     static void preprocess(const cv::Mat& frame, int net_h, int net_w,
-                           std::vector<float>& blob);
+                           std::vector<float>& blob, bool letterbox = false);
 
     /// Parse raw network output into detections.
     /// YOLOv10 outputs (batch × num_dets × 6) where each row is
@@ -53,13 +89,25 @@ public:
         const float* output, int num_dets, float conf_thresh,
         int orig_w, int orig_h, int net_w, int net_h);
 
+    /// Same as above, mapping boxes back through an explicit transform
+    /// (e.g. the letterbox used by the GPU pre-processor).
+    static std::vector<Detection> parse_detections(
+        const float* output, int num_dets, float conf_thresh,
+        const ImageTransform& xf);
+
+    /// Same, filling `dets` in place – reuses its capacity, so a vector
+    /// reserved for num_dets rows never reallocates.
+    static void parse_detections(
+        const float* output, int num_dets, float conf_thresh,
+        const ImageTransform& xf, std::vector<Detection>& dets);
+
     /// Draw detections on frame (in-place).
     static void draw(cv::Mat& frame, const std::vector<Detection>& dets);
 
-    bool is_open() const { return cap_.isOpened(); }
+    bool is_open() const { return backend_ && backend_->is_open(); }
 
 private:
-    cv::VideoCapture cap_;
+    std::unique_ptr<CaptureBackend> backend_;
 };
 
 }  // namespace golf
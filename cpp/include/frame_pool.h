@@ -0,0 +1,83 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// frame_pool.h  –  Pipeline Frame Contexts & Their Free List
+//
+// A FrameItem owns every per-frame buffer – the captured image, the CPU
+// input blob and the detection list.  Instead of being destroyed once the
+// tracking stage is done with it (or a stage drops it), a context goes back
+// to a FramePool with its buffers intact, and the capture threads take
+// their next context from there.  Capture backends decode into the
+// recycled cv::Mat, pre-processing refills the blob and parsing refills the
+// detection vector in place, so once every context has seen one frame the
+// pipeline runs without heap allocations.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "frame_pipeline.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace golf {
+
+/// One frame travelling through the pipeline.
+struct FrameItem {
+    int source = 0;                       // index into the pipeline's sources
+    uint64_t seq = 0;                     // per-source frame counter
+    std::chrono::steady_clock::time_point capture_time;
+    double source_time = -1.0;            // FramePipeline::timestamp(), s
+    cv::Mat frame;                        // host copy (may be empty with nvdec)
+    DeviceFrame device;                   // set by device-decoding backends
+    cv::Rect roi;                         // region fed to the network
+    ImageTransform transform;             // network input → frame mapping
+    std::vector<float> blob;              // preprocessed NCHW input (CPU mode)
+    std::vector<Detection> detections;
+
+    // Per-class best pick, filled by the GPU decoder (gpu_decoded == true)
+    bool gpu_decoded = false;
+    std::optional<Detection> best_ball;
+    std::optional<Detection> best_putter;
+
+    cv::Size size() const {
+        return frame.empty() ? cv::Size(device.width, device.height) : frame.size();
+    }
+};
+
+// ─── Frame Pool ─────────────────────────────────────────────────────────────
+// Any thread may acquire or release; the lock is only held for a move in
+// or out of a vector whose capacity is reserved up front.
+class FramePool {
+public:
+    /// @param capacity        contexts kept for reuse (more are freed)
+    /// @param blob_floats     CPU input blob reserved per new context
+    /// @param max_detections  detection capacity reserved per new context
+    FramePool(size_t capacity, size_t blob_floats, size_t max_detections);
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    /// A recycled context (buffers kept, per-frame fields reset), or a new
+    /// pre-reserved one while the pool is still warming up.
+    FrameItem acquire();
+
+    /// Hand a finished or dropped frame's buffers back.  Contexts that own
+    /// nothing (moved-from) are ignored.  Releases the device surface.
+    void release(FrameItem& item);
+
+    /// Contexts created because the pool was empty – stops growing once
+    /// the pipeline is warm.
+    uint64_t created() const;
+
+private:
+    size_t capacity_;
+    size_t blob_floats_;
+    size_t max_detections_;
+    mutable std::mutex mutex_;
+    std::vector<FrameItem> free_;
+    uint64_t created_ = 0;
+};
+
+}  // namespace golf
@@ -0,0 +1,69 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// gpu_postprocess.h  –  GPU-resident Detection Decoding
+//
+// Runs threshold → rescale → compaction → per-class best pick on the output
+// binding and copies back one fixed-size CompactDetections per image
+// (~1 KB) instead of the whole output tensor.
+//
+// Per-image transforms live in pinned memory and are uploaded by enqueue()
+// itself, so changing them between frames keeps a captured CUDA graph
+// valid.  Like GpuPreprocessor, use one instance per inference slot.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "cuda_kernels.h"
+#include "frame_pipeline.h"
+#include "trt_engine.h"
+
+#include <cuda_runtime_api.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace golf {
+
+class GpuPostprocessor : public OutputStage {
+public:
+    GpuPostprocessor() = default;
+    ~GpuPostprocessor();
+
+    GpuPostprocessor(const GpuPostprocessor&) = delete;
+    GpuPostprocessor& operator=(const GpuPostprocessor&) = delete;
+
+    /// Number of images the next enqueue() decodes – call before stage().
+    bool set_batch(int images);
+
+    /// Set the box transform and threshold for one image of the batch.
+    /// @param index  position in the batch (0 .. images-1)
+    bool stage(int index, const ImageTransform& xf, float conf_thresh);
+
+    bool enqueue(const float* d_output, int images, int output_length,
+                 cudaStream_t stream) override;
+
+    uint64_t generation() const override { return generation_; }
+
+    /// Decoded result for image `index`; valid once the slot's stream work
+    /// has completed (i.e. after TrtEngine::wait()).
+    const CompactDetections& result(int index) const { return h_results_[index]; }
+
+    /// Expand a compact result into the same vector parse_detections() builds.
+    static void to_detections(const CompactDetections& r,
+                              std::vector<Detection>& dets);
+
+    /// Best detection of a class; false if none passed the threshold.
+    static bool best(const CompactDetections& r, int class_id, Detection& det);
+
+private:
+    bool reserve(int images);
+    void release();
+
+    DecodeParams* d_params_ = nullptr;
+    DecodeParams* h_params_ = nullptr;           // pinned
+    CompactDetections* d_results_ = nullptr;
+    CompactDetections* h_results_ = nullptr;     // pinned
+    int capacity_ = 0;
+    int batch_ = 0;
+    uint64_t generation_ = 0;
+};
+
+}  // namespace golf
@@ -0,0 +1,71 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// kalman_tracker.h  –  Constant-velocity Kalman Filter for One Object
+//
+// State [x, y, vx, vy] with a white-noise-acceleration motion model and
+// position-only measurements.  With independent noise per axis the 4×4
+// covariance is block-diagonal, so it is kept as two symmetric 2×2 blocks
+// in fixed-size storage – no allocation, a few dozen flops per update.
+//
+// dt is the time between the frames' capture timestamps, so irregular
+// frame spacing (dropped frames, variable-rate cameras) is modelled rather
+// than absorbed as velocity error.  A measurement far outside the
+// predicted covariance (e.g. a putt launching from rest) is treated as a
+// manoeuvre: the state is re-initialised from the last two measurements
+// instead of the velocity being pulled in over many frames.
+// ─────────────────────────────────────────────────────────────────────────────
+
+namespace golf {
+
+struct KalmanOptions {
+    float process_noise = 1e5f;      // q: acceleration noise density (px²/s³)
+    float measurement_noise = 2.f;   // r: centre variance at confidence 1 (px²)
+    float gate = 16.f;               // squared Mahalanobis distance (2 dof)
+                                     // beyond which a manoeuvre is assumed
+};
+
+class KalmanTracker {
+public:
+    explicit KalmanTracker(const KalmanOptions& opts = {});
+
+    /// Change the noise model; the current estimate is kept.
+    void set_options(const KalmanOptions& opts) { opts_ = opts; }
+
+    /// Start a new track at a first measurement (velocity unknown).
+    void reset(float x, float y, float confidence);
+
+    /// Propagate the state `dt` seconds; no-op for dt <= 0.
+    void predict(double dt);
+
+    /// Fuse a measured centre; lower confidence means more noise.
+    void correct(float x, float y, float confidence);
+
+    float x() const { return static_cast<float>(x_.pos); }
+    float y() const { return static_cast<float>(y_.pos); }
+    float vx() const { return static_cast<float>(x_.vel); }
+    float vy() const { return static_cast<float>(y_.vel); }
+
+    /// Position `ahead` seconds past the current state, without changing it.
+    float x_at(double ahead) const { return static_cast<float>(x_.pos + x_.vel * ahead); }
+    float y_at(double ahead) const { return static_cast<float>(y_.pos + y_.vel * ahead); }
+
+private:
+    /// One axis: position, velocity and their 2×2 covariance.
+    struct Axis {
+        double pos = 0.0, vel = 0.0;
+        double p00 = 0.0, p01 = 0.0, p11 = 0.0;
+        double last_z = 0.0;         // previous measurement
+
+        void predict(double dt, double q);
+        void correct(double z, double r);
+        void reinit(double z, double dt, double r);
+    };
+
+    double noise(float confidence) const;
+
+    KalmanOptions opts_;
+    Axis   x_, y_;
+    double since_fix_ = 0.0;     // seconds since the last measurement
+};
+
+}  // namespace golf
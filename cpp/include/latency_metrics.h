@@ -0,0 +1,113 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// latency_metrics.h  –  Per-stage Latency Histograms
+//
+// Lock-free log-linear (HDR-style) histograms: 16 linear sub-buckets per
+// power of two, so any recorded value is reported within ~6 %.  Recording
+// is a couple of relaxed atomic adds and is safe from any thread; readers
+// get an approximate, never-blocking snapshot.
+//
+// CPU stages are timed with steady_clock, GPU stages with CUDA events
+// (see TrtEngine::timings()).  StatsApi serves the result on /api/metrics.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace golf {
+
+// ─── Histogram ──────────────────────────────────────────────────────────────
+class LatencyHistogram {
+public:
+    struct Snapshot {
+        uint64_t count = 0;
+        double mean_ms = 0.0;
+        double p50_ms = 0.0, p95_ms = 0.0, p99_ms = 0.0;
+        double max_ms = 0.0;
+        double sum_ms = 0.0;
+    };
+
+    void record(std::chrono::nanoseconds d);
+    void record_ms(double ms);
+
+    Snapshot snapshot() const;
+
+private:
+    static constexpr int kSubBits = 4;
+    static constexpr int kSub = 1 << kSubBits;
+    static constexpr int kNumBuckets = kSub + (64 - kSubBits) * kSub;
+
+    static int bucket_of(uint64_t ns);
+    static uint64_t bucket_upper(int idx);
+
+    std::array<std::atomic<uint64_t>, kNumBuckets> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_ns_{0};
+    std::atomic<uint64_t> max_ns_{0};
+};
+
+// ─── Stage Metrics ──────────────────────────────────────────────────────────
+enum class Stage {
+    CAPTURE,        // backend read()
+    PREPROCESS,     // CPU blob or GPU kernel (+ raw frame upload)
+    H2D,            // CPU-mode blob upload
+    INFER,          // enqueueV3
+    D2H,            // output copy / GPU decode + compact copy
+    GPU_TOTAL,      // whole slot on the GPU (only number in CUDA-graph mode)
+    PARSE,          // detection parsing / unpacking
+    TRACK,
+    STATS,
+    SEND,           // UDP send
+    GLASS_TO_UDP,   // capture timestamp → datagram sent
+    kCount
+};
+
+const char* stage_name(Stage s);
+
+class LatencyMetrics {
+public:
+    void record(Stage s, std::chrono::nanoseconds d) { hist(s).record(d); }
+    void record_ms(Stage s, double ms) { hist(s).record_ms(ms); }
+
+    LatencyHistogram::Snapshot snapshot(Stage s) const {
+        return hists_[static_cast<int>(s)].snapshot();
+    }
+
+    /// {"stages": {"capture": {"count":…, "p50_ms":…, …}, …}}
+    std::string to_json() const;
+
+    /// Prometheus text exposition (summary per stage, seconds).
+    std::string to_prometheus() const;
+
+private:
+    LatencyHistogram& hist(Stage s) { return hists_[static_cast<int>(s)]; }
+
+    std::array<LatencyHistogram, static_cast<int>(Stage::kCount)> hists_;
+};
+
+/// Records the lifetime of the scope into a stage (no-op without metrics).
+class StageTimer {
+public:
+    StageTimer(LatencyMetrics* m, Stage s)
+        : metrics_(m), stage_(s),
+          start_(m ? std::chrono::steady_clock::now()
+                   : std::chrono::steady_clock::time_point()) {}
+    ~StageTimer() {
+        if (metrics_) {
+            metrics_->record(stage_, std::chrono::steady_clock::now() - start_);
+        }
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    LatencyMetrics* metrics_;
+    Stage stage_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace golf
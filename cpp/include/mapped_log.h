@@ -0,0 +1,97 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// mapped_log.h  –  Append-only Fixed-record Log in mmap'd Memory
+//
+// One writer appends fixed-size records; any number of readers index the
+// published prefix straight out of the mapping.  The whole capacity is
+// mapped once up front (sparse file / MAP_NORESERVE), so records never move
+// and readers need no lock.
+//
+// File-backed logs survive restarts: open() maps the existing file and
+// resumes at its record count without reading the records.  The write path
+// is a memcpy into the page cache; a background thread msync()s dirty
+// records once a second, so the writer never blocks on disk I/O.
+//
+// File layout:  [ 512-byte header | record 0 | record 1 | … ]
+// The header also carries a small metadata block owned by the writer (e.g.
+// running aggregates), persisted together with the records.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace golf {
+
+class MappedLog {
+public:
+    static constexpr size_t kMetaSize = 256;
+
+    MappedLog() = default;
+    ~MappedLog();
+
+    MappedLog(const MappedLog&) = delete;
+    MappedLog& operator=(const MappedLog&) = delete;
+
+    /// Map a file-backed log, creating it if missing.  An existing file is
+    /// resumed as-is (its own capacity wins); a record size mismatch fails.
+    /// @param record_size  bytes per record
+    /// @param capacity     max records for a new file
+    bool open(const std::string& path, uint32_t record_size, size_t capacity);
+
+    /// Process-private log; nothing is persisted.
+    bool open_anonymous(uint32_t record_size, size_t capacity);
+
+    /// Writer side (one thread).  Appends `n` consecutive records and
+    /// publishes them together; returns false when they don't fit or the
+    /// log is not open.
+    bool append(const void* records, size_t n = 1);
+
+    /// Published record count (any thread).
+    size_t size() const {
+        return header_ ? count()->load(std::memory_order_acquire) : 0;
+    }
+    size_t capacity() const { return capacity_; }
+    bool is_open() const { return header_ != nullptr; }
+    bool persistent() const { return fd_ >= 0; }
+
+    /// Record i < size() (any thread).
+    const void* record(size_t i) const { return records_ + i * record_size_; }
+
+    /// Writer-owned metadata block (kMetaSize bytes, zero in a new log).
+    void* meta();
+    const void* meta() const;
+
+    /// Flush dirty records and the header to disk now.
+    void sync();
+
+    void close();
+
+private:
+    struct Header;
+
+    bool map(size_t bytes, bool create, uint32_t record_size, size_t capacity);
+    std::atomic<uint64_t>* count() const;
+    void flush_loop();
+
+    Header*  header_ = nullptr;
+    uint8_t* records_ = nullptr;
+    size_t   map_size_ = 0;
+    size_t   capacity_ = 0;
+    uint32_t record_size_ = 0;
+    int      fd_ = -1;
+    std::string path_;
+
+    size_t synced_ = 0;                   // records known to be on disk
+    std::mutex sync_mutex_;
+    std::thread flusher_;
+    std::mutex flush_mutex_;
+    std::condition_variable flush_cv_;
+    bool stopping_ = false;
+};
+
+}  // namespace golf
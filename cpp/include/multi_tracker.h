@@ -0,0 +1,82 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// multi_tracker.h  –  Multi-object Tracker with Data Association
+//
+// Tracks every object of one class (e.g. all balls on the practice green)
+// and gives each a stable id.  Per frame:
+//
+//   1. predict   every track with its constant-velocity Kalman filter
+//   2. associate detections to tracks: gated centre distance, greedy
+//                nearest-pair-first assignment
+//   3. correct   matched tracks; coast unmatched ones until max_lost
+//   4. spawn     tracks for unmatched detections in free slots
+//
+// The track table has a fixed capacity and is stored as structure-of-arrays
+// so the association loop streams through a few contiguous float arrays;
+// nothing is allocated after construction and the per-frame cost is bounded
+// by kCapacity × kMaxDetections.  Input is any detection list – the CPU
+// parser's or the GPU decoder's compacted survivors.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "kalman_tracker.h"
+#include "tracker.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace golf {
+
+class MultiTracker {
+public:
+    static constexpr int kCapacity = 16;          // concurrent tracks
+    static constexpr int kMaxDetections = 64;     // considered per frame
+
+    /// @param opts      max_lost and Kalman noise (the model is always the
+    ///                  constant-velocity filter – association needs its
+    ///                  predictions)
+    /// @param class_id  detections of this class are tracked
+    /// @param gate_px   association radius around a prediction, widened by
+    ///                  the distance the track moves in one frame
+    explicit MultiTracker(const TrackerOptions& opts = {}, int class_id = 0,
+                          float gate_px = 60.f);
+
+    /// Retune max_lost and the Kalman noise of every track (tracks carry on).
+    void set_options(const TrackerOptions& opts);
+
+    /// Feed this frame's detections (other classes are ignored).
+    void update(const std::vector<Detection>& detections, double dt_seconds);
+    void update(const Detection* detections, size_t count, double dt_seconds);
+
+    /// Slots are stable for a track's lifetime (0 .. kCapacity-1).
+    bool active(int slot) const { return active_[slot]; }
+    int  size() const { return num_active_; }
+
+    /// Track state in the single-object format (id set).
+    TrackedObject track(int slot) const;
+
+    /// Slot of the track to treat as "the" ball, or -1 if there is none:
+    /// the fastest visible track, which only hands over to another track
+    /// that is clearly faster (so detection jitter doesn't flip it).
+    int primary() const { return primary_; }
+
+private:
+    int   class_id_;
+    int   max_lost_;
+    float gate_px_;
+    uint32_t next_id_ = 1;
+    int   num_active_ = 0;
+    int   primary_ = -1;
+
+    void choose_primary();
+
+    // Track table (SoA)
+    bool     active_[kCapacity] = {};
+    uint32_t id_[kCapacity] = {};
+    float    x_[kCapacity] = {}, y_[kCapacity] = {};
+    float    vx_[kCapacity] = {}, vy_[kCapacity] = {};
+    float    conf_[kCapacity] = {};
+    int      lost_[kCapacity] = {};
+    KalmanTracker kf_[kCapacity];
+};
+
+}  // namespace golf
@@ -0,0 +1,85 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// output_scheduler.h  –  Fixed-rate Output to Unreal Engine
+//
+// Decouples the UDP rate from the inference rate: the tracking stage only
+// publishes each bay's latest measured state (seqlock, never blocks), and a
+// scheduler thread sends one state per bay per tick at `send_hz`.
+//
+//   new measurement since the last tick  → sent as measured
+//   otherwise                            → ball / putter extrapolated with
+//                                          the tracker's velocity and sent
+//                                          flagged as predicted
+//
+// A predicted state is stamped with the time it describes (measurement
+// capture time + extrapolation span), so the receiver sees evenly spaced,
+// monotonically increasing state times.  Prediction stops max_predict_s
+// after the last measurement and the state is held from then on.  The send
+// policy still applies per tick.  The scheduler thread owns the
+// UnrealSender while it runs.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "putt_stats.h"
+#include "seqlock.h"
+#include "tracker.h"
+#include "unreal_sender.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace golf {
+
+class OutputScheduler {
+public:
+    /// @param sender         initialised sender (used only by the scheduler
+    ///                       thread between start() and stop())
+    /// @param streams        number of bays
+    /// @param send_hz        ticks per second
+    /// @param max_predict_s  longest extrapolation past a measurement
+    OutputScheduler(UnrealSender& sender, int streams, double send_hz,
+                    double max_predict_s = 0.1);
+    ~OutputScheduler();
+
+    OutputScheduler(const OutputScheduler&) = delete;
+    OutputScheduler& operator=(const OutputScheduler&) = delete;
+
+    void start();
+    void stop();
+
+    /// Tracking thread: latest measured state of one bay (wait-free).
+    void publish(int stream, const TrackedObject& ball, const TrackedObject& putter,
+                 const PuttData& stats, std::chrono::steady_clock::time_point capture_time);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Measurement {
+        TrackedObject ball;
+        TrackedObject putter;
+        PuttData stats;
+        Clock::time_point capture_time;
+        Clock::time_point published_at;
+    };
+
+    struct Stream {
+        SeqLock<Measurement> latest;
+        uint32_t seen_version = 0;       // scheduler-private
+    };
+
+    void run();
+    void tick(Stream& s, int stream_id, Clock::time_point now);
+
+    UnrealSender& sender_;
+    std::vector<std::unique_ptr<Stream>> streams_;
+    Clock::duration period_;
+    double max_predict_s_;
+
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+}  // namespace golf
@@ -0,0 +1,128 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// preview_window.h  –  Asynchronous Preview / Overlay Rendering
+//
+// Drawing the overlay, cv::imshow and above all cv::waitKey can stall for
+// several milliseconds – time the tracking stage would otherwise spend
+// between frames, showing up in its dt and in the send cadence.  The
+// preview runs on its own thread instead:
+//
+//   tracking stage ── publish() ──> one-slot mailbox per bay ──> GUI thread
+//
+// publish() swaps the frame and detection buffers into the bay's mailbox
+// (no copy) and hands back the mailbox's previous buffers for the frame
+// pool to reuse.  An unrendered frame is simply replaced, so the preview
+// drops frames freely and never holds up the caller.  The GUI thread wakes
+// at `fps`, renders whatever is new – optionally from a downscaled copy –
+// and owns every HighGUI call.  Pressing 'q' in a window sets
+// quit_requested().
+//
+// Rendered frames also feed an attached VideoStream (remote MJPEG view).
+// Without a local window a bay is only rendered while a stream client
+// watches it; otherwise publish() returns straight away.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "frame_pipeline.h"
+#include "multi_tracker.h"
+#include "putt_stats.h"
+#include "tracker.h"
+#include "video_stream.h"
+
+#include <opencv2/opencv.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace golf {
+
+struct PreviewOptions {
+    double fps   = 60.0;      // render rate (the monitor's refresh)
+    double scale = 1.0;       // render from a copy downscaled by this factor
+    bool   window = true;     // show local HighGUI windows
+};
+
+/// Overlay inputs of one processed frame (fixed size, copied by value).
+struct PreviewState {
+    TrackedObject ball;
+    TrackedObject putter;
+    bool          putter_visible = false;
+    TrackedObject balls[MultiTracker::kCapacity];   // --multi-ball tracks
+    int           num_balls = 0;
+    PuttData      stats;
+    cv::Rect      roi;               // region fed to the network
+    double        fps = 0.0;         // processing rate of this bay
+};
+
+class PreviewWindow {
+public:
+    PreviewWindow(int sources, const PreviewOptions& opts);
+    ~PreviewWindow();
+
+    PreviewWindow(const PreviewWindow&) = delete;
+    PreviewWindow& operator=(const PreviewWindow&) = delete;
+
+    /// Also send rendered frames to `stream` (call before start()).
+    void set_stream(VideoStream* stream) { stream_ = stream; }
+
+    void start();
+    void stop();
+
+    /// Whether frames of `source` are currently rendered at all.
+    bool wanted(int source) const {
+        return opts_.window || (stream_ && stream_->watching(source));
+    }
+
+    /// Tracking thread: show this frame of `source`.  `frame` and
+    /// `detections` are swapped with buffers the preview is done with.
+    void publish(int source, cv::Mat& frame, std::vector<Detection>& detections,
+                 const PreviewState& state);
+
+    /// 'q' was pressed in a preview window.
+    bool quit_requested() const { return quit_.load(std::memory_order_relaxed); }
+
+    uint64_t rendered() const { return rendered_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Mailbox {
+        std::mutex mutex;
+        bool fresh = false;
+        cv::Mat frame;
+        std::vector<Detection> detections;
+        PreviewState state;
+    };
+
+    // GUI thread only
+    struct View {
+        cv::Mat frame;                    // last frame taken from the mailbox
+        cv::Mat scaled;
+        std::vector<Detection> detections;
+        PreviewState state;
+        std::string title;
+    };
+
+    void run();
+    bool take(int source);
+    void render(int source);
+
+    PreviewOptions opts_;
+    VideoStream* stream_ = nullptr;
+    std::vector<std::unique_ptr<Mailbox>> mailboxes_;
+    std::vector<View> views_;
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> quit_{false};
+    std::atomic<uint64_t> rendered_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::thread thread_;
+};
+
+}  // namespace golf
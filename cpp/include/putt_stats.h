@@ -4,14 +4,30 @@
 //
 // State-machine that monitors the ball tracker and computes per-putt stats:
 //   launch speed, peak speed, total distance, break, time in motion, etc.
+//
+// update() is called from one thread only (the tracking stage) and never
+// blocks: the current putt is published through a seqlock and finished
+// putts are appended to an mmap'd record log, so StatsApi readers polling
+// from their own threads neither stall the writer nor copy the history.
+// With open_history() the log is a file that survives restarts.
+//
+// Every IN_MOTION frame is also recorded as a TrajectorySample into a
+// preallocated per-ball buffer and copied into a second record log (the
+// trajectory arena) when the putt finishes; a finished putt refers to its
+// samples by index, so recording never allocates.
+//
+// With several balls on the green (MultiTracker) each ball track runs its
+// own state machine in a fixed slot; their putts share the bay's history
+// and session, and current() follows the ball in motion.
 // ─────────────────────────────────────────────────────────────────────────────
 
+#include "mapped_log.h"
+#include "seqlock.h"
 #include "tracker.h"
 
 #include <cstdint>
-#include <mutex>
+#include <memory>
 #include <string>
-#include <vector>
 
 namespace golf {
 
@@ -20,6 +36,7 @@ enum class PuttState { IDLE, IN_MOTION, STOPPED };
 struct PuttData {
     int      putt_number    = 0;
     PuttState state         = PuttState::IDLE;
+    uint32_t ball_id        = 0;     // TrackedObject::id of the putted ball
 
     float launch_speed      = 0.f;   // px/s at first motion
     float current_speed     = 0.f;   // px/s real-time
@@ -31,6 +48,10 @@ struct PuttData {
     float start_x = 0.f, start_y = 0.f;
     float final_x = 0.f, final_y = 0.f;
 
+    // Ball path of this putt in the trajectory arena
+    uint32_t trajectory_begin = 0;
+    uint32_t trajectory_count = 0;
+
     const char* state_str() const {
         switch (state) {
             case PuttState::IDLE:      return "idle";
@@ -41,14 +62,85 @@ struct PuttData {
     }
 };
 
+/// One tracked ball position during a putt.
+struct TrajectorySample {
+    float t = 0.f;                    // seconds since launch
+    float x = 0.f, y = 0.f;           // px
+    float vx = 0.f, vy = 0.f;         // px/s
+    float confidence = 0.f;
+};
+static_assert(sizeof(TrajectorySample) == 24, "served as packed float32 rows");
+
+/// Contiguous view of published records, pointing straight into a log.
+template <typename T>
+class RecordView {
+public:
+    RecordView(const T* data, size_t n) : data_(data), n_(n) {}
+    size_t size() const { return n_; }
+    bool empty() const { return n_ == 0; }
+    const T& operator[](size_t i) const { return data_[i]; }
+    const T* data() const { return data_; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + n_; }
+
+private:
+    const T* data_;
+    size_t n_;
+};
+
 class PuttStats {
 public:
     explicit PuttStats(float motion_threshold = 5.f, int stop_frames = 15);
 
+    using History = RecordView<PuttData>;
+    using Trajectory = RecordView<TrajectorySample>;
+
+    static constexpr size_t kHistoryCapacity = 1 << 20;
+    static constexpr size_t kTrajectoryCapacity = 1 << 24;   // samples, all putts
+    static constexpr uint32_t kMaxTrajectorySamples = 4096;  // per putt
+    static constexpr int kMaxBalls = 16;                      // state machines
+
+    /// Persist finished putts to `path` and their trajectories to
+    /// `path`.traj (created if missing) and resume the session stored there
+    /// – putt numbering and aggregates continue and the records are served
+    /// from the mapping without being read.  Call before the first update().
+    bool open_history(const std::string& path);
+
+    /// Writer side – tracking thread only.  Single-ball form (slot 0).
     void update(const TrackedObject& ball, double dt);
 
-    PuttData current() const;
-    std::vector<PuttData> history() const;
+    /// Multi-ball form: feed ball track `slot` (0 .. kMaxBalls-1, e.g. a
+    /// MultiTracker slot).  A new TrackedObject::id restarts the slot's
+    /// state machine; a putt whose track ends (invalid or replaced) is
+    /// finished where the ball was last seen.
+    void update(int slot, const TrackedObject& ball, double dt);
+
+    /// Retune motion detection (tracking thread only); a putt in progress
+    /// carries on with the new thresholds.
+    void set_thresholds(float motion_threshold, int stop_frames) {
+        motion_threshold_ = motion_threshold;
+        stop_frames_required_ = stop_frames;
+    }
+
+    /// Latest published state of the current putt (any thread, wait-free
+    /// for the writer).
+    PuttData current() const { return published_.load(); }
+
+    /// Completed putts, iterated in place (any thread).
+    History history() const {
+        return History(static_cast<const PuttData*>(history_.record(0)),
+                       history_.size());
+    }
+
+    /// Ball path of a putt from history() (any thread); empty if its
+    /// samples are not available (e.g. history resumed without them).
+    Trajectory trajectory(const PuttData& putt) const;
+
+    /// Distribution of one per-putt quantity over the session.
+    struct Aggregate {
+        float min = 0.f, max = 0.f;
+        float mean = 0.f, stddev = 0.f;   // population standard deviation
+    };
 
     struct SessionSummary {
         int   total_putts     = 0;
@@ -56,27 +148,70 @@ public:
         float avg_distance     = 0.f;
         float avg_break        = 0.f;
         float avg_time         = 0.f;
+
+        Aggregate launch_speed;
+        Aggregate distance;
+        Aggregate break_distance;
+        Aggregate time_in_motion;
     };
 
-    SessionSummary session() const;
+    /// Running session aggregates, updated once per finished putt (O(1),
+    /// any thread).
+    SessionSummary session() const { return session_.load(); }
 
 private:
     float motion_threshold_;
     int   stop_frames_required_;
 
-    mutable std::mutex mu_;
-    PuttData current_;
-    std::vector<PuttData> history_;
+    /// Per-ball state machine (writer-private).
+    struct Motion {
+        PuttData current;
+        int   frames_below_threshold = 0;
+        float prev_x = 0.f, prev_y = 0.f;
+        bool  has_prev = false;
+
+        // Initial direction unit vector for break computation
+        float dir_x = 0.f, dir_y = 0.f;
+        bool  has_direction = false;
+    };
+
+    Motion motion_[kMaxBalls];
+    std::unique_ptr<TrajectorySample[]> staging_;   // kMaxBalls × kMaxTrajectorySamples
+    int published_slot_ = 0;
+    SeqLock<PuttData> published_;
+    MappedLog history_;
+    MappedLog trajectories_;            // TrajectorySample arena
+
+    /// Welford accumulator for one quantity (writer-private).
+    struct RunningStat {
+        int    n = 0;
+        double mean = 0.0, m2 = 0.0;
+        float  min = 0.f, max = 0.f;
+
+        void add(float v);
+        Aggregate get() const;
+    };
+
+    /// Accumulators as persisted in the log's metadata block.  Written
+    /// after the record they include, so `records` tells whether a crash
+    /// came in between (the aggregates are then rebuilt from the records).
+    struct Meta {
+        static constexpr uint32_t kVersion = 2;
+
+        uint32_t    version;
+        uint64_t    records;          // history records the aggregates cover
+        RunningStat launch, distance, brk, time;
+    };
 
-    int   frames_below_threshold_ = 0;
-    float prev_x_ = 0.f, prev_y_ = 0.f;
-    bool  has_prev_ = false;
+    RunningStat launch_, distance_, break_, time_;
+    SeqLock<SessionSummary> session_;
 
-    // Initial direction unit vector for break computation
-    float dir_x_ = 0.f, dir_y_ = 0.f;
-    bool  has_direction_ = false;
+    void publish_session();
 
-    void finalize_putt();
+    void begin_putt(Motion& m, const TrackedObject& ball, float speed);
+    void record_sample(int slot, const TrackedObject& ball);
+    void finalize_putt(int slot);
+    void end_track(int slot);
 };
 
 }  // namespace golf
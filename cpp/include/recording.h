@@ -0,0 +1,191 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// recording.h  –  Record & Replay of Live Sessions (.golfrec)
+//
+// A recording keeps what the tracking stage saw for each frame of one bay:
+// the image (raw BGR or JPEG), its source and host capture timestamps, the
+// detections and the resulting tracker / putt state.  Replaying it through
+// FramePipeline (any source ending in .golfrec) reproduces a bad putt with
+// the exact frame timing of the live run, without a camera; golf_replay
+// re-runs the tracker and PuttStats on the recorded detections without a
+// GPU.
+//
+// File layout (little-endian, 8-byte aligned chunks):
+//
+//   [ RecordingHeader | chunk 0 | chunk 1 | … | index | trailer ]
+//   chunk = ChunkHeader, Detection[num_detections], image bytes
+//
+// The writer appends chunks from its own thread and writes the index of
+// chunk offsets on close().  The reader maps the file read-only and serves
+// chunks straight out of the mapping; a file without a trailer (the
+// recording process died) is indexed by walking the chunks instead.
+// Struct sizes are stored in the header, so a recording only opens with a
+// build that lays out Detection / TrackedObject the same way.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "capture_backend.h"
+#include "frame_pipeline.h"
+#include "putt_stats.h"
+#include "spsc_ring.h"
+#include "tracker.h"
+
+#include <opencv2/opencv.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace golf {
+
+enum class FrameEncoding : uint32_t { RAW, JPEG };
+
+/// Parse "raw" / "jpeg".  Returns false if unknown.
+bool parse_frame_encoding(const std::string& name, FrameEncoding& out);
+const char* frame_encoding_name(FrameEncoding encoding);
+
+/// Whether `path` names a recording (by its .golfrec extension).
+bool is_recording(const std::string& path);
+
+// ─── On-disk Structures ─────────────────────────────────────────────────────
+struct RecordingHeader {
+    char     magic[8];                // "GOLFREC"
+    uint32_t version;
+    uint32_t chunk_header_size;       // sizeof(ChunkHeader)
+    uint32_t detection_size;          // sizeof(Detection)
+    uint32_t object_size;             // sizeof(TrackedObject)
+    int32_t  bay;                     // source index at record time
+    uint32_t reserved[9];
+};
+
+struct ChunkHeader {
+    uint32_t magic;                   // kChunkMagic
+    uint32_t bytes;                   // whole chunk incl. this header
+    uint64_t seq;                     // per-source frame counter
+    double   source_time;             // FramePipeline::timestamp(), s (< 0: none)
+    double   capture_time;            // host clock since recording start, s
+    int32_t  width, height;
+    FrameEncoding encoding;
+    uint32_t image_bytes;
+    uint32_t num_detections;
+    int32_t  putt_number;
+    PuttState putt_state;
+    uint32_t reserved;
+    TrackedObject ball;               // tracker output for this frame
+    TrackedObject putter;
+};
+
+// ─── Writer ─────────────────────────────────────────────────────────────────
+// record() copies the frame into one of a few pre-allocated slots and
+// returns; the writer thread encodes and appends it.  With every slot
+// still queued the frame is dropped (counted), so a slow disk shows up as
+// gaps in the recording rather than as tracking latency.
+class RecordingWriter {
+public:
+    struct Options {
+        FrameEncoding encoding = FrameEncoding::JPEG;
+        int quality = 95;             // JPEG quality
+        int slots = 8;                // frames buffered for the writer thread
+    };
+
+    RecordingWriter() = default;
+    ~RecordingWriter();
+
+    RecordingWriter(const RecordingWriter&) = delete;
+    RecordingWriter& operator=(const RecordingWriter&) = delete;
+
+    bool open(const std::string& path, int bay, const Options& opts);
+
+    /// Tracking thread: one processed frame and what was made of it.
+    void record(const cv::Mat& frame, uint64_t seq, double source_time,
+                std::chrono::steady_clock::time_point capture_time,
+                const std::vector<Detection>& detections,
+                const TrackedObject& ball, const TrackedObject& putter,
+                const PuttData& stats);
+
+    /// Drain queued frames, write the index and close the file.
+    void close();
+
+    uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        ChunkHeader header{};
+        cv::Mat frame;
+        std::vector<Detection> detections;
+    };
+
+    void run();
+    bool write_slot(Slot& slot);
+    bool write_bytes(const void* data, size_t n);
+
+    Options opts_;
+    std::string path_;
+    std::FILE* file_ = nullptr;
+    uint64_t offset_ = 0;
+    std::vector<uint64_t> index_;         // writer thread only
+    bool failed_ = false;
+    std::vector<uint8_t> jpeg_;
+
+    std::vector<Slot> slots_;
+    std::unique_ptr<SpscRing<int>> free_;     // writer → tracking thread
+    std::unique_ptr<SpscRing<int>> filled_;   // tracking → writer thread
+    bool has_start_ = false;
+    std::chrono::steady_clock::time_point start_;
+
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::thread thread_;
+};
+
+// ─── Reader ─────────────────────────────────────────────────────────────────
+class RecordingReader {
+public:
+    RecordingReader() = default;
+    ~RecordingReader();
+
+    RecordingReader(const RecordingReader&) = delete;
+    RecordingReader& operator=(const RecordingReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    size_t size() const { return chunks_.size(); }
+    int bay() const { return bay_; }
+
+    /// Chunk i < size(), straight from the mapping.
+    const ChunkHeader& chunk(size_t i) const { return chunk_at(chunks_[i]); }
+    const Detection* detections(size_t i) const;
+
+    /// Decode chunk i's image into `frame` (reusing its buffer).
+    bool decode(size_t i, cv::Mat& frame) const;
+
+private:
+    const ChunkHeader& chunk_at(uint64_t offset) const {
+        return *reinterpret_cast<const ChunkHeader*>(data_ + offset);
+    }
+    /// A well-formed chunk at `offset` that ends by `end`.
+    bool chunk_fits(uint64_t offset, uint64_t end) const;
+    bool load_index(size_t file_size);
+    void scan(size_t file_size);
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    int bay_ = 0;
+    std::vector<uint64_t> chunks_;        // offsets of chunks that fit
+};
+
+/// Capture backend replaying a recording.  CaptureOptions::replay_speed
+/// scales the recorded frame timing (1 = original, 0 = as fast as
+/// possible); timestamp() reports the recorded source time, or the
+/// recorded host time for sources that had none.
+std::unique_ptr<CaptureBackend> make_replay_capture();
+
+}  // namespace golf
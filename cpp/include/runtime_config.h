@@ -0,0 +1,107 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// runtime_config.h  –  Tuning Knobs from a Config File, Hot-reloadable
+//
+// The detection threshold, tracker and putt-detection parameters of every
+// bay, loaded from a YAML file (golf_sim --config, see configs/golf_sim.yaml)
+// and changed at run time through POST /api/config without restarting –
+// engines stay loaded, cameras open and putt history intact:
+//
+//   detection:
+//     conf_thresh: 0.5
+//   tracker:
+//     alpha: 0.6
+//   putt:
+//     motion_threshold: 5.0
+//   bays:
+//     1:                   # overrides for bay 1 only
+//       detection:
+//         conf_thresh: 0.4
+//
+// The same document may be sent as JSON.  Settings are merged into the
+// current document (a POST only needs the keys it changes), validated as a
+// whole, and published per bay through a SeqLock: a rejected update
+// changes nothing, and readers never block.  The tracking thread compares
+// version() between frames and re-applies bay() to its trackers and the
+// inference stage when it changed.
+//
+// Only a small YAML subset is understood – nested maps of scalars, "#"
+// comments, no lists, anchors or multi-line strings.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "seqlock.h"
+#include "tracker.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace golf {
+
+/// Everything that can be retuned for one bay.
+struct BayParams {
+    float          conf_thresh      = 0.5f;   // detection confidence
+    TrackerOptions tracker;
+    float          motion_threshold = 5.f;    // px/s; PuttStats
+    int            stop_frames      = 15;
+};
+
+/// Flatten a YAML-subset or JSON document (detected by a leading "{") to
+/// dotted keys, e.g. "bays.1.tracker.alpha" → "0.5".
+/// @param error  set to a message naming the offending line on failure
+bool parse_config(const std::string& text, std::map<std::string, std::string>& out,
+                  std::string& error);
+
+class RuntimeConfig {
+public:
+    /// @param defaults  what every bay runs with for keys no document sets
+    ///                  (from the command line)
+    RuntimeConfig(int bays, const BayParams& defaults);
+
+    RuntimeConfig(const RuntimeConfig&) = delete;
+    RuntimeConfig& operator=(const RuntimeConfig&) = delete;
+
+    /// Apply a config file and remember it for reload().
+    bool load(const std::string& path);
+
+    /// Merge a document into the current one and publish it.
+    /// @param error  why it was rejected (nothing changes then)
+    bool apply(const std::string& text, std::string& error);
+
+    /// Re-read the file given to load(); it replaces the whole document,
+    /// so settings POSTed since are dropped.
+    bool reload(std::string& error);
+
+    int size() const { return static_cast<int>(bays_.size()); }
+
+    /// Current parameters of a bay (any thread, wait-free).
+    BayParams bay(int b) const { return bays_[b]->load(); }
+
+    /// Changes on every successful apply() / reload().
+    uint32_t version() const { return version_.load(std::memory_order_acquire); }
+
+    /// {"version":…, "file":…, "settings":{…}, "bays":[{…resolved…}]}
+    std::string to_json() const;
+
+private:
+    using Document = std::map<std::string, std::string>;
+
+    /// Resolve `doc` over the defaults into one BayParams per bay.
+    bool resolve(const Document& doc, std::vector<BayParams>& out,
+                 std::string& error) const;
+    void publish(const Document& doc, const std::vector<BayParams>& params);
+
+    BayParams defaults_;
+    std::vector<std::unique_ptr<SeqLock<BayParams>>> bays_;
+    std::atomic<uint32_t> version_{0};
+
+    mutable std::mutex mutex_;        // writers, and doc_ / path_ readers
+    Document doc_;
+    std::string path_;
+};
+
+}  // namespace golf
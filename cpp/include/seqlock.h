@@ -0,0 +1,82 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// seqlock.h  –  Single-Writer Snapshot Publication
+//
+// SeqLock<T>   one value that a single writer overwrites without ever
+//              blocking; readers copy it out and retry if a write raced
+//              with the copy.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace golf {
+
+// ─── SeqLock ────────────────────────────────────────────────────────────────
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SeqLock payload must be trivially copyable");
+
+public:
+    SeqLock() { store(T{}); }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    /// Writer side (one thread only).  Wait-free.
+    void store(const T& value) {
+        uint64_t words[kWords] = {};
+        std::memcpy(words, &value, sizeof(T));
+
+        const uint32_t s = seq_.load(std::memory_order_relaxed);
+        seq_.store(s + 1, std::memory_order_relaxed);     // odd: write open
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < kWords; ++i) {
+            words_[i].store(words[i], std::memory_order_relaxed);
+        }
+        seq_.store(s + 2, std::memory_order_release);     // even: published
+    }
+
+    /// Reader side (any thread).  Never blocks the writer; retries only
+    /// while a store() is in progress.
+    T load() const {
+        uint32_t version;
+        return load(version);
+    }
+
+    /// load() that also reports the version() of the value it returns, read
+    /// in the same consistent pass – a store landing between a separate
+    /// version() and load() would pair a new value with an old version.
+    T load(uint32_t& version) const {
+        uint64_t words[kWords];
+        uint32_t before, after;
+        do {
+            before = seq_.load(std::memory_order_acquire);
+            for (size_t i = 0; i < kWords; ++i) {
+                words[i] = words_[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = seq_.load(std::memory_order_relaxed);
+        } while ((before & 1u) || before != after);
+
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        version = before >> 1;
+        return value;
+    }
+
+    /// Number of completed stores (changes whenever the value does).
+    uint32_t version() const { return seq_.load(std::memory_order_acquire) >> 1; }
+
+private:
+    static constexpr size_t kWords = (sizeof(T) + 7) / 8;
+
+    std::atomic<uint32_t> seq_{0};
+    std::atomic<uint64_t> words_[kWords];
+};
+
+}  // namespace golf
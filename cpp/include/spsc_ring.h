@@ -0,0 +1,97 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// spsc_ring.h  –  Bounded Lock-Free Single-Producer / Single-Consumer Ring
+//
+// Fixed-capacity ring buffer joining two pipeline stages.  Exactly one thread
+// may push and exactly one thread may pop; neither side ever takes a lock.
+//
+// The producer may also pop – to evict the oldest item of a full ring so
+// the newest one always gets in ("latest wins").  Each slot carries a
+// sequence number, so a pop claims its slot with a CAS on the tail and the
+// producer only reuses a slot once its reader has finished moving out.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace golf {
+
+template <typename T>
+class SpscRing {
+public:
+    /// @param capacity  number of slots (rounded up to a power of two)
+    explicit SpscRing(size_t capacity) {
+        size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        slots_ = std::make_unique<Slot[]>(cap);
+        for (size_t i = 0; i < cap; ++i) {
+            slots_[i].seq.store(i, std::memory_order_relaxed);
+        }
+        mask_ = cap - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /// Producer side.  Returns false (item untouched) when the ring is full.
+    bool try_push(T&& item) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[head & mask_];
+        if (slot.seq.load(std::memory_order_acquire) != head) return false;
+
+        slot.value = std::move(item);
+        slot.seq.store(head + 1, std::memory_order_release);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer side, or the producer evicting the oldest item.  Returns
+    /// false when the ring is empty.
+    bool try_pop(T& out) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[tail & mask_];
+            const size_t seq = slot.seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<intptr_t>(seq - (tail + 1));
+            if (diff < 0) return false;                      // not written yet
+            if (diff > 0) {                                  // the other side took it
+                tail = tail_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed)) {
+                out = std::move(slot.value);
+                slot.seq.store(tail + mask_ + 1, std::memory_order_release);   // free
+                return true;
+            }
+        }
+    }
+
+    /// Approximate number of queued items.
+    size_t size() const {
+        const size_t head = head_.load(std::memory_order_acquire);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        return head > tail ? head - tail : 0;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+    bool empty() const { return size() == 0; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> seq{0};   // == position: free; position + 1: filled
+        T value{};
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_ = 0;
+
+    // Each index lives on its own cache line so producer and consumer
+    // don't false-share.
+    alignas(64) std::atomic<size_t> head_{0};   // next slot to write
+    alignas(64) std::atomic<size_t> tail_{0};   // next slot to read
+};
+
+}  // namespace golf
@@ -0,0 +1,274 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// staged_pipeline.h  –  Multi-threaded Capture → Preprocess → Infer Pipeline
+//
+// Each stage runs on its own thread and hands frames to the next stage through
+// lock-free SPSC rings, one ring per video source at every hand-off:
+//
+//   [capture 0..N-1] ─ring─> [preprocess] ─ring─> [inference] ─ring─> next()
+//
+// The inference stage gathers the newest frame from each source into one
+// batched enqueue, so several putting bays share a single engine.  With an
+// EnginePool spanning several GPUs a batch holds at most sources / GPUs
+// frames, so one round of cameras is spread over the devices; NVDEC frames
+// only batch with others decoded on the same GPU.
+//
+// The tracking / output stage is whoever calls next() (the main thread, so
+// that the OpenCV preview keeps working).  With GPU pre-processing the
+// preprocess thread is skipped and the kernel runs on the inference thread,
+// directly into the engine's input binding.  Likewise GPU post-processing
+// decodes the output binding in place and only the compacted detections are
+// copied back.
+//
+// With a FrameGovernor attached, capture threads still read every frame but
+// only hand the ones it admits to the next stage (duty cycling while idle).
+//
+// In ROI mode the tracking stage reports the ball back through
+// update_ball_hint(); frames are then cropped around the predicted position
+// (x + v·Δt) at native resolution, with a full frame whenever the track is
+// lost and periodically to pick up anything outside the crop.
+//
+// The inference stage keeps every context of the pool busy: each batch goes
+// to the idle context on the least-loaded GPU, is uploaded and enqueued
+// while earlier batches still execute, and is collected as soon as it is
+// done – in any order.  A per-source reorder ring holds a frame that
+// finished early until the camera's older frames are out, so next() sees
+// each source's frames in capture order.
+//
+// Frames are pooled contexts (see frame_pool.h): dropped frames and the one
+// next() last returned go back to the pool with their buffers, so after
+// warm-up no stage allocates per frame.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "engine_pool.h"
+#include "frame_governor.h"
+#include "frame_pipeline.h"
+#include "frame_pool.h"
+#include "gpu_postprocess.h"
+#include "gpu_preprocess.h"
+#include "latency_metrics.h"
+#include "spsc_ring.h"
+#include "tracker.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace golf {
+
+/// What a stage does when its downstream consumer can't keep up.
+enum class DropPolicy {
+    BLOCK,    // producer waits for a free slot – every frame is processed
+    LATEST,   // consumer skips to the newest queued frame and a producer
+              // facing a full ring evicts the oldest one – stale frames are
+              // dropped to bound latency
+};
+
+/// Where the resize / colour / CHW pre-processing runs.
+enum class PreprocessMode { CPU, GPU };
+
+/// Where detections are thresholded and decoded: the whole output tensor is
+/// copied back and parsed (CPU reference), or only survivors are (GPU).
+enum class PostprocessMode { CPU, GPU };
+
+struct PipelineOptions {
+    float          conf_thresh = 0.5f;
+    DropPolicy     drop_policy = DropPolicy::LATEST;
+    size_t         queue_depth = 2;       // slots per inter-stage ring
+    PreprocessMode preprocess  = PreprocessMode::GPU;
+    PostprocessMode postprocess = PostprocessMode::GPU;
+    bool           letterbox   = false;   // aspect-preserving resize
+
+    // Crop-and-track: while the ball is tracked, feed the network a
+    // native-resolution crop (network input size) centred on the predicted
+    // ball position instead of the downscaled frame.
+    bool roi = false;
+    int  roi_full_interval = 10;          // force a full frame every N crops
+                                          // (keep below the tracker's max_lost)
+};
+
+/// Snapshot of one inter-stage queue.
+struct StageStats {
+    std::string name;    // e.g. "capture[1]"
+    int      source;
+    size_t   depth;      // frames currently queued
+    size_t   capacity;
+    uint64_t pushed;     // frames handed to the next stage
+    uint64_t dropped;    // frames discarded by the drop policy
+};
+
+// ─── Staged Pipeline ────────────────────────────────────────────────────────
+class StagedPipeline {
+public:
+    /// @param sources  opened frame sources (one capture thread each)
+    /// @param engines  loaded engines (used only on the inference thread)
+    /// @param opts     thresholds, drop policy and pre-processing path
+    /// @param metrics  optional per-stage latency sink
+    StagedPipeline(std::vector<FramePipeline*> sources, EnginePool& engines,
+                   const PipelineOptions& opts, LatencyMetrics* metrics = nullptr);
+    ~StagedPipeline();
+
+    StagedPipeline(const StagedPipeline&) = delete;
+    StagedPipeline& operator=(const StagedPipeline&) = delete;
+
+    /// Spawn the capture, preprocess and inference threads.
+    void start();
+
+    /// Stop all stage threads and join them.
+    void stop();
+
+    /// Wait for the next fully processed frame from any source (detections
+    /// parsed; sources are served round-robin).  Returns false once every
+    /// source has ended and the pipeline is drained, or after stop().
+    /// Whatever `item` held before is recycled first, so keep no reference
+    /// into it across calls.
+    bool next(FrameItem& item);
+
+    /// Return a frame's buffers to the pool without waiting for the next.
+    void recycle(FrameItem& item) { pool_.release(item); }
+
+    const FramePool& pool() const { return pool_; }
+
+    /// True if next() would return a frame without waiting (lets the output
+    /// stage batch work, e.g. one UDP flush for all bays of a batch).
+    bool has_ready() const { return !all_empty(infer_q_); }
+
+    int num_sources() const { return static_cast<int>(sources_.size()); }
+
+    /// Gate frames between capture and pre-processing (call before start()).
+    void set_governor(FrameGovernor* governor) { governor_ = governor; }
+
+    /// Feed the latest ball track back for ROI mode (call after each
+    /// Tracker::update()).  A crop is only used while the ball was detected
+    /// in the most recent frame.
+    /// @param at  capture time of the frame the track was updated with
+    void update_ball_hint(int source, const TrackedObject& ball,
+                          std::chrono::steady_clock::time_point at);
+
+    /// Confidence threshold for one source's detections from its next
+    /// batch on (any thread; PipelineOptions::conf_thresh until set).
+    void set_conf_thresh(int source, float thresh) {
+        conf_thresh_[source].store(thresh, std::memory_order_relaxed);
+    }
+
+    /// With roi: full frame every `crops` crops for one source from its
+    /// next frame on (any thread; PipelineOptions::roi_full_interval until
+    /// set).
+    void set_roi_full_interval(int source, int crops) {
+        roi_full_interval_[source].store(crops, std::memory_order_relaxed);
+    }
+
+    /// Per-queue depth and drop counters (safe to call from any thread).
+    std::vector<StageStats> stats() const;
+
+private:
+    struct StageQueue {
+        StageQueue(std::string n, int src, size_t cap)
+            : name(std::move(n)), source(src), ring(cap) {}
+        std::string name;
+        int source;
+        SpscRing<FrameItem> ring;
+        std::atomic<uint64_t> pushed{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> closed{false};   // producer has finished
+    };
+    /// One queue per source at a stage boundary.
+    using QueueSet = std::vector<std::unique_ptr<StageQueue>>;
+
+    /// Last ball state reported by the tracking stage, per source.
+    struct BallHint {
+        std::mutex mutex;
+        bool  valid = false;
+        float x = 0.f, y = 0.f, vx = 0.f, vy = 0.f;
+        std::chrono::steady_clock::time_point time;
+        int   crops_since_full = 0;   // touched only by the preparing stage
+    };
+
+    /// One pool context's batch in flight and its GPU staging.
+    struct InferContext {
+        GpuPreprocessor pre;
+        GpuPostprocessor post;
+        std::vector<FrameItem> batch;     // empty == idle
+        std::vector<size_t> order;        // batch[k]'s reorder entry
+        uint64_t ticket = 0;              // dispatch order
+    };
+
+    /// One source's frames in dispatch order, from enqueue until every
+    /// older frame of the source has been handed on.
+    struct Reorder {
+        struct Entry {
+            int  ctx = -1;                // context the frame ran on
+            bool done = false;            // results collected
+            bool ok = false;              // … successfully
+            FrameItem item;               // valid once done
+        };
+        std::vector<Entry> ring;
+        size_t head = 0;
+        size_t count = 0;
+    };
+    static constexpr int kReorderDepth = 2;   // entries per source and context
+
+    static size_t pool_capacity(int sources, const PipelineOptions& opts,
+                                const EnginePool& engines);
+
+    QueueSet make_queues(const char* stage) const;
+    static void close(QueueSet& qs);
+    static bool all_empty(const QueueSet& qs);
+
+    bool push(StageQueue& q, FrameItem&& item);
+    bool try_take(StageQueue& q, FrameItem& item);
+    bool pop_any(QueueSet& qs, int& cursor, FrameItem& item);
+    bool gather(QueueSet& qs, int& cursor, std::vector<FrameItem>& batch);
+
+    void capture_loop(int source);
+    void preprocess_loop();
+    void infer_loop();
+    bool enqueue(int ctx, std::vector<FrameItem>& batch);
+    void admit(int ctx, std::vector<FrameItem>& batch);
+    void finish(int ctx);
+    void collect();
+    bool finish_oldest(int device);
+    void drain();
+    void flush(int source);
+    void decode(int ctx, int k, const float* out, FrameItem& item);
+    float record_gpu_timings(int ctx);
+    /// GPU holding the batch's device frames (gather() keeps them on one),
+    /// -1 for host frames only.
+    static int batch_device(const std::vector<FrameItem>& batch);
+
+    /// Choose the network input region and set item.roi / transform.
+    void prepare(FrameItem& item);
+    cv::Rect choose_roi(const FrameItem& item);
+
+    std::vector<FramePipeline*> sources_;
+    EnginePool& engines_;
+    PipelineOptions opts_;
+    LatencyMetrics* metrics_;
+    FrameGovernor* governor_ = nullptr;
+    FramePool pool_;
+    int batch_limit_;                      // frames per enqueue
+    std::vector<std::unique_ptr<InferContext>> contexts_;   // one per pool context
+    std::vector<Reorder> reorder_;         // one per source
+    uint64_t tickets_ = 0;
+
+    QueueSet capture_q_;
+    QueueSet preprocess_q_;
+    QueueSet infer_q_;
+    int next_cursor_ = 0;                  // round-robin position for next()
+    std::vector<FrameItem> deferred_;      // gather(): device frames for another GPU
+    std::vector<std::unique_ptr<BallHint>> hints_;
+    std::unique_ptr<std::atomic<float>[]> conf_thresh_;   // per source
+    std::unique_ptr<std::atomic<int>[]> roi_full_interval_;   // per source
+
+    std::atomic<bool> running_{false};
+    std::vector<std::thread> capture_threads_;
+    std::thread preprocess_thread_;
+    std::thread infer_thread_;
+};
+
+}  // namespace golf
@@ -5,37 +5,161 @@
 // Exposes stats over HTTP so external services (dashboards, mobile apps, etc.)
 // can query the current putting session.
 //
-// Endpoints:
+// Endpoints (multi-camera setups select a bay with ?bay=N, default 0):
+//   GET /api/bays           – number of bays served
 //   GET /api/stats/current  – current putt data
-//   GET /api/stats/history  – all completed putts
-//   GET /api/stats/session  – session summary (averages)
+//   GET /api/stats/history  – completed putts; ?since=<putt_number>&limit=N
+//                             pages through them (X-Next-Since cursor)
+//   GET /api/stats/session  – session summary (mean / min / max / stddev)
+//   GET /api/stats/putt/{n}/trajectory
+//                           – ball path of finished putt n (compact JSON,
+//                             or float32 rows with ?format=binary)
+//   GET /api/stats/stream   – Server-Sent Events: "putt" on every state
+//                             transition, throttled "update" while live
+//                             values change (all bays unless ?bay=N)
+//   GET /api/metrics        – per-stage latency percentiles, UDP traffic
+//                             and event channel counters, inference
+//                             governor state and per-GPU context load
+//                             (JSON, or Prometheus text with
+//                             ?format=prometheus)
+//   GET /api/video          – annotated MJPEG stream (multipart/x-mixed-
+//                             replace), with --video-fps
+//   GET /api/config         – tuning parameters in effect, per bay
+//   POST /api/config        – merge a YAML / JSON document into them (an
+//                             empty body re-reads the --config file); from
+//                             this host only, or from anywhere with the
+//                             --api-token as a Bearer token
+//
+// History, session and trajectory responses carry an ETag and answer If-None-Match
+// with 304.  The history JSON is cached per bay and only extended when a
+// putt finishes.
+//
+// The stream is fed by one broadcaster thread that polls the published
+// PuttStats snapshots, serialises each event once and fans it out to every
+// subscriber; a reconnecting client resumes with Last-Event-ID.
 // ─────────────────────────────────────────────────────────────────────────────
 
+#include "frame_governor.h"
+#include "latency_metrics.h"
 #include "putt_stats.h"
+#include "unreal_sender.h"
+#include "video_stream.h"
 
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <vector>
+
+namespace httplib {
+class Server;
+}
 
 namespace golf {
 
+class EnginePool;
+class RuntimeConfig;
+struct EventCounters;
+
 class StatsApi {
 public:
     explicit StatsApi(PuttStats& stats, uint16_t port = 8080);
+
+    /// One PuttStats per bay / video source (index == bay number).
+    explicit StatsApi(std::vector<PuttStats*> bays, uint16_t port = 8080);
     ~StatsApi();
 
     StatsApi(const StatsApi&) = delete;
     StatsApi& operator=(const StatsApi&) = delete;
 
+    /// Serve these latency histograms on /api/metrics (call before start()).
+    void set_metrics(const LatencyMetrics* metrics) { metrics_ = metrics; }
+
+    /// Also report these UDP counters on /api/metrics (call before start()).
+    void set_traffic(const SendCounters* traffic) { traffic_ = traffic; }
+
+    /// Also report the TCP event channel counters (call before start()).
+    void set_events(const EventCounters* events) { channel_ = events; }
+
+    /// Also report per-bay inference mode and rate (call before start()).
+    void set_governor(const FrameGovernor* governor) { governor_ = governor; }
+
+    /// Report batches / frames / GPU time per inference context on
+    /// /api/metrics (call before start()).
+    void set_engines(const EnginePool* engines) { engines_ = engines; }
+
+    /// Serve and update these parameters on /api/config (call before start()).
+    /// @param token  without one, POST is only accepted from loopback
+    ///               clients; with one, from any client that sends
+    ///               "Authorization: Bearer <token>"
+    void set_config(RuntimeConfig* config, const std::string& token = "") {
+        config_ = config;
+        config_token_ = token;
+    }
+
+    /// Serve the annotated MJPEG stream on /api/video (call before start()).
+    void set_video(VideoStream* video) { video_ = video; }
+
+    /// Max rate of "update" events per bay on /api/stats/stream (state
+    /// transitions are always pushed immediately).  Call before start().
+    void set_stream_rate(double hz) { stream_hz_ = hz; }
+
     void start();
     void stop();
 
 private:
-    PuttStats& stats_;
+    /// Serialised history of one bay, extended as putts finish.
+    struct HistoryCache {
+        std::mutex mutex;
+        std::string json;             // "{…},{…},"
+        std::vector<size_t> ends;     // end offset of each putt's entry
+    };
+
+    /// Serialise any newly finished putts (cache mutex held); returns the
+    /// number of cached putts.
+    size_t sync_history(int bay);
+
+    /// One serialised SSE frame shared by all subscribers.
+    struct StreamEvent {
+        uint64_t id;
+        int bay;
+        std::shared_ptr<const std::string> frame;
+    };
+
+    void stream_loop();
+    void publish(int bay, const char* type, const PuttData& data);
+
+    std::vector<PuttStats*> bays_;
+    std::vector<std::unique_ptr<HistoryCache>> caches_;
+    std::string instance_;            // ETag prefix unique to this process
+    const LatencyMetrics* metrics_ = nullptr;
+    const SendCounters* traffic_ = nullptr;
+    const EventCounters* channel_ = nullptr;
+    const FrameGovernor* governor_ = nullptr;
+    const EnginePool* engines_ = nullptr;
+    VideoStream* video_ = nullptr;
+    RuntimeConfig* config_ = nullptr;
+    std::string config_token_;
+    std::atomic<int> viewers_{0};
     uint16_t port_;
     std::thread thread_;
     std::atomic<bool> running_{false};
 
+    std::unique_ptr<httplib::Server> server_;
+    std::atomic<bool> serving_{false};    // run() has not returned yet
+
+    double stream_hz_ = 10.0;
+    std::thread stream_thread_;
+    std::mutex stream_mutex_;
+    std::condition_variable stream_cv_;
+    std::deque<StreamEvent> events_;      // recent events, oldest first
+    uint64_t next_event_id_ = 1;
+    std::atomic<int> subscribers_{0};
+
     void run();
 };
 
@@ -2,20 +2,40 @@
 // ─────────────────────────────────────────────────────────────────────────────
 // tracker.h  –  Simple Ball & Putter Tracker
 //
-// Uses a lightweight exponential-moving-average (EMA) tracker to smooth
-// positions and estimate velocity.  No external tracking library needed.
+// Two selectable motion models, same TrackedObject output:
+//   ema     exponential moving average on position, velocity from the
+//           smoothed positions (lightweight, lags at putt launch)
+//   kalman  constant-velocity Kalman filter per object (KalmanTracker),
+//           velocity estimated jointly with position
+// No external tracking library needed.
 // ─────────────────────────────────────────────────────────────────────────────
 
 #include "frame_pipeline.h"
+#include "kalman_tracker.h"
 
 #include <chrono>
+#include <cstdint>
 #include <optional>
+#include <string>
 #include <vector>
 
 namespace golf {
 
+enum class TrackerModel { EMA, KALMAN };
+
+/// Parse "ema" / "kalman".  Returns false if unknown.
+bool parse_tracker_model(const std::string& name, TrackerModel& model);
+
+struct TrackerOptions {
+    TrackerModel  model = TrackerModel::EMA;
+    float         alpha = 0.6f;        // EMA smoothing factor
+    int           max_lost = 15;       // frames before a track is lost
+    KalmanOptions kalman;
+};
+
 /// Smoothed state for a tracked object.
 struct TrackedObject {
+    uint32_t id = 0;                 // stable track id (MultiTracker; 0 = single)
     int class_id = -1;
     float x = 0.f, y = 0.f;          // smoothed center position (px)
     float vx = 0.f, vy = 0.f;        // estimated velocity (px / s)
@@ -31,9 +51,20 @@ public:
     /// @param max_lost    frames before a track is considered lost
     explicit Tracker(float alpha = 0.6f, int max_lost = 15);
 
+    explicit Tracker(const TrackerOptions& opts);
+
+    /// Retune a running tracker.  Tracks carry on, except across a change
+    /// of motion model (they restart at the next detection).
+    void set_options(const TrackerOptions& opts);
+
     /// Feed new detections from the current frame.
     void update(const std::vector<Detection>& detections, double dt_seconds);
 
+    /// Feed detections already reduced to the best one per class
+    /// (e.g. by the GPU decoder); std::nullopt = not seen this frame.
+    void update(const std::optional<Detection>& ball,
+                const std::optional<Detection>& putter, double dt_seconds);
+
     /// Retrieve the current ball state (class_id == 0).
     const TrackedObject& ball() const { return ball_; }
 
@@ -47,13 +78,20 @@ public:
     bool putter_visible() const { return putter_.valid; }
 
 private:
-    void update_track(TrackedObject& track, const Detection* det, double dt);
+    void update_track(TrackedObject& track, KalmanTracker& kf,
+                      const Detection* det, double dt);
+    void update_ema(TrackedObject& track, const Detection* det, double dt);
+    void update_kalman(TrackedObject& track, KalmanTracker& kf,
+                       const Detection* det, double dt);
 
+    TrackerModel model_ = TrackerModel::EMA;
     float alpha_;
     int max_lost_;
 
     TrackedObject ball_;
     TrackedObject putter_;
+    KalmanTracker ball_kf_;
+    KalmanTracker putter_kf_;
 };
 
 }  // namespace golf
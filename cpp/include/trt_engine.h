@@ -3,6 +3,8 @@
 // trt_engine.h  –  TensorRT Engine Loader & Inference Wrapper
 // ─────────────────────────────────────────────────────────────────────────────
 
+#include "engine_builder.h"
+
 #include <NvInfer.h>
 #include <cuda_runtime_api.h>
 
@@ -26,48 +28,232 @@ public:
     void log(Severity severity, const char* msg) noexcept override;
 };
 
+/// Device work enqueued on an inference slot's stream ahead of enqueueV3
+/// (e.g. GPU pre-processing).  In CUDA-graph mode it is captured into the
+/// graph, so it may only reference buffers whose addresses stay fixed.
+class InputStage {
+public:
+    virtual ~InputStage() = default;
+    virtual bool enqueue(cudaStream_t stream) = 0;
+
+    /// Changes whenever launch geometry or buffer addresses change; a
+    /// captured graph is replayed only for the value it was captured with
+    /// (a value may recur – TrtEngine keeps a few graphs per slot).
+    virtual uint64_t generation() const = 0;
+};
+
+/// Device work enqueued after enqueueV3 that consumes the output binding
+/// on the GPU (e.g. detection decoding).  When an output stage is given the
+/// raw output tensor is not copied back – the stage does its own (smaller)
+/// D2H transfer.  Same graph rules as InputStage.
+class OutputStage {
+public:
+    virtual ~OutputStage() = default;
+
+    /// @param d_output       device output binding
+    /// @param images         images in this call
+    /// @param output_length  floats per image in d_output
+    virtual bool enqueue(const float* d_output, int images, int output_length,
+                         cudaStream_t stream) = 0;
+
+    virtual uint64_t generation() const = 0;
+};
+
+/// GPU time of the phases of one inference call, from CUDA events.
+/// Phases not measured are negative (in CUDA-graph mode only total_ms).
+struct GpuTimings {
+    float stage_ms  = -1.f;   // input stage (GPU pre-processing)
+    float h2d_ms    = -1.f;   // input upload
+    float infer_ms  = -1.f;   // enqueueV3
+    float output_ms = -1.f;   // D2H or output stage
+    float total_ms  = -1.f;
+};
+
 // ─── TensorRT Engine ────────────────────────────────────────────────────────
+// Inference is double-buffered: each slot owns an execution context, a CUDA
+// stream, device I/O buffers and pinned host staging, so frame N+1 can be
+// uploaded while frame N is still executing in the other slot.  More slots
+// (up to kMaxSlots) can be asked for at load time.
+//
+// An engine lives on one CUDA device.  Its calls make that device current
+// on the calling thread, so one thread may drive engines on several GPUs
+// (see EnginePool).
+//
+// Inputs may be batched (several cameras per enqueue).  Engines built with a
+// dynamic batch dimension get their shape set per call from optimization
+// profile 0; static-batch engines always run their full batch.
+//
+// Per batch size the launch sequence is fixed, so with CUDA graphs enabled
+// each slot captures its [input stage →] H2D → enqueueV3 → D2H (or output
+// stage) sequence once and replays it.  A slot keeps up to kMaxGraphs of
+// them (least recently used evicted), so alternating input geometries –
+// ROI crops and full frames – and batch sizes each replay their own graph.
 class TrtEngine {
 public:
+    static constexpr int kNumSlots = 2;       // default
+    static constexpr int kMaxSlots = 8;
+
     TrtEngine() = default;
     ~TrtEngine();
 
     TrtEngine(const TrtEngine&) = delete;
     TrtEngine& operator=(const TrtEngine&) = delete;
 
-    /// Load a serialized TensorRT engine from disk.
-    bool load(const std::string& engine_path);
+    /// Load a serialized TensorRT engine from disk (memory-mapped).  An
+    /// .onnx path is built with `build` on first use and loaded from the
+    /// engine cache afterwards (see engine_builder.h).
+    /// @param device  CUDA device to run on (-1 = the current one)
+    /// @param slots   inference slots (execution contexts), 1 .. kMaxSlots
+    bool load(const std::string& model_path, const BuildOptions& build = {},
+              int device = -1, int slots = kNumSlots);
+
+    /// Make the engine's device current on the calling thread (before
+    /// staging device work for one of its slots).
+    bool activate() const;
 
     /// Run inference on pre-processed input (NCHW, float32, 0-1).
+    /// Synchronous single-image wrapper around infer_async(0) + wait(0).
     /// @param input_data   pointer to host input (1×3×H×W floats)
     /// @param output_data  resized by the call to hold raw network output
     /// @return true on success
     bool infer(const float* input_data, std::vector<float>& output_data);
 
+    /// Enqueue H2D → enqueueV3 → D2H on the slot's stream and return
+    /// immediately.  The slot must not be in flight.
+    /// @param slot        0 .. kNumSlots-1
+    /// @param input_data  host input; copied into the slot's pinned staging
+    ///                    unless it already points there.  Pass nullptr when
+    ///                    `stage` (or earlier work on stream(slot)) fills
+    ///                    input_buffer(slot).
+    /// @param stage       optional device work run first on the stream
+    /// @param batch       images in this call (1 .. max_batch())
+    /// @param output      optional device work that replaces the output D2H
+    bool infer_async(int slot, const float* input_data,
+                     InputStage* stage = nullptr, int batch = 1,
+                     OutputStage* output = nullptr);
+
+    /// Whether the slot's inference has completed (or failed), so wait()
+    /// would not block.  False for a slot with nothing in flight.
+    bool ready(int slot) const;
+
+    /// Block until the slot's inference completes.
+    /// @return pinned host pointer to batch × output_length() floats
+    ///         (image k at k × output_length()), or nullptr on failure.
+    ///         Valid until the slot is enqueued again.  Not filled when the
+    ///         call had an OutputStage – read its results instead.
+    const float* wait(int slot);
+
+    /// Capture each slot's steady-state launch sequence into a CUDA graph
+    /// and replay it.  Falls back to normal launches if capture fails.
+    void enable_cuda_graph(bool enable) { use_graph_ = enable; }
+    bool cuda_graph_active() const { return use_graph_; }
+
+    /// Record CUDA events between the phases of every call.
+    void enable_timing(bool enable) { timing_ = enable; }
+
+    /// GPU timings of the slot's last call; valid after wait() succeeded.
+    bool timings(int slot, GpuTimings& out) const;
+
+    /// Device pointer to one image of the slot's input binding
+    /// (input_c × H × W floats).
+    float* input_buffer(int slot = 0, int image = 0) const {
+        return static_cast<float*>(slots_[slot].d_input) + image * input_volume();
+    }
+
+    /// Pinned host staging for the slot's input – pre-process into this to
+    /// skip the copy in infer_async().
+    float* host_input(int slot, int image = 0) const {
+        return slots_[slot].h_input + image * input_volume();
+    }
+
+    /// Stream the slot's work is enqueued on.
+    cudaStream_t stream(int slot) const { return slots_[slot].stream; }
+
+    int device() const { return device_; }
+    int num_slots() const { return num_slots_; }
+
+    /// Largest batch a single infer_async() accepts.
+    int max_batch() const { return max_batch_; }
+    bool dynamic_batch() const { return dynamic_batch_; }
+
+    /// Floats per image in the input / output tensors.
+    int input_volume() const { return input_c_ * input_h_ * input_w_; }
+    int output_length() const { return output_length_; }
     int input_h() const { return input_h_; }
     int input_w() const { return input_w_; }
     int input_c() const { return input_c_; }
 
 private:
+    static constexpr int kMaxGraphs = 4;   // per slot
+
+    /// One captured launch sequence and what it was captured for.
+    struct Graph {
+        cudaGraphExec_t exec = nullptr;
+        int      batch = 0;
+        bool     uploads = false;        // includes the H2D copy
+        const InputStage* stage = nullptr;
+        uint64_t generation = 0;
+        const OutputStage* output = nullptr;
+        uint64_t output_generation = 0;
+        uint64_t last_used = 0;
+    };
+
+    struct Slot {
+        std::unique_ptr<nvinfer1::IExecutionContext, TrtDeleter> context;
+        cudaStream_t stream = nullptr;
+        cudaEvent_t  done = nullptr;
+        void*  d_input  = nullptr;
+        void*  d_output = nullptr;
+        float* h_input  = nullptr;    // pinned
+        float* h_output = nullptr;    // pinned
+        bool   in_flight = false;
+        cudaEvent_t marks[5] = {};    // timing: start, stage, h2d, infer, out
+        int    timed = 0;             // 0 off, 1 total only, 2 every phase
+        bool   warmed_up = false;     // has run outside a graph at `batch`
+        int    batch = 0;             // shape currently set on the context
+        int    images = 1;            // images copied in the current call
+
+        Graph    graphs[kMaxGraphs];
+        uint64_t graph_uses = 0;         // LRU clock
+    };
+
+    bool deserialize(const std::string& engine_path);
     bool allocate_buffers();
+    bool allocate_slot(Slot& slot);
     void release_buffers();
 
+    bool set_batch(Slot& slot, int batch);
+    bool enqueue_work(Slot& slot, bool upload, InputStage* stage,
+                      OutputStage* output, bool mark = false);
+    Graph* find_graph(Slot& slot, int batch, bool upload, const InputStage* stage,
+                      const OutputStage* output);
+    Graph* capture_graph(Slot& slot, bool upload, InputStage* stage,
+                         OutputStage* output);
+    void destroy_graphs(Slot& slot);
+
     TrtLogger logger_;
     std::unique_ptr<nvinfer1::IRuntime, TrtDeleter> runtime_;
     std::unique_ptr<nvinfer1::ICudaEngine, TrtDeleter> engine_;
-    std::unique_ptr<nvinfer1::IExecutionContext, TrtDeleter> context_;
 
-    // GPU buffer pointers (index 0 = input, 1 = output)
-    void* gpu_buffers_[2]{nullptr, nullptr};
-    size_t input_size_bytes_ = 0;
-    size_t output_size_bytes_ = 0;
-    int output_length_ = 0;
+    Slot slots_[kMaxSlots];
+    int num_slots_ = kNumSlots;
+    int device_ = 0;
+    const char* input_name_ = nullptr;
+    const char* output_name_ = nullptr;
+    nvinfer1::Dims input_dims_{};
+    size_t input_image_bytes_ = 0;    // one image
+    size_t output_image_bytes_ = 0;
+    int output_length_ = 0;           // floats per image
+    int max_batch_ = 1;
+    bool dynamic_batch_ = false;
 
     int input_c_ = 3;
     int input_h_ = 640;
     int input_w_ = 640;
 
     bool loaded_ = false;
+    bool use_graph_ = false;
+    bool timing_ = false;
 };
 
 }  // namespace golf
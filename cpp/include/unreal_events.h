@@ -0,0 +1,138 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// unreal_events.h  –  Reliable Putt Event Channel for Unreal Engine (TCP)
+//
+// The per-frame UDP stream (unreal_sender.h) is fire-and-forget: a lost
+// datagram at the moment a putt finishes costs the game its result.  This
+// channel carries the few messages that must arrive – putt started, putt
+// stopped, finished putt with its whole ball path – over TCP, in the
+// length-prefixed binary format of unreal_protocol.h:
+//
+//   on connect   HELLO with the last finished putt of every bay
+//   live         PUTT_START / PUTT_STOP / PUTT_RESULT as they happen
+//   on SYNC      the history of one bay after a putt number (kReplay),
+//                then SYNC_DONE – a reconnecting client asks for exactly
+//                what it missed
+//
+// One thread polls the seqlock-published PuttStats snapshots and the
+// history logs (never touching the tracking thread), encodes each event
+// once and queues it to every client; sockets are non-blocking and served
+// with poll().  A SYNC reply is queued a few results at a time as the
+// client drains it (live events keep flowing meanwhile), and a client that
+// stops reading is dropped once its backlog exceeds kMaxBacklog – it
+// resyncs when it comes back.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "putt_stats.h"
+#include "unreal_protocol.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace golf {
+
+/// Channel counters (updated by the channel thread, readable from any).
+struct EventCounters {
+    std::atomic<uint64_t> clients{0};      // connected now
+    std::atomic<uint64_t> connections{0};  // accepted since start
+    std::atomic<uint64_t> events{0};       // live events published
+    std::atomic<uint64_t> replayed{0};     // results sent for SYNC requests
+    std::atomic<uint64_t> bytes{0};        // bytes written to clients
+    std::atomic<uint64_t> dropped{0};      // clients dropped for backlog
+
+    /// {"clients":…, "connections":…, …}
+    std::string to_json() const;
+
+    /// Prometheus metrics (golf_events_*).
+    std::string to_prometheus() const;
+};
+
+class UnrealEventChannel {
+public:
+    /// One PuttStats per bay / video source (index == bay number).
+    explicit UnrealEventChannel(std::vector<PuttStats*> bays);
+    ~UnrealEventChannel();
+
+    UnrealEventChannel(const UnrealEventChannel&) = delete;
+    UnrealEventChannel& operator=(const UnrealEventChannel&) = delete;
+
+    /// Listen on `port` and start the channel thread.
+    /// @param host  local address to bind (default: all interfaces)
+    bool start(uint16_t port, const std::string& host = "0.0.0.0");
+
+    /// Close every connection and join the thread.
+    void stop();
+
+    const EventCounters& counters() const { return counters_; }
+
+private:
+    static constexpr auto kPoll = std::chrono::milliseconds(5);
+    static constexpr size_t kMaxBacklog = 8u << 20;   // bytes queued per client
+    static constexpr size_t kSyncWindow = 256u << 10; // backlog refilled by SYNC
+    static constexpr size_t kMaxRequest = 4096;       // unparsed client bytes
+    static constexpr size_t kMaxPendingSyncs = 64;
+
+    using Message = std::shared_ptr<const std::string>;
+
+    struct Sync {
+        uint16_t bay = 0;
+        int32_t since = 0;
+    };
+
+    struct Client {
+        int fd = -1;
+        bool dead = false;               // closed at the end of this round
+        std::deque<Message> out;
+        size_t offset = 0;               // into out.front()
+        size_t backlog = 0;              // bytes queued
+        std::string in;                  // partial request
+
+        // SYNC in progress: history records [sync_next, sync_end) of sync_bay
+        std::deque<Sync> pending;
+        int sync_bay = -1;
+        size_t sync_next = 0, sync_end = 0;
+        int32_t sync_last = 0;
+    };
+
+    /// What was last published for one bay.
+    struct BayState {
+        bool valid = false;
+        PuttState state = PuttState::IDLE;
+        int putt_number = 0;
+        size_t results = 0;              // history records published
+        uint32_t sequence = 0;
+    };
+
+    void run();
+    void poll_bays();
+    void accept_clients();
+    bool read_client(Client& c);
+    bool write_client(Client& c);
+    void refill_sync(Client& c);
+
+    void broadcast(Message msg);
+    void send_to(Client& c, Message msg);
+
+    Message putt_event(uint16_t bay, wire::PacketType type, uint32_t sequence,
+                       uint16_t flags, const PuttData& putt) const;
+    Message putt_result(uint16_t bay, uint32_t sequence, uint16_t flags,
+                        const PuttData& putt) const;
+    Message hello() const;
+
+    std::vector<PuttStats*> bays_;
+    std::vector<BayState> state_;
+    std::vector<std::unique_ptr<Client>> clients_;   // channel thread only
+    int listen_fd_ = -1;
+
+    EventCounters counters_;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+}  // namespace golf
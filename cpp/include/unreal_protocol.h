@@ -0,0 +1,502 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// unreal_protocol.h  –  Binary Wire Format for the Unreal Engine Link
+//
+// Self-contained (only <cstdint> / <cstring>) so the same file can be
+// dropped into the UE plugin and used to decode what UnrealSender encodes.
+//
+// Every datagram is one fixed-size, little-endian packet:
+//
+//   offset  size  field
+//   ──────  ────  ─────────────────────────────────────────────
+//        0     4  magic            'G','O','L','F'
+//        4     2  version          kVersion
+//        6     2  type             PacketType
+//        8     4  sequence         per stream, +1 per packet
+//       12     2  stream_id        bay / video source index
+//       14     2  flags            kBallVisible | kPutterVisible | kKeyframe
+//                                  | kPredicted
+//       16     8  capture_time_us  steady clock, time the state describes
+//                                  (frame capture, or the extrapolation
+//                                  target of a predicted packet)
+//       24     8  send_time_us     steady clock, when the packet was built
+//       32    20  ball             x, y, vx, vy, confidence   (float32)
+//       52    20  putter           x, y, vx, vy, confidence   (float32)
+//       72    48  stats            putt_number (int32), state (uint8),
+//                                  3 pad bytes, 10 × float32
+//   ──────  ────
+//            120
+//
+// With the event channel enabled (see below) the per-frame datagram drops
+// the stats block and travels as a packed KINEMATICS packet of 58 bytes
+// (52 % less than STATE): no send_time_us, confidences as 0-255.
+//
+//   offset  size  field
+//   ──────  ────  ─────────────────────────────────────────────
+//        0    16  magic … flags    as above, type = KINEMATICS
+//       16     8  capture_time_us
+//       24    16  ball             x, y, vx, vy               (float32)
+//       40    16  putter           x, y, vx, vy               (float32)
+//       56     1  ball confidence  × 255, rounded             (uint8)
+//       57     1  putter confidence
+//   ──────  ────
+//             58
+//
+// Fields are written one by one with explicit byte order, so the layout
+// does not depend on compiler packing or host endianness.  New fields are
+// only ever appended; decoders accept newer versions as long as the packet
+// is at least as long as the layout they know.
+//
+// Event channel (TCP, golf_sim --event-port): a reliable, low-rate stream
+// of putt lifecycle messages, each a u32 length (bytes that follow), the
+// 32-byte header above and a body:
+//
+//   type          dir  body
+//   ───────────   ───  ──────────────────────────────────────────────
+//   HELLO         S→C  u16 bays, u16 pad, bays × i32 last finished putt
+//   PUTT_START    S→C  stats block (48)         ball started moving
+//   PUTT_STOP     S→C  stats block (48)         ball came to rest
+//   PUTT_RESULT   S→C  stats block (48), u32 ball_id, u32 samples,
+//                      samples × 6 float32 (t, x, y, vx, vy, confidence)
+//   SYNC          C→S  i32 since                results of bay stream_id
+//                                               after putt `since`
+//   SYNC_DONE     S→C  i32 last                 end of a SYNC reply
+//
+// HELLO is sent on connect; a client that missed putts (first connect, or
+// a reconnect) SYNCs the bays it cares about, and replayed results carry
+// kReplay.  Live events are numbered per bay in `sequence`.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <cstdint>
+#include <cstring>
+
+namespace golf {
+namespace wire {
+
+constexpr uint32_t kMagic   = 0x464C4F47;   // "GOLF" read as little-endian
+constexpr uint16_t kVersion = 1;
+
+enum class PacketType : uint16_t {
+    STATE       = 1,
+    KINEMATICS  = 2,
+    // Event channel
+    HELLO       = 16,
+    PUTT_START  = 17,
+    PUTT_STOP   = 18,
+    PUTT_RESULT = 19,
+    SYNC        = 20,
+    SYNC_DONE   = 21,
+};
+
+enum Flags : uint16_t {
+    kBallVisible   = 1u << 0,
+    kPutterVisible = 1u << 1,
+    kKeyframe      = 1u << 2,   // periodic resend of an unchanged state
+    kPredicted     = 1u << 3,   // extrapolated between frames, not measured
+    kReplay        = 1u << 4,   // event channel: history sent for a SYNC
+};
+
+/// Putt state as sent on the wire (matches golf::PuttState).
+enum class PuttPhase : uint8_t { IDLE = 0, IN_MOTION = 1, STOPPED = 2 };
+
+struct ObjectState {
+    float x = 0.f, y = 0.f;
+    float vx = 0.f, vy = 0.f;
+    float confidence = 0.f;
+};
+
+struct PuttState {
+    int32_t   putt_number    = 0;
+    PuttPhase phase          = PuttPhase::IDLE;
+    float     launch_speed   = 0.f;
+    float     current_speed  = 0.f;
+    float     peak_speed     = 0.f;
+    float     total_distance = 0.f;
+    float     break_distance = 0.f;
+    float     time_in_motion = 0.f;
+    float     start_x = 0.f, start_y = 0.f;
+    float     final_x = 0.f, final_y = 0.f;
+};
+
+struct StatePacket {
+    PacketType  type            = PacketType::STATE;   // or KINEMATICS (no stats)
+    uint16_t    version         = kVersion;
+    uint32_t    sequence        = 0;
+    uint16_t    stream_id       = 0;
+    uint16_t    flags           = 0;
+    uint64_t    capture_time_us = 0;
+    uint64_t    send_time_us    = 0;      // not sent in KINEMATICS (0)
+    ObjectState ball;
+    ObjectState putter;
+    PuttState   stats;
+
+    bool ball_visible() const { return (flags & kBallVisible) != 0; }
+    bool putter_visible() const { return (flags & kPutterVisible) != 0; }
+    bool keyframe() const { return (flags & kKeyframe) != 0; }
+    bool predicted() const { return (flags & kPredicted) != 0; }
+};
+
+constexpr size_t kHeaderSize      = 32;
+constexpr size_t kKinematicsSize  = 58;
+constexpr size_t kStatePacketSize = 120;
+constexpr size_t kPuttStateSize   = 48;
+
+// ─── Byte Order ─────────────────────────────────────────────────────────────
+namespace detail {
+
+inline void put_u16(uint8_t*& p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    p += 2;
+}
+
+inline void put_u32(uint8_t*& p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+    p += 4;
+}
+
+inline void put_u64(uint8_t*& p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+    p += 8;
+}
+
+inline void put_f32(uint8_t*& p, float f) {
+    uint32_t v;
+    std::memcpy(&v, &f, sizeof(v));
+    put_u32(p, v);
+}
+
+inline uint16_t get_u16(const uint8_t*& p) {
+    const uint16_t v = static_cast<uint16_t>(p[0] | (p[1] << 8));
+    p += 2;
+    return v;
+}
+
+inline uint32_t get_u32(const uint8_t*& p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= static_cast<uint32_t>(p[i]) << (8 * i);
+    p += 4;
+    return v;
+}
+
+inline uint64_t get_u64(const uint8_t*& p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= static_cast<uint64_t>(p[i]) << (8 * i);
+    p += 8;
+    return v;
+}
+
+inline float get_f32(const uint8_t*& p) {
+    const uint32_t v = get_u32(p);
+    float f;
+    std::memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+inline void put_object(uint8_t*& p, const ObjectState& o) {
+    put_f32(p, o.x);
+    put_f32(p, o.y);
+    put_f32(p, o.vx);
+    put_f32(p, o.vy);
+    put_f32(p, o.confidence);
+}
+
+inline ObjectState get_object(const uint8_t*& p) {
+    ObjectState o;
+    o.x = get_f32(p);
+    o.y = get_f32(p);
+    o.vx = get_f32(p);
+    o.vy = get_f32(p);
+    o.confidence = get_f32(p);
+    return o;
+}
+
+inline void put_putt(uint8_t*& p, const PuttState& s) {
+    put_u32(p, static_cast<uint32_t>(s.putt_number));
+    *p++ = static_cast<uint8_t>(s.phase);
+    *p++ = 0;
+    *p++ = 0;
+    *p++ = 0;
+    const float tail[] = {s.launch_speed, s.current_speed, s.peak_speed,
+                          s.total_distance, s.break_distance, s.time_in_motion,
+                          s.start_x, s.start_y, s.final_x, s.final_y};
+    for (float f : tail) put_f32(p, f);
+}
+
+// KINEMATICS: the motion, then both confidences as one byte each
+inline void put_kinematics(uint8_t*& p, const ObjectState& ball, const ObjectState& putter) {
+    const ObjectState* objects[] = {&ball, &putter};
+    for (const ObjectState* o : objects) {
+        put_f32(p, o->x);
+        put_f32(p, o->y);
+        put_f32(p, o->vx);
+        put_f32(p, o->vy);
+    }
+    for (const ObjectState* o : objects) {
+        const float c = o->confidence < 0.f ? 0.f : o->confidence > 1.f ? 1.f : o->confidence;
+        *p++ = static_cast<uint8_t>(c * 255.f + 0.5f);
+    }
+}
+
+inline void get_kinematics(const uint8_t*& p, ObjectState& ball, ObjectState& putter) {
+    ObjectState* objects[] = {&ball, &putter};
+    for (ObjectState* o : objects) {
+        o->x = get_f32(p);
+        o->y = get_f32(p);
+        o->vx = get_f32(p);
+        o->vy = get_f32(p);
+    }
+    for (ObjectState* o : objects) o->confidence = *p++ / 255.f;
+}
+
+inline PuttState get_putt(const uint8_t*& p) {
+    PuttState s;
+    s.putt_number = static_cast<int32_t>(get_u32(p));
+    s.phase = static_cast<PuttPhase>(*p);
+    p += 4;
+    float* tail[] = {&s.launch_speed, &s.current_speed, &s.peak_speed,
+                     &s.total_distance, &s.break_distance, &s.time_in_motion,
+                     &s.start_x, &s.start_y, &s.final_x, &s.final_y};
+    for (float* f : tail) *f = get_f32(p);
+    return s;
+}
+
+}  // namespace detail
+
+// ─── Encode / Decode ────────────────────────────────────────────────────────
+/// Serialise a state packet (or, with type KINEMATICS, the packed layout).
+/// @param buf   destination, at least kStatePacketSize bytes
+/// @return      bytes written (kStatePacketSize / kKinematicsSize), or 0 if
+///              `cap` is too small
+inline size_t encode(const StatePacket& pkt, uint8_t* buf, size_t cap) {
+    const bool kinematics = pkt.type == PacketType::KINEMATICS;
+    if (cap < (kinematics ? kKinematicsSize : kStatePacketSize)) return 0;
+    uint8_t* p = buf;
+    detail::put_u32(p, kMagic);
+    detail::put_u16(p, kVersion);
+    detail::put_u16(p, static_cast<uint16_t>(kinematics ? PacketType::KINEMATICS
+                                                        : PacketType::STATE));
+    detail::put_u32(p, pkt.sequence);
+    detail::put_u16(p, pkt.stream_id);
+    detail::put_u16(p, pkt.flags);
+    detail::put_u64(p, pkt.capture_time_us);
+    if (kinematics) {
+        detail::put_kinematics(p, pkt.ball, pkt.putter);
+        return static_cast<size_t>(p - buf);
+    }
+    detail::put_u64(p, pkt.send_time_us);
+    detail::put_object(p, pkt.ball);
+    detail::put_object(p, pkt.putter);
+    detail::put_putt(p, pkt.stats);
+    return static_cast<size_t>(p - buf);
+}
+
+/// Parse a datagram (STATE or KINEMATICS; the latter leaves send_time_us
+/// at 0 and `stats` at its defaults).  Rejects foreign traffic (bad
+/// magic), other packet types and truncated packets; trailing bytes from
+/// newer versions are ignored.
+/// @return  true if `out` was filled
+inline bool decode(const void* data, size_t len, StatePacket& out) {
+    if (len < kKinematicsSize) return false;
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    if (detail::get_u32(p) != kMagic) return false;
+    out.version = detail::get_u16(p);
+    if (out.version < 1) return false;
+    const uint16_t type = detail::get_u16(p);
+    if (type == static_cast<uint16_t>(PacketType::STATE)) {
+        if (len < kStatePacketSize) return false;
+    } else if (type != static_cast<uint16_t>(PacketType::KINEMATICS)) {
+        return false;
+    }
+    out.type = static_cast<PacketType>(type);
+    out.sequence = detail::get_u32(p);
+    out.stream_id = detail::get_u16(p);
+    out.flags = detail::get_u16(p);
+    out.capture_time_us = detail::get_u64(p);
+    if (out.type == PacketType::KINEMATICS) {
+        out.send_time_us = 0;
+        detail::get_kinematics(p, out.ball, out.putter);
+        out.stats = PuttState();
+        return true;
+    }
+    out.send_time_us = detail::get_u64(p);
+    out.ball = detail::get_object(p);
+    out.putter = detail::get_object(p);
+    out.stats = detail::get_putt(p);
+    return true;
+}
+
+// ─── Event Channel ──────────────────────────────────────────────────────────
+struct EventHeader {
+    PacketType type            = PacketType::HELLO;
+    uint16_t   version         = kVersion;
+    uint32_t   sequence        = 0;     // per bay, +1 per live event
+    uint16_t   stream_id       = 0;     // bay
+    uint16_t   flags           = 0;     // kReplay
+    uint64_t   capture_time_us = 0;     // when the event happened
+    uint64_t   send_time_us    = 0;
+};
+
+struct TrajectoryPoint {
+    float t = 0.f;                      // seconds since launch
+    float x = 0.f, y = 0.f;
+    float vx = 0.f, vy = 0.f;
+    float confidence = 0.f;
+};
+
+constexpr size_t   kTrajectoryPointSize = 24;
+constexpr uint32_t kMaxEventSize = 1u << 20;   // longer messages are rejected
+
+/// Bytes of a whole message (length prefix included) with a `body`-byte body.
+inline size_t event_size(size_t body) { return 4 + kHeaderSize + body; }
+
+namespace detail {
+
+inline uint8_t* put_event_header(uint8_t* p, const EventHeader& h, size_t body) {
+    put_u32(p, static_cast<uint32_t>(kHeaderSize + body));
+    put_u32(p, kMagic);
+    put_u16(p, kVersion);
+    put_u16(p, static_cast<uint16_t>(h.type));
+    put_u32(p, h.sequence);
+    put_u16(p, h.stream_id);
+    put_u16(p, h.flags);
+    put_u64(p, h.capture_time_us);
+    put_u64(p, h.send_time_us);
+    return p;
+}
+
+}  // namespace detail
+
+/// PUTT_START / PUTT_STOP.
+/// @return  bytes written (event_size(kPuttStateSize)), or 0 if `cap` is too small
+inline size_t encode_putt_event(const EventHeader& h, const PuttState& putt,
+                                uint8_t* buf, size_t cap) {
+    if (cap < event_size(kPuttStateSize)) return 0;
+    uint8_t* p = detail::put_event_header(buf, h, kPuttStateSize);
+    detail::put_putt(p, putt);
+    return static_cast<size_t>(p - buf);
+}
+
+/// PUTT_RESULT with the putt's ball path.
+inline size_t encode_putt_result(const EventHeader& h, const PuttState& putt,
+                                 uint32_t ball_id, const TrajectoryPoint* points,
+                                 uint32_t count, uint8_t* buf, size_t cap) {
+    const size_t body = kPuttStateSize + 8 + count * kTrajectoryPointSize;
+    if (cap < event_size(body)) return 0;
+    uint8_t* p = detail::put_event_header(buf, h, body);
+    detail::put_putt(p, putt);
+    detail::put_u32(p, ball_id);
+    detail::put_u32(p, count);
+    for (uint32_t i = 0; i < count; ++i) {
+        const TrajectoryPoint& s = points[i];
+        const float row[] = {s.t, s.x, s.y, s.vx, s.vy, s.confidence};
+        for (float f : row) detail::put_f32(p, f);
+    }
+    return static_cast<size_t>(p - buf);
+}
+
+/// HELLO: the last finished putt of each bay (0 = none yet).
+inline size_t encode_hello(const EventHeader& h, const int32_t* last_putts,
+                           uint16_t bays, uint8_t* buf, size_t cap) {
+    const size_t body = 4 + 4 * static_cast<size_t>(bays);
+    if (cap < event_size(body)) return 0;
+    uint8_t* p = detail::put_event_header(buf, h, body);
+    detail::put_u16(p, bays);
+    detail::put_u16(p, 0);
+    for (uint16_t i = 0; i < bays; ++i) detail::put_u32(p, static_cast<uint32_t>(last_putts[i]));
+    return static_cast<size_t>(p - buf);
+}
+
+/// SYNC (`value` = since) / SYNC_DONE (`value` = last putt sent).
+inline size_t encode_sync(const EventHeader& h, int32_t value, uint8_t* buf, size_t cap) {
+    if (cap < event_size(4)) return 0;
+    uint8_t* p = detail::put_event_header(buf, h, 4);
+    detail::put_u32(p, static_cast<uint32_t>(value));
+    return static_cast<size_t>(p - buf);
+}
+
+/// Split the next message off a received byte stream.
+/// @param body      set to the message body
+/// @param body_len  its length
+/// @return  bytes the message occupies (consume them), 0 if `data` does not
+///          hold a whole message yet, -1 if the stream is not this protocol
+inline long decode_event(const void* data, size_t len, EventHeader& h,
+                         const uint8_t*& body, size_t& body_len) {
+    if (len < 4) return 0;
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint32_t n = detail::get_u32(p);
+    if (n < kHeaderSize || n > kMaxEventSize) return -1;
+    if (len < 4 + static_cast<size_t>(n)) return 0;
+    if (detail::get_u32(p) != kMagic) return -1;
+    h.version = detail::get_u16(p);
+    h.type = static_cast<PacketType>(detail::get_u16(p));
+    h.sequence = detail::get_u32(p);
+    h.stream_id = detail::get_u16(p);
+    h.flags = detail::get_u16(p);
+    h.capture_time_us = detail::get_u64(p);
+    h.send_time_us = detail::get_u64(p);
+    body = p;
+    body_len = n - kHeaderSize;
+    return static_cast<long>(4 + n);
+}
+
+/// Body of PUTT_START / PUTT_STOP / PUTT_RESULT.  For a result, `points`
+/// is set to the first of `count` samples (read them with point()).
+inline bool decode_putt(const uint8_t* body, size_t len, PuttState& putt,
+                        uint32_t* ball_id = nullptr, uint32_t* count = nullptr,
+                        const uint8_t** points = nullptr) {
+    if (len < kPuttStateSize) return false;
+    const uint8_t* p = body;
+    putt = detail::get_putt(p);
+    if (!count) return true;
+    if (len < kPuttStateSize + 8) return false;
+    const uint32_t id = detail::get_u32(p);
+    const uint32_t n = detail::get_u32(p);
+    if (len < kPuttStateSize + 8 + static_cast<size_t>(n) * kTrajectoryPointSize) return false;
+    if (ball_id) *ball_id = id;
+    *count = n;
+    if (points) *points = p;
+    return true;
+}
+
+/// Sample i of a PUTT_RESULT's ball path.
+inline TrajectoryPoint point(const uint8_t* points, uint32_t i) {
+    const uint8_t* p = points + static_cast<size_t>(i) * kTrajectoryPointSize;
+    TrajectoryPoint s;
+    s.t = detail::get_f32(p);
+    s.x = detail::get_f32(p);
+    s.y = detail::get_f32(p);
+    s.vx = detail::get_f32(p);
+    s.vy = detail::get_f32(p);
+    s.confidence = detail::get_f32(p);
+    return s;
+}
+
+/// Body of SYNC / SYNC_DONE.
+inline bool decode_sync(const uint8_t* body, size_t len, int32_t& value) {
+    if (len < 4) return false;
+    const uint8_t* p = body;
+    value = static_cast<int32_t>(detail::get_u32(p));
+    return true;
+}
+
+/// Body of HELLO; read last finished putt i with get_u32 at last_putts + 4·i.
+inline bool decode_hello(const uint8_t* body, size_t len, uint16_t& bays,
+                         const uint8_t*& last_putts) {
+    if (len < 4) return false;
+    const uint8_t* p = body;
+    bays = detail::get_u16(p);
+    p += 2;
+    if (len < 4 + 4 * static_cast<size_t>(bays)) return false;
+    last_putts = p;
+    return true;
+}
+
+/// Sequence gap between two packets of one stream (handles wrap-around);
+/// 1 means no loss, 0 or a huge value means duplicate / reordered.
+inline uint32_t sequence_gap(uint32_t prev, uint32_t next) {
+    return next - prev;
+}
+
+}  // namespace wire
+}  // namespace golf
@@ -2,27 +2,91 @@
 // ─────────────────────────────────────────────────────────────────────────────
 // unreal_sender.h  –  Send Detection Results to Unreal Engine over UDP
 //
-// Protocol:  JSON datagrams sent to a configurable UDP endpoint.
+// One datagram per frame and video source, sent to a configurable UDP
+// endpoint in one of two encodings:
 //
-// Payload schema (one datagram per frame):
+//   BINARY  fixed-size little-endian packets: 120-byte STATE, or 58-byte
+//           KINEMATICS without stats; see unreal_protocol.h (header-only
+//           decoder shared with the UE plugin)
+//   JSON    human-readable, schema:
 // {
-//   "timestamp_ms": <uint64>,
+//   "timestamp_ms": <uint64>,        // steady clock, when the datagram was built
+//   "state_time_ms": <uint64>,       // steady clock, time the state describes:
+//                                    // capture, or capture + extrapolation
+//   "stream_id": <int>,              // bay / video source index
+//   "keyframe": <bool>,              // periodic resend of unchanged state
+//   "predicted": <bool>,             // extrapolated between frames
 //   "ball": { "x": <f>, "y": <f>, "vx": <f>, "vy": <f>, "conf": <f>, "visible": <bool> },
-//   "putter": { "x": <f>, "y": <f>, "vx": <f>, "vy": <f>, "conf": <f>, "visible": <bool> }
+//   "putter": { "x": <f>, "y": <f>, "vx": <f>, "vy": <f>, "conf": <f>, "visible": <bool> },
+//   "stats": { "putt_number": <int>, "state": <str>, "launch_speed": <f>, … }
 // }
+//
+// With an event channel running (unreal_events.h) the putt state reaches
+// the game reliably over TCP, and the per-frame datagram can leave it out
+// (SenderOptions::stats = false): JSON without "stats", binary KINEMATICS.
+//
+// Send policy (DELTA): every frame while a putt is IN_MOTION, immediately on
+// any state / visibility change, rate-limited while only the positions
+// drift, and otherwise a keyframe at a fixed interval so the receiver can
+// resync after loss.  Datagrams are queued per frame and flushed with one
+// sendmmsg() call, so all bays of a batch go out in a single syscall.
 // ─────────────────────────────────────────────────────────────────────────────
 
+#include "latency_metrics.h"
 #include "tracker.h"
 #include "putt_stats.h"
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace golf {
 
+enum class WireProtocol { JSON, BINARY };
+
+/// Parse "json" / "binary".
+bool parse_wire_protocol(const std::string& name, WireProtocol& out);
+
+/// Which frames produce a datagram.
+enum class SendPolicy {
+    EVERY_FRAME,   // one datagram per processed frame
+    DELTA,         // changes + IN_MOTION at full rate, keyframes otherwise
+};
+
+struct SenderOptions {
+    WireProtocol protocol = WireProtocol::JSON;
+    SendPolicy   policy   = SendPolicy::DELTA;
+    double idle_hz        = 10.0;    // max rate for position-only changes
+    double keyframe_s     = 1.0;     // unchanged state is re-sent this often
+    float  epsilon_px     = 1.0f;    // movement below this is "unchanged"
+    bool   stats          = true;    // include the putt stats block
+    double max_hold_s     = 0.001;   // queued datagrams leave at most this
+                                     // long after the oldest was queued
+};
+
+/// Traffic counters (updated by the sending thread, readable from any).
+struct SendCounters {
+    std::atomic<uint64_t> frames{0};       // states offered to queue()
+    std::atomic<uint64_t> datagrams{0};    // datagrams sent
+    std::atomic<uint64_t> keyframes{0};    // of which keyframes
+    std::atomic<uint64_t> predicted{0};    // of which predicted states
+    std::atomic<uint64_t> skipped{0};      // suppressed by the send policy
+    std::atomic<uint64_t> bytes{0};        // UDP payload bytes sent
+    std::atomic<uint64_t> syscalls{0};     // sendmmsg() calls
+    std::atomic<uint64_t> errors{0};       // datagrams that failed to send
+
+    /// {"frames":…, "datagrams":…, …}
+    std::string to_json() const;
+
+    /// Prometheus counters (golf_udp_*_total).
+    std::string to_prometheus() const;
+};
+
 class UnrealSender {
 public:
     UnrealSender() = default;
@@ -34,16 +98,95 @@ public:
     /// Initialise the UDP socket.
     /// @param host  destination IP (e.g. "127.0.0.1")
     /// @param port  destination port (e.g. 7001)
-    bool init(const std::string& host, uint16_t port);
+    /// @param opts  encoding and send policy
+    bool init(const std::string& host, uint16_t port,
+              const SenderOptions& opts = {});
 
-    /// Send the current tracker state + putt stats as a JSON datagram.
+    /// Record glass-to-UDP latency for every datagram sent (optional).
+    void set_metrics(LatencyMetrics* metrics) { metrics_ = metrics; }
+
+    /// Apply the send policy and, if the state is worth sending, queue one
+    /// datagram.  Queued datagrams leave on flush(), when the queue is
+    /// full, or once the oldest has waited SenderOptions::max_hold_s.
+    /// @param stream_id     bay / video source the state belongs to
+    /// @param capture_time  time the state describes – when the frame was
+    ///                      captured (default: now)
+    /// @param predicted     state was extrapolated, not measured (sent with
+    ///                      kPredicted; no glass-to-UDP sample)
+    /// @return false on encode / send failure (a skipped frame is success)
+    bool queue(const TrackedObject& ball, const TrackedObject& putter,
+               const PuttData& stats, int stream_id = 0,
+               std::chrono::steady_clock::time_point capture_time = {},
+               bool predicted = false);
+
+    /// Send everything queued with as few sendmmsg() calls as possible.
+    bool flush();
+
+    /// flush() if the oldest queued datagram has waited
+    /// SenderOptions::max_hold_s.  Call it from the sending loop between
+    /// states: queue() only checks the deadline when a state arrives.
+    bool poll();
+
+    /// queue() + flush().
     bool send(const TrackedObject& ball, const TrackedObject& putter,
-              const PuttData& stats);
+              const PuttData& stats, int stream_id = 0,
+              std::chrono::steady_clock::time_point capture_time = {});
+
+    /// Include the putt stats block from now on (SenderOptions::stats).
+    /// Sending thread only, or before it starts.
+    void set_stats(bool enable) { opts_.stats = enable; }
+
+    const SendCounters& counters() const { return counters_; }
 
     /// Close the socket.
     void close();
 
 private:
+    static constexpr int kMaxQueued = 16;
+    static constexpr size_t kMaxDatagram = 1024;
+
+    /// What was last sent on one stream.
+    struct StreamState {
+        bool has_sent = false;
+        uint32_t sequence = 0;
+        PuttState state = PuttState::IDLE;
+        int putt_number = 0;
+        bool ball_valid = false, putter_valid = false;
+        float ball_x = 0.f, ball_y = 0.f;
+        float putter_x = 0.f, putter_y = 0.f;
+        std::chrono::steady_clock::time_point sent_at;
+    };
+
+    enum class Decision { SKIP, SEND, KEYFRAME };
+
+    struct Datagram {
+        char data[kMaxDatagram];
+        int  length = 0;
+        bool predicted = false;
+        std::chrono::steady_clock::time_point capture_time;
+    };
+
+    Decision decide(const StreamState& st, const TrackedObject& ball,
+                    const TrackedObject& putter, const PuttData& stats,
+                    std::chrono::steady_clock::time_point now) const;
+
+    bool hold_expired(std::chrono::steady_clock::time_point now) const;
+    int encode_json(char* buf, size_t cap, const TrackedObject& ball,
+                    const TrackedObject& putter, const PuttData& stats,
+                    int stream_id, bool keyframe, bool predicted,
+                    uint64_t capture_us, uint64_t now_us) const;
+    int encode_binary(uint8_t* buf, size_t cap, const TrackedObject& ball,
+                      const TrackedObject& putter, const PuttData& stats,
+                      int stream_id, uint32_t sequence, bool keyframe,
+                      bool predicted, uint64_t capture_us, uint64_t now_us) const;
+
+    SenderOptions opts_;
+    std::vector<StreamState> streams_;
+    Datagram queue_[kMaxQueued];
+    int queued_ = 0;
+    std::chrono::steady_clock::time_point oldest_queued_;
+    SendCounters counters_;
+    LatencyMetrics* metrics_ = nullptr;
     int sock_fd_ = -1;
     ::sockaddr_in* dest_addr_ = nullptr;
 };
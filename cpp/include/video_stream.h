@@ -0,0 +1,114 @@
+#pragma once
+// ─────────────────────────────────────────────────────────────────────────────
+// video_stream.h  –  Annotated MJPEG Stream for Remote Monitoring
+//
+// Serves each bay's annotated preview as MJPEG over HTTP
+// (multipart/x-mixed-replace, GET /api/video?bay=N on StatsApi), which any
+// browser or VLC plays without a plugin.
+//
+//   PreviewWindow thread ── offer() ──> one-slot mailbox per bay
+//        (rate-limited to fps, downscaled to width)
+//   encoder thread ── JPEG ──> latest part per bay ──> HTTP clients
+//
+// Nothing runs for a bay nobody watches: watching() is false, the preview
+// neither renders nor offers, and the encoder thread sleeps.  Encoding is on
+// its own thread, so a slow JPEG never holds up rendering, let alone
+// inference; clients that fall behind just miss frames.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include <opencv2/opencv.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace golf {
+
+struct VideoStreamOptions {
+    double fps     = 10.0;    // encoded frames per second per bay
+    int    width   = 640;     // encoded width, px (never upscaled)
+    int    quality = 70;      // JPEG quality, 1-100
+};
+
+class VideoStream {
+public:
+    VideoStream(int sources, const VideoStreamOptions& opts);
+    ~VideoStream();
+
+    VideoStream(const VideoStream&) = delete;
+    VideoStream& operator=(const VideoStream&) = delete;
+
+    void start();
+    void stop();
+
+    int sources() const { return static_cast<int>(bays_.size()); }
+    bool running() const { return running_.load(std::memory_order_relaxed); }
+
+    /// A client is connected to `source`'s stream.
+    bool watching(int source) const;
+
+    /// Preview thread: an annotated frame of `source`.  Cheap no-op unless
+    /// someone watches and the next frame is due.
+    void offer(int source, const cv::Mat& annotated);
+
+    // ─── HTTP side ──────────────────────────────────────────────────────────
+    /// Multipart boundary of every part.
+    static const char* boundary() { return "golfframe"; }
+
+    void subscribe(int source);
+    void unsubscribe(int source);
+
+    /// Wait up to `timeout` for a part newer than `seq` (0 = any).
+    /// @return the part (boundary, headers and JPEG), or null on timeout /
+    ///         stop; `seq` is advanced past it
+    std::shared_ptr<const std::string> wait_part(int source, uint64_t& seq,
+                                                 std::chrono::milliseconds timeout);
+
+    /// {"fps":…, "width":…, "bays":[{"bay":0, "clients":…, "frames":…, "bytes":…}, …]}
+    std::string to_json() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Bay {
+        std::atomic<int> clients{0};
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> bytes{0};
+
+        // Preview thread only
+        cv::Mat staged;
+        Clock::time_point next_due{};
+
+        // Preview → encoder (mutex_)
+        cv::Mat pending;
+        bool fresh = false;
+
+        // Encoder → clients (mutex_)
+        std::shared_ptr<const std::string> part;
+        uint64_t seq = 0;
+
+        // Encoder thread only
+        cv::Mat encoding;
+        std::vector<uint8_t> jpeg;
+    };
+
+    void run();
+
+    VideoStreamOptions opts_;
+    Clock::duration period_;
+    std::vector<std::unique_ptr<Bay>> bays_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable encode_cv_;   // fresh frames / stop
+    std::condition_variable part_cv_;     // new parts / stop
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+}  // namespace golf
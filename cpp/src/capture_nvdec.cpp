@@ -0,0 +1,157 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// capture_nvdec.cpp  –  NVDEC Capture into Device Memory
+//
+// cv::cudacodec::VideoReader demuxes on the CPU and decodes on NVDEC; the
+// decoded BGRA surface stays in device memory and is handed to the GPU
+// pre-processor as a DeviceFrame.  Decoded frames come from a small pool
+// that is recycled once the pipeline has released them.
+//
+// Decoder, pool and stream live on CaptureOptions::gpu: the decoder is
+// created there and the capture thread binds to it before its first read.
+//
+// read() does not wait for the decode: each surface carries an event
+// recorded behind it on the decode stream, and the consumer's stream waits
+// on that (DeviceFrame::ready) before its copy.  Only a host copy blocks.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "capture_backend.h"
+
+#include <iostream>
+
+#ifdef GOLF_HAVE_NVDEC
+
+#include <opencv2/core/cuda.hpp>
+#include <opencv2/core/cuda_stream_accessor.hpp>
+#include <opencv2/cudacodec.hpp>
+
+#include <cuda_runtime_api.h>
+
+#include <thread>
+#include <vector>
+
+namespace golf {
+
+namespace {
+
+class NvdecCapture : public CaptureBackend {
+public:
+    bool open(const std::string& source, const CaptureOptions& opts) override {
+        const int previous = cv::cuda::getDevice();
+        gpu_ = opts.gpu >= 0 ? opts.gpu : previous;
+        try {
+            cv::cuda::setDevice(gpu_);
+            reader_ = cv::cudacodec::createVideoReader(source);
+            reader_->set(cv::cudacodec::ColorFormat::BGRA);
+            stream_ = cv::cuda::Stream();
+        } catch (const cv::Exception& e) {
+            std::cerr << "[NvdecCapture] Cannot open " << source << " on GPU " << gpu_
+                      << ": " << e.what() << "\n";
+            reader_.release();
+            cv::cuda::setDevice(previous);
+            return false;
+        }
+        cv::cuda::setDevice(previous);
+        host_copy_ = opts.host_copy;
+        host_wanted_ = opts.host_wanted;
+
+        const cv::cudacodec::FormatInfo info = reader_->format();
+        std::cout << "[NvdecCapture] Opened: " << source << " ("
+                  << info.width << "x" << info.height << ", NVDEC → GPU " << gpu_
+                  << (host_copy_ ? " + host copy" : host_wanted_ ? " + host copy on demand" : "")
+                  << ")\n";
+        return true;
+    }
+
+    bool read(cv::Mat& frame, DeviceFrame& device) override {
+        if (!reader_) return false;
+        if (bound_ != std::this_thread::get_id()) {
+            cv::cuda::setDevice(gpu_);
+            bound_ = std::this_thread::get_id();
+        }
+
+        std::shared_ptr<Surface> surface = acquire();
+        if (!surface || !reader_->nextFrame(surface->mat, stream_)) return false;
+        cudaStream_t stream = cv::cuda::StreamAccessor::getStream(stream_);
+        if (cudaEventRecord(surface->decoded, stream) != cudaSuccess) {
+            std::cerr << "[NvdecCapture] cudaEventRecord failed\n";
+            return false;
+        }
+
+        const cv::cuda::GpuMat& mat = surface->mat;
+        device.data = mat.data;
+        device.pitch = mat.step;
+        device.width = mat.cols;
+        device.height = mat.rows;
+        device.channels = mat.channels();
+        device.gpu = gpu_;
+        device.ready = surface->decoded;
+        device.hold = surface;
+
+        if (host_copy_ || (host_wanted_ && host_wanted_())) {
+            mat.download(bgra_, stream_);
+            stream_.waitForCompletion();
+            cv::cvtColor(bgra_, frame, cv::COLOR_BGRA2BGR);
+        } else {
+            frame.release();          // the pooled item may hold an older frame
+        }
+        return true;
+    }
+
+    bool is_open() const override { return !reader_.empty(); }
+    const char* name() const override { return "nvdec"; }
+
+private:
+    struct Surface {
+        cv::cuda::GpuMat mat;
+        cudaEvent_t decoded = nullptr;   // recorded after the decode into mat
+
+        ~Surface() {
+            if (decoded) cudaEventDestroy(decoded);
+        }
+    };
+
+    // A surface is free again once no DeviceFrame refers to it.
+    std::shared_ptr<Surface> acquire() {
+        for (const auto& s : pool_) {
+            if (s.use_count() == 1) return s;
+        }
+        auto s = std::make_shared<Surface>();
+        if (cudaEventCreateWithFlags(&s->decoded, cudaEventDisableTiming) != cudaSuccess) {
+            std::cerr << "[NvdecCapture] cudaEventCreate failed\n";
+            return nullptr;
+        }
+        pool_.push_back(s);
+        return s;
+    }
+
+    cv::Ptr<cv::cudacodec::VideoReader> reader_;
+    int gpu_ = 0;
+    std::thread::id bound_;                           // thread set to gpu_
+    cv::cuda::Stream stream_;
+    std::vector<std::shared_ptr<Surface>> pool_;
+    cv::Mat bgra_;                                    // host download, reused
+    bool host_copy_ = true;
+    std::function<bool()> host_wanted_;
+};
+
+}  // namespace
+
+std::unique_ptr<CaptureBackend> make_nvdec_capture() {
+    return std::make_unique<NvdecCapture>();
+}
+
+}  // namespace golf
+
+#else  // !GOLF_HAVE_NVDEC
+
+namespace golf {
+
+std::unique_ptr<CaptureBackend> make_nvdec_capture() {
+    std::cerr << "[FramePipeline] NVDEC capture needs OpenCV built with the "
+                 "cudacodec module\n";
+    return nullptr;
+}
+
+}  // namespace golf
+
+#endif
@@ -0,0 +1,293 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// capture_v4l2.cpp  –  V4L2 mmap Streaming Capture
+//
+// Buffers are mmap'd from the driver and converted (YUYV / UYVY / NV12 →
+// BGR, MJPEG decode, or a plain copy for BGR3) straight into the output
+// frame, so each frame is touched exactly once on the CPU.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "capture_backend.h"
+
+#include <iostream>
+
+#ifdef GOLF_HAVE_V4L2
+
+#include <linux/videodev2.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+namespace golf {
+
+namespace {
+
+constexpr int kNumBuffers = 4;
+constexpr int kPollTimeoutMs = 2000;
+
+int xioctl(int fd, unsigned long request, void* arg) {
+    int r;
+    do {
+        r = ioctl(fd, request, arg);
+    } while (r == -1 && errno == EINTR);
+    return r;
+}
+
+uint32_t to_fourcc(const std::string& s) {
+    char c[4] = {' ', ' ', ' ', ' '};
+    std::memcpy(c, s.data(), std::min<size_t>(s.size(), 4));
+    return v4l2_fourcc(c[0], c[1], c[2], c[3]);
+}
+
+std::string fourcc_str(uint32_t f) {
+    return {static_cast<char>(f & 0xff), static_cast<char>((f >> 8) & 0xff),
+            static_cast<char>((f >> 16) & 0xff), static_cast<char>((f >> 24) & 0xff)};
+}
+
+class V4l2Capture : public CaptureBackend {
+public:
+    ~V4l2Capture() override { close(); }
+
+    bool open(const std::string& source, const CaptureOptions& opts) override {
+        const bool index = !source.empty() &&
+            std::all_of(source.begin(), source.end(), ::isdigit);
+        const std::string path = index ? "/dev/video" + source : source;
+
+        fd_ = ::open(path.c_str(), O_RDWR | O_NONBLOCK);
+        if (fd_ < 0) {
+            std::cerr << "[V4l2Capture] Cannot open " << path << ": "
+                      << std::strerror(errno) << "\n";
+            return false;
+        }
+
+        v4l2_capability cap{};
+        if (xioctl(fd_, VIDIOC_QUERYCAP, &cap) < 0 ||
+            !(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE) ||
+            !(cap.capabilities & V4L2_CAP_STREAMING)) {
+            std::cerr << "[V4l2Capture] " << path
+                      << " is not a streaming capture device\n";
+            close();
+            return false;
+        }
+
+        // Format – the driver may adjust size and pixel format
+        v4l2_format fmt{};
+        fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        fmt.fmt.pix.width = opts.width;
+        fmt.fmt.pix.height = opts.height;
+        fmt.fmt.pix.pixelformat = to_fourcc(opts.pixel_format);
+        fmt.fmt.pix.field = V4L2_FIELD_ANY;
+        if (xioctl(fd_, VIDIOC_S_FMT, &fmt) < 0) {
+            std::cerr << "[V4l2Capture] VIDIOC_S_FMT failed: "
+                      << std::strerror(errno) << "\n";
+            close();
+            return false;
+        }
+        width_ = static_cast<int>(fmt.fmt.pix.width);
+        height_ = static_cast<int>(fmt.fmt.pix.height);
+        stride_ = static_cast<size_t>(fmt.fmt.pix.bytesperline);
+        pixfmt_ = fmt.fmt.pix.pixelformat;
+        if (!supported(pixfmt_)) {
+            std::cerr << "[V4l2Capture] Unsupported pixel format "
+                      << fourcc_str(pixfmt_) << "\n";
+            close();
+            return false;
+        }
+
+        if (opts.fps > 0) {
+            v4l2_streamparm parm{};
+            parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            parm.parm.capture.timeperframe.numerator = 1000;
+            parm.parm.capture.timeperframe.denominator =
+                static_cast<uint32_t>(opts.fps * 1000.0);
+            xioctl(fd_, VIDIOC_S_PARM, &parm);   // best effort
+        }
+
+        if (!map_buffers() || !start_streaming()) {
+            close();
+            return false;
+        }
+
+        std::cout << "[V4l2Capture] Opened: " << path << " (" << width_ << "x"
+                  << height_ << " " << fourcc_str(pixfmt_) << ", "
+                  << buffers_.size() << " mmap buffers)\n";
+        return true;
+    }
+
+    bool read(cv::Mat& frame, DeviceFrame&) override {
+        if (fd_ < 0) return false;
+
+        pollfd pfd{fd_, POLLIN, 0};
+        int r;
+        do {
+            r = poll(&pfd, 1, kPollTimeoutMs);
+        } while (r == -1 && errno == EINTR);
+        if (r <= 0) {
+            std::cerr << "[V4l2Capture] Timed out waiting for a frame\n";
+            return false;
+        }
+
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        if (xioctl(fd_, VIDIOC_DQBUF, &buf) < 0) {
+            std::cerr << "[V4l2Capture] VIDIOC_DQBUF failed: "
+                      << std::strerror(errno) << "\n";
+            return false;
+        }
+
+        const bool ok = convert(buffers_[buf.index], buf.bytesused, frame);
+        timestamp_ = static_cast<double>(buf.timestamp.tv_sec) +
+                     static_cast<double>(buf.timestamp.tv_usec) * 1e-6;
+
+        // Hand the buffer straight back to the driver
+        if (xioctl(fd_, VIDIOC_QBUF, &buf) < 0) {
+            std::cerr << "[V4l2Capture] VIDIOC_QBUF failed\n";
+            return false;
+        }
+        return ok;
+    }
+
+    bool is_open() const override { return fd_ >= 0; }
+    const char* name() const override { return "v4l2"; }
+    double timestamp() const override { return timestamp_; }
+
+private:
+    struct Buffer {
+        void*  start = nullptr;
+        size_t length = 0;
+    };
+
+    static bool supported(uint32_t f) {
+        return f == V4L2_PIX_FMT_MJPEG || f == V4L2_PIX_FMT_YUYV ||
+               f == V4L2_PIX_FMT_UYVY || f == V4L2_PIX_FMT_NV12 ||
+               f == V4L2_PIX_FMT_BGR24;
+    }
+
+    bool map_buffers() {
+        v4l2_requestbuffers req{};
+        req.count = kNumBuffers;
+        req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        req.memory = V4L2_MEMORY_MMAP;
+        if (xioctl(fd_, VIDIOC_REQBUFS, &req) < 0 || req.count < 2) {
+            std::cerr << "[V4l2Capture] VIDIOC_REQBUFS failed\n";
+            return false;
+        }
+
+        buffers_.resize(req.count);
+        for (uint32_t i = 0; i < req.count; ++i) {
+            v4l2_buffer buf{};
+            buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = V4L2_MEMORY_MMAP;
+            buf.index = i;
+            if (xioctl(fd_, VIDIOC_QUERYBUF, &buf) < 0) {
+                std::cerr << "[V4l2Capture] VIDIOC_QUERYBUF failed\n";
+                return false;
+            }
+
+            Buffer& b = buffers_[i];
+            b.length = buf.length;
+            b.start = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, fd_, buf.m.offset);
+            if (b.start == MAP_FAILED) {
+                b.start = nullptr;
+                std::cerr << "[V4l2Capture] mmap failed\n";
+                return false;
+            }
+
+            if (xioctl(fd_, VIDIOC_QBUF, &buf) < 0) {
+                std::cerr << "[V4l2Capture] VIDIOC_QBUF failed\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool start_streaming() {
+        v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        if (xioctl(fd_, VIDIOC_STREAMON, &type) < 0) {
+            std::cerr << "[V4l2Capture] VIDIOC_STREAMON failed: "
+                      << std::strerror(errno) << "\n";
+            return false;
+        }
+        streaming_ = true;
+        return true;
+    }
+
+    bool convert(const Buffer& b, size_t bytes, cv::Mat& frame) const {
+        uint8_t* data = static_cast<uint8_t*>(b.start);
+        switch (pixfmt_) {
+            case V4L2_PIX_FMT_MJPEG:
+                // Decode into the caller's (recycled) image
+                cv::imdecode(cv::Mat(1, static_cast<int>(bytes), CV_8UC1, data),
+                             cv::IMREAD_COLOR, &frame);
+                break;
+            case V4L2_PIX_FMT_YUYV:
+                cv::cvtColor(cv::Mat(height_, width_, CV_8UC2, data, stride_),
+                             frame, cv::COLOR_YUV2BGR_YUYV);
+                break;
+            case V4L2_PIX_FMT_UYVY:
+                cv::cvtColor(cv::Mat(height_, width_, CV_8UC2, data, stride_),
+                             frame, cv::COLOR_YUV2BGR_UYVY);
+                break;
+            case V4L2_PIX_FMT_NV12:
+                cv::cvtColor(cv::Mat(height_ * 3 / 2, width_, CV_8UC1, data, stride_),
+                             frame, cv::COLOR_YUV2BGR_NV12);
+                break;
+            case V4L2_PIX_FMT_BGR24:
+                cv::Mat(height_, width_, CV_8UC3, data, stride_).copyTo(frame);
+                break;
+        }
+        return !frame.empty();
+    }
+
+    void close() {
+        if (fd_ < 0) return;
+        if (streaming_) {
+            v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            xioctl(fd_, VIDIOC_STREAMOFF, &type);
+            streaming_ = false;
+        }
+        for (Buffer& b : buffers_) {
+            if (b.start) munmap(b.start, b.length);
+        }
+        buffers_.clear();
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    int fd_ = -1;
+    bool streaming_ = false;
+    int width_ = 0, height_ = 0;
+    size_t stride_ = 0;
+    uint32_t pixfmt_ = 0;
+    std::vector<Buffer> buffers_;
+    double timestamp_ = -1.0;            // driver timestamp of the last frame
+};
+
+}  // namespace
+
+std::unique_ptr<CaptureBackend> make_v4l2_capture() {
+    return std::make_unique<V4l2Capture>();
+}
+
+}  // namespace golf
+
+#else  // !GOLF_HAVE_V4L2
+
+namespace golf {
+
+std::unique_ptr<CaptureBackend> make_v4l2_capture() {
+    std::cerr << "[FramePipeline] V4L2 capture is only available on Linux\n";
+    return nullptr;
+}
+
+}  // namespace golf
+
+#endif
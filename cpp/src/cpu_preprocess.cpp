@@ -0,0 +1,264 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// cpu_preprocess.cpp  –  BGR8 → Planar RGB Float Kernels & Dispatch
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "cpu_preprocess.h"
+
+#include <atomic>
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define GOLF_CPU_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define GOLF_CPU_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace golf {
+
+// ─── Kernel Selection ───────────────────────────────────────────────────────
+bool parse_cpu_kernel(const std::string& name, CpuKernel& out) {
+    if (name == "auto")   { out = CpuKernel::AUTO;   return true; }
+    if (name == "scalar") { out = CpuKernel::SCALAR; return true; }
+    if (name == "avx2")   { out = CpuKernel::AVX2;   return true; }
+    if (name == "neon")   { out = CpuKernel::NEON;   return true; }
+    return false;
+}
+
+const char* cpu_kernel_name(CpuKernel kernel) {
+    switch (kernel) {
+        case CpuKernel::AUTO:   return "auto";
+        case CpuKernel::SCALAR: return "scalar";
+        case CpuKernel::AVX2:   return "avx2";
+        case CpuKernel::NEON:   return "neon";
+    }
+    return "?";
+}
+
+bool cpu_kernel_supported(CpuKernel kernel) {
+    switch (kernel) {
+        case CpuKernel::AUTO:
+        case CpuKernel::SCALAR:
+            return true;
+        case CpuKernel::AVX2:
+#ifdef GOLF_CPU_AVX2
+            return cv::checkHardwareSupport(CV_CPU_AVX2);
+#else
+            return false;
+#endif
+        case CpuKernel::NEON:
+#ifdef GOLF_CPU_NEON
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+namespace {
+
+CpuKernel best_kernel() {
+    if (cpu_kernel_supported(CpuKernel::AVX2)) return CpuKernel::AVX2;
+    if (cpu_kernel_supported(CpuKernel::NEON)) return CpuKernel::NEON;
+    return CpuKernel::SCALAR;
+}
+
+std::atomic<CpuKernel>& active_kernel() {
+    static std::atomic<CpuKernel> kernel{best_kernel()};
+    return kernel;
+}
+
+}  // namespace
+
+CpuKernel cpu_kernel() {
+    return active_kernel().load(std::memory_order_relaxed);
+}
+
+bool set_cpu_kernel(CpuKernel kernel) {
+    if (!cpu_kernel_supported(kernel)) return false;
+    active_kernel().store(kernel == CpuKernel::AUTO ? best_kernel() : kernel,
+                          std::memory_order_relaxed);
+    return true;
+}
+
+// ─── Kernels ────────────────────────────────────────────────────────────────
+// Each converts rows [y0, y1) of `bgr`; planes are rows × cols floats.
+namespace {
+
+// The factor convertTo(CV_32F, 1/255.) multiplies by (float work type)
+const float kScale = static_cast<float>(1.0 / 255.0);
+
+// 8-bit value → kScale * value, shared by the scalar kernel and SIMD tails
+struct UnitTable {
+    float v[256];
+    UnitTable() {
+        for (int i = 0; i < 256; ++i) v[i] = static_cast<float>(i) * kScale;
+    }
+};
+const UnitTable kUnit;
+
+inline void pixels_scalar(const uint8_t* px, int x0, int x1,
+                          float* r, float* g, float* b) {
+    for (int x = x0; x < x1; ++x) {
+        const uint8_t* p = px + 3 * x;
+        b[x] = kUnit.v[p[0]];
+        g[x] = kUnit.v[p[1]];
+        r[x] = kUnit.v[p[2]];
+    }
+}
+
+void rows_scalar(const cv::Mat& bgr, int y0, int y1, float* r, float* g, float* b) {
+    const size_t w = static_cast<size_t>(bgr.cols);
+    for (int y = y0; y < y1; ++y) {
+        const size_t row = y * w;
+        pixels_scalar(bgr.ptr<uint8_t>(y), 0, bgr.cols, r + row, g + row, b + row);
+    }
+}
+
+#ifdef GOLF_CPU_AVX2
+// pshufb masks gathering one channel of 16 BGR pixels (48 bytes, three
+// 16-byte loads) into 16 consecutive bytes: [channel][load][byte]
+struct ChannelMasks {
+    alignas(16) int8_t m[3][3][16];
+    ChannelMasks() {
+        for (int c = 0; c < 3; ++c) {
+            for (int k = 0; k < 3; ++k) {
+                for (int i = 0; i < 16; ++i) {
+                    const int src = 3 * i + c;
+                    m[c][k][i] = static_cast<int8_t>(src / 16 == k ? src % 16 : 0x80);
+                }
+            }
+        }
+    }
+};
+const ChannelMasks kMasks;
+
+__attribute__((target("avx2")))
+inline __m128i gather_channel(__m128i a0, __m128i a1, __m128i a2, const __m128i* mask) {
+    return _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a0, mask[0]),
+                                     _mm_shuffle_epi8(a1, mask[1])),
+                        _mm_shuffle_epi8(a2, mask[2]));
+}
+
+__attribute__((target("avx2")))
+inline void store_unit(__m128i v, float* dst, __m256 scale) {
+    const __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(v));
+    const __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(v, 8)));
+    _mm256_storeu_ps(dst,     _mm256_mul_ps(lo, scale));
+    _mm256_storeu_ps(dst + 8, _mm256_mul_ps(hi, scale));
+}
+
+__attribute__((target("avx2")))
+void rows_avx2(const cv::Mat& bgr, int y0, int y1, float* r, float* g, float* b) {
+    __m128i mask[3][3];
+    for (int c = 0; c < 3; ++c) {
+        for (int k = 0; k < 3; ++k) {
+            mask[c][k] = _mm_load_si128(reinterpret_cast<const __m128i*>(kMasks.m[c][k]));
+        }
+    }
+    const __m256 scale = _mm256_set1_ps(kScale);
+    const int w = bgr.cols;
+
+    for (int y = y0; y < y1; ++y) {
+        const uint8_t* px = bgr.ptr<uint8_t>(y);
+        const size_t row = static_cast<size_t>(y) * w;
+        int x = 0;
+        for (; x + 16 <= w; x += 16) {
+            const uint8_t* p = px + 3 * x;
+            const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+            const __m128i a2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32));
+            store_unit(gather_channel(a0, a1, a2, mask[0]), b + row + x, scale);
+            store_unit(gather_channel(a0, a1, a2, mask[1]), g + row + x, scale);
+            store_unit(gather_channel(a0, a1, a2, mask[2]), r + row + x, scale);
+        }
+        pixels_scalar(px, x, w, r + row, g + row, b + row);
+    }
+}
+#endif  // GOLF_CPU_AVX2
+
+#ifdef GOLF_CPU_NEON
+inline void store_unit(uint8x16_t v, float* dst, float32x4_t scale) {
+    const uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+    const uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+    vst1q_f32(dst,      vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))), scale));
+    vst1q_f32(dst + 4,  vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))), scale));
+    vst1q_f32(dst + 8,  vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))), scale));
+    vst1q_f32(dst + 12, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))), scale));
+}
+
+void rows_neon(const cv::Mat& bgr, int y0, int y1, float* r, float* g, float* b) {
+    const float32x4_t scale = vdupq_n_f32(kScale);
+    const int w = bgr.cols;
+
+    for (int y = y0; y < y1; ++y) {
+        const uint8_t* px = bgr.ptr<uint8_t>(y);
+        const size_t row = static_cast<size_t>(y) * w;
+        int x = 0;
+        for (; x + 16 <= w; x += 16) {
+            const uint8x16x3_t v = vld3q_u8(px + 3 * x);   // de-interleaves B, G, R
+            store_unit(v.val[0], b + row + x, scale);
+            store_unit(v.val[1], g + row + x, scale);
+            store_unit(v.val[2], r + row + x, scale);
+        }
+        pixels_scalar(px, x, w, r + row, g + row, b + row);
+    }
+}
+#endif  // GOLF_CPU_NEON
+
+using RowsFn = void (*)(const cv::Mat&, int, int, float*, float*, float*);
+
+RowsFn rows_fn(CpuKernel kernel) {
+    switch (kernel) {
+#ifdef GOLF_CPU_AVX2
+        case CpuKernel::AVX2: return rows_avx2;
+#endif
+#ifdef GOLF_CPU_NEON
+        case CpuKernel::NEON: return rows_neon;
+#endif
+        default: return rows_scalar;
+    }
+}
+
+// Rows per parallel_for_ stripe: enough work to amortise the hand-off
+constexpr int kStripeRows = 32;
+
+class PlanarBody : public cv::ParallelLoopBody {
+public:
+    PlanarBody(const cv::Mat& bgr, float* dst, RowsFn fn)
+        : bgr_(bgr), fn_(fn), r_(dst),
+          g_(dst + bgr.total()), b_(dst + 2 * bgr.total()) {}
+
+    void operator()(const cv::Range& rows) const override {
+        fn_(bgr_, rows.start, rows.end, r_, g_, b_);
+    }
+
+private:
+    const cv::Mat& bgr_;
+    RowsFn fn_;
+    float* r_;
+    float* g_;
+    float* b_;
+};
+
+}  // namespace
+
+// ─── Entry Point ────────────────────────────────────────────────────────────
+void bgr_to_planar_rgb(const cv::Mat& bgr, float* dst, CpuKernel kernel) {
+    if (kernel == CpuKernel::AUTO) kernel = cpu_kernel();
+    if (!cpu_kernel_supported(kernel)) kernel = CpuKernel::SCALAR;
+
+    const PlanarBody body(bgr, dst, rows_fn(kernel));
+    if (bgr.rows <= kStripeRows) {
+        body(cv::Range(0, bgr.rows));
+    } else {
+        cv::parallel_for_(cv::Range(0, bgr.rows), body,
+                          static_cast<double>(bgr.rows) / kStripeRows);
+    }
+}
+
+}  // namespace golf
@@ -0,0 +1,399 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// engine_builder.cpp  –  ONNX Parse, FP16 / INT8 Build, Engine Cache
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "engine_builder.h"
+#include "frame_pipeline.h"
+#include "trt_engine.h"
+
+#include <NvOnnxParser.h>
+#include <cuda_runtime_api.h>
+#include <opencv2/opencv.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace golf {
+
+// ─── Options ────────────────────────────────────────────────────────────────
+bool parse_precision(const std::string& name, Precision& out) {
+    if (name == "fp32") { out = Precision::FP32; return true; }
+    if (name == "fp16") { out = Precision::FP16; return true; }
+    if (name == "int8") { out = Precision::INT8; return true; }
+    return false;
+}
+
+const char* precision_name(Precision precision) {
+    switch (precision) {
+        case Precision::FP32: return "fp32";
+        case Precision::FP16: return "fp16";
+        case Precision::INT8: return "int8";
+    }
+    return "?";
+}
+
+bool is_onnx_model(const std::string& path) {
+    static const std::string kExt = ".onnx";
+    if (path.size() < kExt.size()) return false;
+    return std::equal(kExt.rbegin(), kExt.rend(), path.rbegin(),
+                      [](char a, char b) { return a == std::tolower(b); });
+}
+
+// ─── Cache Key ──────────────────────────────────────────────────────────────
+namespace {
+
+/// FNV-1a over the file contents (mapped, not read into memory).
+bool hash_file(const std::string& path, uint64_t& hash) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) return false;
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    hash = 0xcbf29ce484222325ull;
+    const auto* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ p[i]) * 0x100000001b3ull;
+    }
+    munmap(data, size);
+    return true;
+}
+
+/// "RTX_4090-sm89" for the current CUDA device.
+bool device_tag(std::string& tag) {
+    int device = 0;
+    cudaDeviceProp prop{};
+    if (cudaGetDevice(&device) != cudaSuccess ||
+        cudaGetDeviceProperties(&prop, device) != cudaSuccess) {
+        return false;
+    }
+    std::string name;
+    for (const char* c = prop.name; *c; ++c) {
+        if (std::isalnum(static_cast<unsigned char>(*c))) {
+            name += *c;
+        } else if (!name.empty() && name.back() != '_') {
+            name += '_';
+        }
+    }
+    while (!name.empty() && name.back() == '_') name.pop_back();
+    if (name.compare(0, 7, "NVIDIA_") == 0) name.erase(0, 7);
+    tag = name + "-sm" + std::to_string(prop.major) + std::to_string(prop.minor);
+    return true;
+}
+
+std::string model_stem(const std::string& path) {
+    const size_t slash = path.find_last_of('/');
+    const std::string file = slash == std::string::npos ? path : path.substr(slash + 1);
+    return file.substr(0, file.size() - 5);   // ".onnx"
+}
+
+std::string cache_dir(const std::string& onnx_path, const BuildOptions& opts) {
+    if (!opts.cache_dir.empty()) return opts.cache_dir;
+    const size_t slash = onnx_path.find_last_of('/');
+    return slash == std::string::npos ? "." : onnx_path.substr(0, slash);
+}
+
+std::string hex(uint64_t v, int digits) {
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(v));
+    return std::string(buf + 16 - digits);
+}
+
+/// Calibration tables depend on the model, the pre-processing and the
+/// TensorRT version – not on the GPU – so one is shared by every device.
+std::string calibration_cache_path(const std::string& onnx_path, const BuildOptions& opts) {
+    uint64_t hash = 0;
+    if (!hash_file(onnx_path, hash)) return {};
+    return cache_dir(onnx_path, opts) + "/" + model_stem(onnx_path) +
+           ".trt" + std::to_string(getInferLibVersion()) +
+           (opts.letterbox ? ".lb." : ".") + hex(hash, 12) + ".calib";
+}
+
+}  // namespace
+
+std::string engine_cache_path(const std::string& onnx_path, const BuildOptions& opts) {
+    uint64_t hash = 0;
+    std::string gpu;
+    if (!hash_file(onnx_path, hash)) {
+        std::cerr << "[EngineBuilder] Cannot read " << onnx_path << "\n";
+        return {};
+    }
+    if (!device_tag(gpu)) {
+        std::cerr << "[EngineBuilder] Cannot query the CUDA device\n";
+        return {};
+    }
+    std::string name = model_stem(onnx_path) + "." + gpu +
+                       ".trt" + std::to_string(getInferLibVersion()) +
+                       "." + precision_name(opts.precision) +
+                       ".b" + std::to_string(opts.max_batch);
+    if (opts.precision == Precision::INT8 && opts.letterbox) name += ".lb";
+    return cache_dir(onnx_path, opts) + "/" + name + "." + hex(hash, 12) + ".engine";
+}
+
+// ─── INT8 Calibrator ────────────────────────────────────────────────────────
+namespace {
+
+/// Feeds calibration frames through the CPU pre-processing path, one
+/// network batch per getBatch().  An existing calibration table is
+/// returned instead, in which case no frame is read.
+class ImageCalibrator : public nvinfer1::IInt8EntropyCalibrator2 {
+public:
+    ImageCalibrator(std::vector<std::string> files, int batch, const nvinfer1::Dims& input,
+                    bool letterbox, std::string cache_path)
+        : files_(std::move(files)), batch_(batch),
+          c_(static_cast<int>(input.d[1])), h_(static_cast<int>(input.d[2])),
+          w_(static_cast<int>(input.d[3])),
+          letterbox_(letterbox), cache_path_(std::move(cache_path)) {
+        host_.resize(static_cast<size_t>(batch_) * c_ * h_ * w_);
+    }
+
+    ~ImageCalibrator() override {
+        if (d_batch_) cudaFree(d_batch_);
+    }
+
+    // Explicit-batch networks take the batch from the calibration profile
+    int32_t getBatchSize() const noexcept override { return 1; }
+
+    bool getBatch(void* bindings[], const char* names[], int32_t nb) noexcept override {
+        (void)names;
+        if (nb != 1 || next_ + batch_ > files_.size()) return false;
+        const size_t image = static_cast<size_t>(c_) * h_ * w_;
+        for (int k = 0; k < batch_; ++k) {
+            cv::Mat frame = cv::imread(files_[next_ + k], cv::IMREAD_COLOR);
+            float* dst = host_.data() + k * image;
+            if (frame.empty()) {
+                std::cerr << "[EngineBuilder] Cannot read " << files_[next_ + k] << "\n";
+                std::fill(dst, dst + image, 0.f);
+                continue;
+            }
+            FramePipeline::preprocess(frame, h_, w_, blob_, letterbox_);
+            std::copy(blob_.begin(), blob_.end(), dst);
+        }
+        next_ += batch_;
+
+        const size_t bytes = host_.size() * sizeof(float);
+        if (!d_batch_ && cudaMalloc(&d_batch_, bytes) != cudaSuccess) {
+            d_batch_ = nullptr;
+            return false;
+        }
+        if (cudaMemcpy(d_batch_, host_.data(), bytes, cudaMemcpyHostToDevice) != cudaSuccess) {
+            return false;
+        }
+        bindings[0] = d_batch_;
+        std::cout << "[EngineBuilder] Calibrating: " << next_ << " / "
+                  << files_.size() / batch_ * batch_ << " frames\r" << std::flush;
+        return true;
+    }
+
+    const void* readCalibrationCache(size_t& length) noexcept override {
+        std::ifstream in(cache_path_, std::ios::binary);
+        cache_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        length = cache_.size();
+        if (cache_.empty()) return nullptr;
+        std::cout << "[EngineBuilder] Using calibration table " << cache_path_ << "\n";
+        return cache_.data();
+    }
+
+    void writeCalibrationCache(const void* ptr, size_t length) noexcept override {
+        std::cout << "\n";
+        std::ofstream out(cache_path_, std::ios::binary);
+        out.write(static_cast<const char*>(ptr), static_cast<std::streamsize>(length));
+        if (!out) {
+            std::cerr << "[EngineBuilder] Cannot write " << cache_path_ << "\n";
+        }
+    }
+
+private:
+    std::vector<std::string> files_;
+    size_t next_ = 0;
+    int    batch_;
+    int    c_, h_, w_;
+    bool   letterbox_;
+    std::string cache_path_;
+    std::vector<char>  cache_;
+    std::vector<float> host_;
+    std::vector<float> blob_;
+    void*  d_batch_ = nullptr;
+};
+
+/// Image files under `dir` (recursively), sorted and thinned out evenly to
+/// at most `limit`.
+std::vector<std::string> calibration_images(const std::string& dir, int limit) {
+    std::vector<std::string> all, files;
+    cv::glob(dir + "/*", all, /*recursive=*/true);
+    for (const auto& f : all) {
+        const size_t dot = f.find_last_of('.');
+        if (dot == std::string::npos) continue;
+        std::string ext = f.substr(dot + 1);
+        std::transform(ext.begin(), ext.end(), ext.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        if (ext == "png" || ext == "jpg" || ext == "jpeg" || ext == "bmp") {
+            files.push_back(f);
+        }
+    }
+    std::sort(files.begin(), files.end());
+    if (limit > 0 && static_cast<int>(files.size()) > limit) {
+        std::vector<std::string> picked;
+        for (int i = 0; i < limit; ++i) {
+            picked.push_back(files[static_cast<size_t>(i) * files.size() / limit]);
+        }
+        files.swap(picked);
+    }
+    return files;
+}
+
+}  // namespace
+
+// ─── Build ──────────────────────────────────────────────────────────────────
+bool build_engine(const std::string& onnx_path, const BuildOptions& opts,
+                  const std::string& engine_path, nvinfer1::ILogger& logger) {
+    std::cout << "[EngineBuilder] Building " << precision_name(opts.precision)
+              << " engine from " << onnx_path << " (this can take minutes)\n";
+
+    mkdir(cache_dir(onnx_path, opts).c_str(), 0755);   // engines + calibration table
+
+    std::unique_ptr<nvinfer1::IBuilder, TrtDeleter> builder(
+        nvinfer1::createInferBuilder(logger));
+    if (!builder) {
+        std::cerr << "[EngineBuilder] Failed to create builder\n";
+        return false;
+    }
+#if NV_TENSORRT_MAJOR >= 10
+    const uint32_t network_flags = 0;      // explicit batch is the only mode
+#else
+    const uint32_t network_flags = 1u << static_cast<uint32_t>(
+        nvinfer1::NetworkDefinitionCreationFlag::kEXPLICIT_BATCH);
+#endif
+    std::unique_ptr<nvinfer1::INetworkDefinition, TrtDeleter> network(
+        builder->createNetworkV2(network_flags));
+    std::unique_ptr<nvonnxparser::IParser, TrtDeleter> parser(
+        nvonnxparser::createParser(*network, logger));
+    if (!network || !parser) {
+        std::cerr << "[EngineBuilder] Failed to create network / parser\n";
+        return false;
+    }
+    if (!parser->parseFromFile(onnx_path.c_str(),
+                               static_cast<int>(nvinfer1::ILogger::Severity::kWARNING))) {
+        for (int i = 0; i < parser->getNbErrors(); ++i) {
+            std::cerr << "[EngineBuilder] " << parser->getError(i)->desc() << "\n";
+        }
+        std::cerr << "[EngineBuilder] Failed to parse " << onnx_path << "\n";
+        return false;
+    }
+
+    if (network->getNbInputs() != 1) {
+        std::cerr << "[EngineBuilder] Expected 1 network input, got "
+                  << network->getNbInputs() << "\n";
+        return false;
+    }
+    nvinfer1::ITensor* input = network->getInput(0);
+    const nvinfer1::Dims dims = input->getDimensions();
+    if (dims.nbDims != 4 || dims.d[1] <= 0 || dims.d[2] <= 0 || dims.d[3] <= 0) {
+        std::cerr << "[EngineBuilder] Input must be N×C×H×W with fixed C, H, W\n";
+        return false;
+    }
+    const bool dynamic = dims.d[0] < 0;
+
+    std::unique_ptr<nvinfer1::IBuilderConfig, TrtDeleter> config(
+        builder->createBuilderConfig());
+    config->setMemoryPoolLimit(nvinfer1::MemoryPoolType::kWORKSPACE,
+                               opts.workspace_mb << 20);
+
+    // Dynamic batch: profile 0 covers 1 .. max_batch, tuned for max_batch
+    auto batch_profile = [&](int lo, int hi) {
+        nvinfer1::IOptimizationProfile* profile = builder->createOptimizationProfile();
+        nvinfer1::Dims d = dims;
+        d.d[0] = lo;
+        profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kMIN, d);
+        d.d[0] = hi;
+        profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kOPT, d);
+        profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kMAX, d);
+        return profile;
+    };
+    if (dynamic) {
+        config->addOptimizationProfile(batch_profile(1, std::max(opts.max_batch, 1)));
+    }
+
+    std::unique_ptr<ImageCalibrator> calibrator;
+    if (opts.precision == Precision::FP16 || opts.precision == Precision::INT8) {
+        // INT8 builds keep FP16 for the layers that have no INT8 kernel
+        config->setFlag(nvinfer1::BuilderFlag::kFP16);
+    }
+    if (opts.precision == Precision::INT8) {
+        config->setFlag(nvinfer1::BuilderFlag::kINT8);
+
+        const int batch = dynamic ? std::max(opts.calib_batch, 1)
+                                  : static_cast<int>(dims.d[0]);
+        const std::string table = calibration_cache_path(onnx_path, opts);
+        std::vector<std::string> files;
+        struct stat st{};
+        if (stat(table.c_str(), &st) != 0) {
+            files = calibration_images(opts.calib_dir, opts.calib_images);
+            if (static_cast<int>(files.size()) < batch) {
+                std::cerr << "[EngineBuilder] INT8 needs at least " << batch
+                          << " calibration images in " << opts.calib_dir
+                          << ", found " << files.size() << "\n";
+                return false;
+            }
+            std::cout << "[EngineBuilder] Calibrating on " << files.size()
+                      << " images from " << opts.calib_dir << "\n";
+        }
+        calibrator = std::make_unique<ImageCalibrator>(std::move(files), batch, dims,
+                                                       opts.letterbox, table);
+        config->setInt8Calibrator(calibrator.get());
+        if (dynamic) {
+            config->setCalibrationProfile(batch_profile(batch, batch));
+        }
+    }
+
+    std::unique_ptr<nvinfer1::IHostMemory, TrtDeleter> plan(
+        builder->buildSerializedNetwork(*network, *config));
+    if (!plan || plan->size() == 0) {
+        std::cerr << "[EngineBuilder] Engine build failed\n";
+        return false;
+    }
+
+    // Write beside the target and rename, so readers only ever see a
+    // complete engine
+    const std::string tmp = engine_path + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        out.write(static_cast<const char*>(plan->data()),
+                  static_cast<std::streamsize>(plan->size()));
+        if (!out) {
+            std::cerr << "[EngineBuilder] Cannot write " << tmp << "\n";
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tmp.c_str(), engine_path.c_str()) != 0) {
+        std::cerr << "[EngineBuilder] Cannot rename " << tmp << " → " << engine_path
+                  << ": " << std::strerror(errno) << "\n";
+        std::remove(tmp.c_str());
+        return false;
+    }
+    std::cout << "[EngineBuilder] Wrote " << engine_path << " ("
+              << plan->size() / (1024 * 1024) << " MiB)\n";
+    return true;
+}
+
+}  // namespace golf
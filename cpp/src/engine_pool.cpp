@@ -0,0 +1,163 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// engine_pool.cpp  –  Per-device Engine Loading & Context Scheduling
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "engine_pool.h"
+
+#include <cinttypes>
+#include <climits>
+#include <cstdio>
+#include <iostream>
+
+namespace golf {
+
+// ─── Load ───────────────────────────────────────────────────────────────────
+bool EnginePool::load(const std::string& model_path, const BuildOptions& build,
+                      const EnginePoolOptions& opts) {
+    std::vector<int> devices = opts.devices;
+    if (devices.empty()) devices.push_back(-1);
+
+    for (int device : devices) {
+        auto engine = std::make_unique<TrtEngine>();
+        if (!engine->load(model_path, build, device, opts.contexts)) {
+            std::cerr << "[EnginePool] Cannot load " << model_path << " on GPU "
+                      << device << "\n";
+            return false;
+        }
+        if (!engines_.empty()) {
+            const TrtEngine& first = *engines_.front();
+            if (engine->input_c() != first.input_c() ||
+                engine->input_h() != first.input_h() ||
+                engine->input_w() != first.input_w() ||
+                engine->output_length() != first.output_length() ||
+                engine->max_batch() != first.max_batch()) {
+                std::cerr << "[EnginePool] Engine on GPU " << engine->device()
+                          << " does not match the one on GPU " << first.device()
+                          << " (input, output or batch size)\n";
+                return false;
+            }
+        }
+        engines_.push_back(std::move(engine));
+    }
+
+    // Interleave devices so that equal loads alternate between GPUs
+    const int slots = engines_.front()->num_slots();
+    for (int s = 0; s < slots; ++s) {
+        for (int e = 0; e < num_devices(); ++e) {
+            auto ctx = std::make_unique<Context>();
+            ctx->engine = e;
+            ctx->slot = s;
+            contexts_.push_back(std::move(ctx));
+        }
+    }
+    in_flight_.assign(engines_.size(), 0);
+
+    std::cout << "[EnginePool] " << size() << " inference contexts on "
+              << num_devices() << " GPU(s):";
+    for (const auto& e : engines_) std::cout << " " << e->device();
+    std::cout << "\n";
+    return true;
+}
+
+void EnginePool::enable_cuda_graph(bool enable) {
+    for (auto& e : engines_) e->enable_cuda_graph(enable);
+}
+
+void EnginePool::enable_timing(bool enable) {
+    for (auto& e : engines_) e->enable_timing(enable);
+}
+
+bool EnginePool::has_device(int device) const {
+    for (const auto& e : engines_) {
+        if (e->device() == device) return true;
+    }
+    return false;
+}
+
+// ─── Scheduling ─────────────────────────────────────────────────────────────
+int EnginePool::acquire(int images, int device) {
+    int best = -1;
+    int best_load = INT_MAX;
+    uint64_t best_served = UINT64_MAX;
+    for (int i = 0; i < size(); ++i) {
+        const Context& c = *contexts_[i];
+        if (c.busy) continue;
+        if (device >= 0 && engines_[c.engine]->device() != device) continue;
+        const int load = in_flight_[c.engine];
+        const uint64_t served = c.served.load(std::memory_order_relaxed);
+        if (load < best_load || (load == best_load && served < best_served)) {
+            best = i;
+            best_load = load;
+            best_served = served;
+        }
+    }
+    if (best < 0) return -1;
+
+    Context& c = *contexts_[best];
+    c.busy = true;
+    c.images = images;
+    in_flight_[c.engine] += images;
+    c.batches.fetch_add(1, std::memory_order_relaxed);
+    c.served.fetch_add(static_cast<uint64_t>(images), std::memory_order_relaxed);
+    return best;
+}
+
+void EnginePool::release(int ctx, float gpu_ms) {
+    Context& c = *contexts_[ctx];
+    if (!c.busy) return;
+    c.busy = false;
+    in_flight_[c.engine] -= c.images;
+    if (gpu_ms > 0.f) {
+        c.gpu_us.fetch_add(static_cast<uint64_t>(gpu_ms * 1000.f), std::memory_order_relaxed);
+    }
+    c.images = 0;
+}
+
+// ─── Reporting ──────────────────────────────────────────────────────────────
+std::string EnginePool::to_json() const {
+    std::string out = "[";
+    char buf[224];
+    for (int i = 0; i < size(); ++i) {
+        const Context& c = *contexts_[i];
+        std::snprintf(buf, sizeof(buf),
+            "%s{\"context\":%d,\"gpu\":%d,\"slot\":%d,\"batches\":%" PRIu64
+            ",\"images\":%" PRIu64 ",\"gpu_ms\":%.1f}",
+            i ? "," : "", i, engines_[c.engine]->device(), c.slot,
+            c.batches.load(), c.served.load(), c.gpu_us.load() / 1000.0);
+        out += buf;
+    }
+    out += "]";
+    return out;
+}
+
+std::string EnginePool::to_prometheus() const {
+    std::string batches =
+        "# HELP golf_engine_batches_total Batches run per inference context.\n"
+        "# TYPE golf_engine_batches_total counter\n";
+    std::string images =
+        "# TYPE golf_engine_images_total counter\n";
+    std::string gpu =
+        "# HELP golf_engine_gpu_seconds_total GPU time per inference context.\n"
+        "# TYPE golf_engine_gpu_seconds_total counter\n";
+
+    char buf[160];
+    for (int i = 0; i < size(); ++i) {
+        const Context& c = *contexts_[i];
+        const int dev = engines_[c.engine]->device();
+        std::snprintf(buf, sizeof(buf),
+            "golf_engine_batches_total{gpu=\"%d\",context=\"%d\"} %" PRIu64 "\n",
+            dev, i, c.batches.load());
+        batches += buf;
+        std::snprintf(buf, sizeof(buf),
+            "golf_engine_images_total{gpu=\"%d\",context=\"%d\"} %" PRIu64 "\n",
+            dev, i, c.served.load());
+        images += buf;
+        std::snprintf(buf, sizeof(buf),
+            "golf_engine_gpu_seconds_total{gpu=\"%d\",context=\"%d\"} %.6f\n",
+            dev, i, c.gpu_us.load() / 1e6);
+        gpu += buf;
+    }
+    return batches + images + gpu;
+}
+
+}  // namespace golf
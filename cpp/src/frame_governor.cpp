@@ -0,0 +1,175 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// frame_governor.cpp  –  Idle / Full Rate Decisions, Frame-difference Wake
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "frame_governor.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+
+namespace golf {
+
+const char* governor_mode_name(GovernorMode mode) {
+    return mode == GovernorMode::IDLE ? "idle" : "full";
+}
+
+FrameGovernor::FrameGovernor(int sources, const GovernorOptions& opts)
+    : opts_(opts) {
+    const int64_t now = Clock::now().time_since_epoch().count();
+    for (int i = 0; i < sources; ++i) {
+        sources_.push_back(std::make_unique<Source>());
+        sources_.back()->last_active.store(now);   // full rate for hold_s at start
+    }
+}
+
+// ─── Capture side ───────────────────────────────────────────────────────────
+bool FrameGovernor::admit(int source, const cv::Mat& frame, Clock::time_point now) {
+    Source& s = *sources_[source];
+
+    if (s.mode.load(std::memory_order_acquire) == GovernorMode::FULL) {
+        const auto quiet = now - Clock::time_point(
+            Clock::duration(s.last_active.load(std::memory_order_acquire)));
+        GovernorMode expected = GovernorMode::FULL;
+        if (quiet < std::chrono::duration<double>(opts_.hold_s) ||
+            !s.mode.compare_exchange_strong(expected, GovernorMode::IDLE)) {
+            count(s, true, now);
+            return true;
+        }
+        // Just went idle: this frame becomes the motion reference
+        s.has_reference = false;
+        s.next_idle = now;
+    }
+
+    bool run = false;
+    if (!frame.empty() && motion(s, frame)) {
+        wake(s, now);
+        run = true;
+    } else if (now >= s.next_idle) {
+        const auto period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / std::max(opts_.idle_fps, 0.01)));
+        s.next_idle += period;
+        if (s.next_idle < now) s.next_idle = now + period;
+        run = true;
+    }
+    if (run && s.has_reference && !s.small.empty()) {
+        std::swap(s.reference, s.small);  // compare against what was inferred
+    }
+    count(s, run, now);
+    return run;
+}
+
+bool FrameGovernor::motion(Source& s, const cv::Mat& frame) {
+    const int w = std::min(opts_.motion_width, frame.cols);
+    const int h = std::max(1, frame.rows * w / frame.cols);
+    // Separate buffers per step, so each keeps its size and type
+    cv::resize(frame, s.scaled, cv::Size(w, h), 0, 0, cv::INTER_AREA);
+    if (s.scaled.channels() == 3) {
+        cv::cvtColor(s.scaled, s.small, cv::COLOR_BGR2GRAY);
+    } else {
+        s.scaled.copyTo(s.small);
+    }
+
+    if (!s.has_reference || s.reference.size() != s.small.size()) {
+        s.small.copyTo(s.reference);
+        s.has_reference = true;
+        return false;
+    }
+    cv::absdiff(s.small, s.reference, s.diff);
+    cv::threshold(s.diff, s.diff, opts_.motion_delta, 255, cv::THRESH_BINARY);
+    return cv::countNonZero(s.diff) >= opts_.motion_pixels;
+}
+
+void FrameGovernor::count(Source& s, bool admitted, Clock::time_point now) {
+    (admitted ? s.admitted : s.skipped).fetch_add(1, std::memory_order_relaxed);
+    if (s.window_start == Clock::time_point{}) s.window_start = now;
+    if (admitted) ++s.window_admitted;
+
+    const double elapsed = std::chrono::duration<double>(now - s.window_start).count();
+    if (elapsed >= 1.0) {
+        s.fps.store(s.window_admitted / elapsed, std::memory_order_relaxed);
+        s.window_start = now;
+        s.window_admitted = 0;
+    }
+}
+
+// ─── Tracking side ──────────────────────────────────────────────────────────
+void FrameGovernor::report(int source, PuttState state, const TrackedObject& ball,
+                           const TrackedObject& putter, Clock::time_point now) {
+    bool active = state == PuttState::IN_MOTION;
+    if (!active && ball.valid && putter.valid) {
+        active = std::hypot(putter.x - ball.x, putter.y - ball.y) < opts_.wake_distance;
+    }
+    if (active) wake(*sources_[source], now);
+}
+
+void FrameGovernor::wake(Source& s, Clock::time_point now) {
+    s.last_active.store(now.time_since_epoch().count(), std::memory_order_release);
+    if (s.mode.exchange(GovernorMode::FULL, std::memory_order_acq_rel) ==
+        GovernorMode::IDLE) {
+        s.wakeups.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+GovernorMode FrameGovernor::mode(int source) const {
+    return sources_[source]->mode.load(std::memory_order_relaxed);
+}
+
+double FrameGovernor::effective_fps(int source) const {
+    return sources_[source]->fps.load(std::memory_order_relaxed);
+}
+
+// ─── Exposition ─────────────────────────────────────────────────────────────
+std::string FrameGovernor::to_json() const {
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), "{\"idle_fps\":%.2f,\"hold_s\":%.2f,\"bays\":[",
+                  opts_.idle_fps, opts_.hold_s);
+    std::string out = buf;
+    for (size_t i = 0; i < sources_.size(); ++i) {
+        const Source& s = *sources_[i];
+        std::snprintf(buf, sizeof(buf),
+            "%s{\"bay\":%zu,\"mode\":\"%s\",\"fps\":%.2f,\"admitted\":%" PRIu64
+            ",\"skipped\":%" PRIu64 ",\"wakeups\":%" PRIu64 "}",
+            i ? "," : "", i, governor_mode_name(s.mode.load()), s.fps.load(),
+            s.admitted.load(), s.skipped.load(), s.wakeups.load());
+        out += buf;
+    }
+    out += "]}";
+    return out;
+}
+
+std::string FrameGovernor::to_prometheus() const {
+    std::string mode =
+        "# HELP golf_governor_idle 1 while the bay runs inference at the idle rate.\n"
+        "# TYPE golf_governor_idle gauge\n";
+    std::string fps =
+        "# HELP golf_governor_fps Frames sent to inference per second.\n"
+        "# TYPE golf_governor_fps gauge\n";
+    std::string frames =
+        "# TYPE golf_governor_frames_total counter\n";
+    std::string wakeups =
+        "# TYPE golf_governor_wakeups_total counter\n";
+
+    char buf[160];
+    for (size_t i = 0; i < sources_.size(); ++i) {
+        const Source& s = *sources_[i];
+        std::snprintf(buf, sizeof(buf), "golf_governor_idle{bay=\"%zu\"} %d\n",
+                      i, s.mode.load() == GovernorMode::IDLE ? 1 : 0);
+        mode += buf;
+        std::snprintf(buf, sizeof(buf), "golf_governor_fps{bay=\"%zu\"} %.3f\n",
+                      i, s.fps.load());
+        fps += buf;
+        std::snprintf(buf, sizeof(buf),
+            "golf_governor_frames_total{bay=\"%zu\",result=\"inferred\"} %" PRIu64 "\n"
+            "golf_governor_frames_total{bay=\"%zu\",result=\"skipped\"} %" PRIu64 "\n",
+            i, s.admitted.load(), i, s.skipped.load());
+        frames += buf;
+        std::snprintf(buf, sizeof(buf), "golf_governor_wakeups_total{bay=\"%zu\"} %" PRIu64 "\n",
+                      i, s.wakeups.load());
+        wakeups += buf;
+    }
+    return mode + fps + frames + wakeups;
+}
+
+}  // namespace golf
@@ -3,8 +3,11 @@
 // ─────────────────────────────────────────────────────────────────────────────
 
 #include "frame_pipeline.h"
+#include "cpu_preprocess.h"
+#include "recording.h"
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 
 namespace golf {
@@ -15,71 +18,121 @@ static const cv::Scalar kColors[] = {
 };
 static const char* kClassNames[] = {"golf_ball", "putter"};
 
+// Letterbox border value used by Ultralytics at training time.
+static constexpr int kLetterboxPad = 114;
+
+// ─── Image Transform ────────────────────────────────────────────────────────
+ImageTransform ImageTransform::stretch(int orig_w, int orig_h,
+                                       int net_w, int net_h) {
+    ImageTransform xf;
+    xf.scale_x = static_cast<float>(net_w) / orig_w;
+    xf.scale_y = static_cast<float>(net_h) / orig_h;
+    xf.content_w = net_w;
+    xf.content_h = net_h;
+    return xf;
+}
+
+ImageTransform ImageTransform::letterbox(int orig_w, int orig_h,
+                                         int net_w, int net_h) {
+    const float r = std::min(static_cast<float>(net_w) / orig_w,
+                             static_cast<float>(net_h) / orig_h);
+    ImageTransform xf;
+    xf.content_w = std::min(net_w, static_cast<int>(std::lround(orig_w * r)));
+    xf.content_h = std::min(net_h, static_cast<int>(std::lround(orig_h * r)));
+    xf.scale_x = static_cast<float>(xf.content_w) / orig_w;
+    xf.scale_y = static_cast<float>(xf.content_h) / orig_h;
+    xf.pad_x = static_cast<float>((net_w - xf.content_w) / 2);
+    xf.pad_y = static_cast<float>((net_h - xf.content_h) / 2);
+    return xf;
+}
+
 // ─── Open ───────────────────────────────────────────────────────────────────
-bool FramePipeline::open(const std::string& source) {
-    // Try to interpret as camera index
-    bool all_digits = !source.empty() &&
-        std::all_of(source.begin(), source.end(), ::isdigit);
-
-    if (all_digits) {
-        int cam_id = std::stoi(source);
-        cap_.open(cam_id);
-    } else {
-        cap_.open(source);
+bool FramePipeline::open(const std::string& source, const CaptureOptions& opts) {
+    const bool replay = is_recording(source);
+    backend_ = replay ? make_replay_capture() : make_capture_backend(opts.api);
+    if (!backend_ || !backend_->open(source, opts)) {
+        std::cerr << "[FramePipeline] Cannot open source: " << source << " ("
+                  << (replay ? "replay" : capture_api_name(opts.api)) << " backend)\n";
+        backend_.reset();
+        return false;
     }
+    return true;
+}
 
-    if (!cap_.isOpened()) {
-        std::cerr << "[FramePipeline] Cannot open source: " << source << "\n";
+bool FramePipeline::open(std::unique_ptr<CaptureBackend> backend, const std::string& source,
+                         const CaptureOptions& opts) {
+    backend_ = std::move(backend);
+    if (!backend_ || !backend_->open(source, opts)) {
+        std::cerr << "[FramePipeline] Cannot open source: " << source << " ("
+                  << (backend_ ? backend_->name() : "no") << " backend)\n";
+        backend_.reset();
         return false;
     }
-
-    // Force 1080p capture (avoids 4K overhead and fits 1080p displays)
-    cap_.set(cv::CAP_PROP_FRAME_WIDTH, 1920);
-    cap_.set(cv::CAP_PROP_FRAME_HEIGHT, 1080);
-
-    std::cout << "[FramePipeline] Opened: " << source
-              << " (" << static_cast<int>(cap_.get(cv::CAP_PROP_FRAME_WIDTH))
-              << "x" << static_cast<int>(cap_.get(cv::CAP_PROP_FRAME_HEIGHT))
-              << " @ " << cap_.get(cv::CAP_PROP_FPS) << " fps)\n";
     return true;
 }
 
 // ─── Read ───────────────────────────────────────────────────────────────────
 bool FramePipeline::read(cv::Mat& frame) {
-    return cap_.read(frame) && !frame.empty();
+    DeviceFrame device;
+    return read(frame, device);
+}
+
+bool FramePipeline::read(cv::Mat& frame, DeviceFrame& device) {
+    device = DeviceFrame();
+    return backend_ && backend_->read(frame, device);
 }
 
 // ─── Preprocess ─────────────────────────────────────────────────────────────
+namespace {
+
+// Resize target, kept per thread so steady-state frames reuse it
+thread_local cv::Mat t_resized;
+
+}  // namespace
+
 void FramePipeline::preprocess(const cv::Mat& frame, int net_h, int net_w,
-                               std::vector<float>& blob) {
-    cv::Mat resized;
-    cv::resize(frame, resized, cv::Size(net_w, net_h));
-
-    cv::Mat rgb;
-    cv::cvtColor(resized, rgb, cv::COLOR_BGR2RGB);
-
-    rgb.convertTo(rgb, CV_32F, 1.0 / 255.0);
-
-    // HWC → CHW
-    const int area = net_h * net_w;
-    blob.resize(3 * area);
-    const float* ptr = reinterpret_cast<const float*>(rgb.data);
-    for (int i = 0; i < area; ++i) {
-        blob[0 * area + i] = ptr[i * 3 + 0];  // R
-        blob[1 * area + i] = ptr[i * 3 + 1];  // G
-        blob[2 * area + i] = ptr[i * 3 + 2];  // B
+                               std::vector<float>& blob, bool letterbox) {
+    cv::Mat& resized = t_resized;
+    resized.create(net_h, net_w, CV_8UC3);
+    if (letterbox) {
+        auto xf = ImageTransform::letterbox(frame.cols, frame.rows, net_w, net_h);
+        resized.setTo(cv::Scalar(kLetterboxPad, kLetterboxPad, kLetterboxPad));
+        cv::Mat content = resized(cv::Rect(static_cast<int>(xf.pad_x),
+                                           static_cast<int>(xf.pad_y),
+                                           xf.content_w, xf.content_h));
+        cv::resize(frame, content, content.size());   // in place, no copy
+    } else {
+        cv::resize(frame, resized, cv::Size(net_w, net_h));
     }
+
+    // BGR HWC → RGB CHW, normalised, in one vectorised pass
+    blob.resize(3 * static_cast<size_t>(net_h) * net_w);
+    bgr_to_planar_rgb(resized, blob.data());
 }
 
 // ─── Parse Detections ───────────────────────────────────────────────────────
 std::vector<Detection> FramePipeline::parse_detections(
     const float* output, int num_dets, float conf_thresh,
     int orig_w, int orig_h, int net_w, int net_h)
+{
+    return parse_detections(output, num_dets, conf_thresh,
+                            ImageTransform::stretch(orig_w, orig_h, net_w, net_h));
+}
+
+std::vector<Detection> FramePipeline::parse_detections(
+    const float* output, int num_dets, float conf_thresh,
+    const ImageTransform& xf)
 {
     std::vector<Detection> dets;
+    parse_detections(output, num_dets, conf_thresh, xf, dets);
+    return dets;
+}
 
-    const float sx = static_cast<float>(orig_w) / net_w;
-    const float sy = static_cast<float>(orig_h) / net_h;
+void FramePipeline::parse_detections(
+    const float* output, int num_dets, float conf_thresh,
+    const ImageTransform& xf, std::vector<Detection>& dets)
+{
+    dets.clear();
 
     // YOLOv10 output: each row is [x1, y1, x2, y2, conf, class_id]
     for (int i = 0; i < num_dets; ++i) {
@@ -89,16 +142,15 @@ std::vector<Detection> FramePipeline::parse_detections(
         if (conf < conf_thresh) continue;
 
         Detection d;
-        d.x1 = row[0] * sx;
-        d.y1 = row[1] * sy;
-        d.x2 = row[2] * sx;
-        d.y2 = row[3] * sy;
+        d.x1 = xf.to_orig_x(row[0]);
+        d.y1 = xf.to_orig_y(row[1]);
+        d.x2 = xf.to_orig_x(row[2]);
+        d.y2 = xf.to_orig_y(row[3]);
         d.confidence = conf;
         d.class_id = static_cast<int>(row[5]);
 
         dets.push_back(d);
     }
-    return dets;
 }
 
 // ─── Draw ───────────────────────────────────────────────────────────────────
@@ -0,0 +1,62 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// frame_pool.cpp  –  Frame Context Recycling
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "frame_pool.h"
+
+namespace golf {
+
+FramePool::FramePool(size_t capacity, size_t blob_floats, size_t max_detections)
+    : capacity_(capacity), blob_floats_(blob_floats), max_detections_(max_detections) {
+    free_.reserve(capacity_);
+}
+
+FrameItem FramePool::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!free_.empty()) {
+            FrameItem item = std::move(free_.back());
+            free_.pop_back();
+            return item;
+        }
+        ++created_;
+    }
+    FrameItem item;
+    item.blob.reserve(blob_floats_);
+    item.detections.reserve(max_detections_);
+    return item;
+}
+
+void FramePool::release(FrameItem& item) {
+    item.device = DeviceFrame();          // let the decoder reuse its surface
+    if (item.frame.empty() && item.blob.capacity() == 0 &&
+        item.detections.capacity() == 0) {
+        return;
+    }
+
+    // Reset per-frame state outside the lock; buffers keep their capacity
+    item.seq = 0;
+    item.source_time = -1.0;
+    item.roi = cv::Rect();
+    item.transform = ImageTransform();
+    item.detections.clear();
+    item.gpu_decoded = false;
+    item.best_ball.reset();
+    item.best_putter.reset();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.size() < capacity_) {
+            free_.push_back(std::move(item));
+            return;
+        }
+    }
+    FrameItem discard = std::move(item);  // pool full: free it here
+}
+
+uint64_t FramePool::created() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return created_;
+}
+
+}  // namespace golf
@@ -0,0 +1,130 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// gpu_postprocess.cpp  –  Decode Kernel Dispatch & Result Unpacking
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "gpu_postprocess.h"
+
+#include <iostream>
+
+namespace golf {
+
+GpuPostprocessor::~GpuPostprocessor() {
+    release();
+}
+
+void GpuPostprocessor::release() {
+    if (d_params_)  { cudaFree(d_params_);      d_params_ = nullptr; }
+    if (h_params_)  { cudaFreeHost(h_params_);  h_params_ = nullptr; }
+    if (d_results_) { cudaFree(d_results_);     d_results_ = nullptr; }
+    if (h_results_) { cudaFreeHost(h_results_); h_results_ = nullptr; }
+    capacity_ = 0;
+}
+
+bool GpuPostprocessor::reserve(int images) {
+    if (images <= capacity_) return true;
+    release();
+    ++generation_;   // buffer addresses changed
+
+    if (cudaMalloc(&d_params_, images * sizeof(DecodeParams)) != cudaSuccess ||
+        cudaMalloc(&d_results_, images * sizeof(CompactDetections)) != cudaSuccess) {
+        std::cerr << "[GpuPostprocessor] CUDA malloc failed\n";
+        return false;
+    }
+    if (cudaHostAlloc(&h_params_, images * sizeof(DecodeParams),
+                      cudaHostAllocWriteCombined) != cudaSuccess ||
+        cudaHostAlloc(&h_results_, images * sizeof(CompactDetections),
+                      cudaHostAllocDefault) != cudaSuccess) {
+        std::cerr << "[GpuPostprocessor] Pinned host alloc failed\n";
+        return false;
+    }
+    capacity_ = images;
+    return true;
+}
+
+bool GpuPostprocessor::stage(int index, const ImageTransform& xf,
+                             float conf_thresh) {
+    if (index < 0 || index >= batch_) {
+        std::cerr << "[GpuPostprocessor] Image " << index
+                  << " outside batch of " << batch_ << "\n";
+        return false;
+    }
+    DecodeParams p;
+    p.scale_x = xf.scale_x;
+    p.scale_y = xf.scale_y;
+    p.pad_x = xf.pad_x;
+    p.pad_y = xf.pad_y;
+    p.offset_x = xf.offset_x;
+    p.offset_y = xf.offset_y;
+    p.conf_thresh = conf_thresh;
+    h_params_[index] = p;
+    return true;
+}
+
+bool GpuPostprocessor::set_batch(int images) {
+    if (!reserve(images)) return false;
+    batch_ = images;   // the launch takes its image count from TrtEngine
+    return true;
+}
+
+bool GpuPostprocessor::enqueue(const float* d_output, int images,
+                               int output_length, cudaStream_t stream) {
+    if (images > batch_) {
+        std::cerr << "[GpuPostprocessor] " << images << " images but only "
+                  << batch_ << " staged\n";
+        return false;
+    }
+
+    if (cudaMemcpyAsync(d_params_, h_params_, images * sizeof(DecodeParams),
+                        cudaMemcpyHostToDevice, stream) != cudaSuccess) {
+        std::cerr << "[GpuPostprocessor] H2D copy failed\n";
+        return false;
+    }
+
+    cudaError_t err = launch_decode_detections(
+        d_output, output_length / 6, output_length, images,
+        d_params_, d_results_, stream);
+    if (err != cudaSuccess) {
+        std::cerr << "[GpuPostprocessor] Kernel launch failed: "
+                  << cudaGetErrorString(err) << "\n";
+        return false;
+    }
+
+    // Device → Host: only the compacted results
+    if (cudaMemcpyAsync(h_results_, d_results_, images * sizeof(CompactDetections),
+                        cudaMemcpyDeviceToHost, stream) != cudaSuccess) {
+        std::cerr << "[GpuPostprocessor] D2H copy failed\n";
+        return false;
+    }
+    return true;
+}
+
+// ─── Result unpacking ───────────────────────────────────────────────────────
+static Detection to_detection(const CompactDetection& c) {
+    Detection d;
+    d.class_id = c.class_id;
+    d.confidence = c.confidence;
+    d.x1 = c.x1;
+    d.y1 = c.y1;
+    d.x2 = c.x2;
+    d.y2 = c.y2;
+    return d;
+}
+
+void GpuPostprocessor::to_detections(const CompactDetections& r,
+                                     std::vector<Detection>& dets) {
+    dets.clear();
+    for (int i = 0; i < r.count; ++i) {
+        dets.push_back(to_detection(r.dets[i]));
+    }
+}
+
+bool GpuPostprocessor::best(const CompactDetections& r, int class_id,
+                            Detection& det) {
+    if (class_id < 0 || class_id >= kNumClasses) return false;
+    const CompactDetection& c = r.best[class_id];
+    if (c.class_id != class_id) return false;
+    det = to_detection(c);
+    return true;
+}
+
+}  // namespace golf
@@ -0,0 +1,173 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// gpu_preprocess.cpp  –  Frame Upload & Kernel Dispatch
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "gpu_preprocess.h"
+
+#include <iostream>
+
+namespace golf {
+
+GpuPreprocessor::~GpuPreprocessor() {
+    for (Image& img : images_) {
+        if (img.d_frame) cudaFree(img.d_frame);
+        if (img.h_frame) cudaFreeHost(img.h_frame);
+    }
+}
+
+bool GpuPreprocessor::reserve(Image& img, size_t bytes) {
+    if (bytes <= img.bytes) return true;
+    if (img.d_frame) cudaFree(img.d_frame);
+    if (img.h_frame) cudaFreeHost(img.h_frame);
+    img.d_frame = nullptr;
+    img.h_frame = nullptr;
+    img.bytes = 0;
+    if (cudaMalloc(&img.d_frame, bytes) != cudaSuccess) {
+        std::cerr << "[GpuPreprocessor] CUDA malloc failed for frame\n";
+        return false;
+    }
+    if (cudaHostAlloc(&img.h_frame, bytes, cudaHostAllocWriteCombined) != cudaSuccess) {
+        std::cerr << "[GpuPreprocessor] Pinned host alloc failed for frame\n";
+        return false;
+    }
+    img.bytes = bytes;
+    return true;
+}
+
+bool GpuPreprocessor::run(const cv::Mat& frame, float* d_dst,
+                          int net_h, int net_w, const ImageTransform& xf,
+                          cudaStream_t stream) {
+    if (!stage(0, frame, d_dst, net_h, net_w, xf)) return false;
+    set_batch(1);
+    return enqueue(stream);
+}
+
+bool GpuPreprocessor::stage(int index, const cv::Mat& frame, float* d_dst,
+                            int net_h, int net_w, const ImageTransform& xf) {
+    if (frame.type() != CV_8UC3) {
+        std::cerr << "[GpuPreprocessor] Expected 8-bit BGR frame\n";
+        return false;
+    }
+    if (index >= static_cast<int>(images_.size())) {
+        images_.resize(index + 1);
+    }
+    Image& img = images_[index];
+
+    const size_t row_bytes = static_cast<size_t>(frame.cols) * 3;
+    if (!reserve(img, row_bytes * frame.rows)) return false;
+
+    // Pack into pinned memory (also flattens non-continuous ROIs)
+    cv::Mat staged(frame.rows, frame.cols, CV_8UC3, img.h_frame, row_bytes);
+    frame.copyTo(staged);
+
+    latch(img, frame.cols, frame.rows, 3, false, d_dst, net_h, net_w, xf);
+    return true;
+}
+
+bool GpuPreprocessor::stage_device(int index, const DeviceFrame& src,
+                                   float* d_dst, int net_h, int net_w,
+                                   const ImageTransform& xf,
+                                   cudaStream_t stream) {
+    if (!src || (src.channels != 3 && src.channels != 4)) {
+        std::cerr << "[GpuPreprocessor] Expected 8-bit BGR/BGRA device frame\n";
+        return false;
+    }
+    if (index >= static_cast<int>(images_.size())) {
+        images_.resize(index + 1);
+    }
+    Image& img = images_[index];
+
+    const size_t row_bytes = static_cast<size_t>(src.width) * src.channels;
+    if (!reserve(img, row_bytes * src.height)) return false;
+
+    // Device → Device, packing the (possibly cropped) surface once the
+    // decoder has written it
+    if (src.ready && cudaStreamWaitEvent(stream, src.ready, 0) != cudaSuccess) {
+        std::cerr << "[GpuPreprocessor] Waiting for the decoded frame failed\n";
+        return false;
+    }
+    if (cudaMemcpy2DAsync(img.d_frame, row_bytes, src.data, src.pitch,
+                          row_bytes, src.height, cudaMemcpyDeviceToDevice,
+                          stream) != cudaSuccess) {
+        std::cerr << "[GpuPreprocessor] D2D copy failed\n";
+        return false;
+    }
+
+    latch(img, src.width, src.height, src.channels, true, d_dst, net_h, net_w, xf);
+    return true;
+}
+
+void GpuPreprocessor::latch(Image& img, int src_w, int src_h, int channels,
+                            bool on_device, float* d_dst, int net_h, int net_w,
+                            const ImageTransform& xf) {
+    PreprocessParams p;
+    p.scale_x = xf.scale_x;
+    p.scale_y = xf.scale_y;
+    p.pad_x = static_cast<int>(xf.pad_x);
+    p.pad_y = static_cast<int>(xf.pad_y);
+    p.content_w = xf.content_w;
+    p.content_h = xf.content_h;
+    p.src_channels = channels;
+
+    img.src_w = src_w;
+    img.src_h = src_h;
+    img.on_device = on_device;
+    img.net_w = net_w;
+    img.net_h = net_h;
+    img.d_dst = d_dst;
+    img.params = p;
+}
+
+void GpuPreprocessor::set_batch(int images) {
+    batch_ = images;
+}
+
+// FNV-1a over everything enqueue() bakes into a launch.
+uint64_t GpuPreprocessor::generation() const {
+    static_assert(sizeof(PreprocessParams) == 8 * sizeof(int32_t),
+                  "PreprocessParams hashed as raw bytes (no padding)");
+    uint64_t h = 14695981039346656037ull;
+    auto mix = [&h](const void* data, size_t n) {
+        const auto* b = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < n; ++i) h = (h ^ b[i]) * 1099511628211ull;
+    };
+    mix(&batch_, sizeof(batch_));
+    for (int i = 0; i < batch_; ++i) {
+        const Image& img = images_[i];
+        const int32_t dims[5] = {img.src_w, img.src_h, img.net_w, img.net_h,
+                                 img.on_device ? 1 : 0};
+        const void* ptrs[3] = {img.d_frame, img.h_frame, img.d_dst};
+        mix(dims, sizeof(dims));
+        mix(ptrs, sizeof(ptrs));
+        mix(&img.params, sizeof(img.params));
+    }
+    return h;
+}
+
+bool GpuPreprocessor::enqueue(cudaStream_t stream) {
+    for (int i = 0; i < batch_; ++i) {
+        const Image& img = images_[i];
+        const size_t row_bytes =
+            static_cast<size_t>(img.src_w) * img.params.src_channels;
+
+        // Host → Device (raw 8-bit)
+        if (!img.on_device &&
+            cudaMemcpyAsync(img.d_frame, img.h_frame, row_bytes * img.src_h,
+                            cudaMemcpyHostToDevice, stream) != cudaSuccess) {
+            std::cerr << "[GpuPreprocessor] H2D copy failed\n";
+            return false;
+        }
+
+        cudaError_t err = launch_preprocess_bgr8(
+            img.d_frame, img.src_w, img.src_h, row_bytes,
+            img.d_dst, img.net_w, img.net_h, img.params, stream);
+        if (err != cudaSuccess) {
+            std::cerr << "[GpuPreprocessor] Kernel launch failed: "
+                      << cudaGetErrorString(err) << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace golf
@@ -0,0 +1,92 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// kalman_tracker.cpp  –  Constant-velocity Kalman Filter
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "kalman_tracker.h"
+
+#include <algorithm>
+
+namespace golf {
+
+namespace {
+constexpr double kInitVelVar = 4e6;      // (2000 px/s)² – velocity unknown
+constexpr float  kMinConfidence = 0.05f;
+}  // namespace
+
+KalmanTracker::KalmanTracker(const KalmanOptions& opts) : opts_(opts) {}
+
+double KalmanTracker::noise(float confidence) const {
+    return opts_.measurement_noise / std::max(confidence, kMinConfidence);
+}
+
+void KalmanTracker::reset(float x, float y, float confidence) {
+    const double r = noise(confidence);
+    for (Axis* a : {&x_, &y_}) {
+        a->vel = 0.0;
+        a->p00 = r;
+        a->p01 = 0.0;
+        a->p11 = kInitVelVar;
+    }
+    x_.pos = x_.last_z = x;
+    y_.pos = y_.last_z = y;
+    since_fix_ = 0.0;
+}
+
+void KalmanTracker::predict(double dt) {
+    if (dt <= 0.0) return;
+    x_.predict(dt, opts_.process_noise);
+    y_.predict(dt, opts_.process_noise);
+    since_fix_ += dt;
+}
+
+void KalmanTracker::correct(float x, float y, float confidence) {
+    const double r = noise(confidence);
+    const double ix = x - x_.pos, sx = x_.p00 + r;
+    const double iy = y - y_.pos, sy = y_.p00 + r;
+
+    if (since_fix_ > 0.0 && ix * ix / sx + iy * iy / sy > opts_.gate) {
+        // Manoeuvre: two-point re-initialisation
+        x_.reinit(x, since_fix_, r);
+        y_.reinit(y, since_fix_, r);
+    } else {
+        x_.correct(x, r);
+        y_.correct(y, r);
+    }
+    x_.last_z = x;
+    y_.last_z = y;
+    since_fix_ = 0.0;
+}
+
+// ─── Per-axis algebra ───────────────────────────────────────────────────────
+// F = [1 dt; 0 1],  Q = q · [dt³/3 dt²/2; dt²/2 dt],  H = [1 0]
+void KalmanTracker::Axis::predict(double dt, double q) {
+    pos += vel * dt;
+    const double dt2 = dt * dt;
+    p00 += dt * 2.0 * p01 + dt2 * p11 + q * dt2 * dt / 3.0;
+    p01 += dt * p11 + q * dt2 / 2.0;
+    p11 += q * dt;
+}
+
+void KalmanTracker::Axis::correct(double z, double r) {
+    const double s = p00 + r;
+    const double k0 = p00 / s;
+    const double k1 = p01 / s;
+    const double innov = z - pos;
+    pos += k0 * innov;
+    vel += k1 * innov;
+
+    const double old00 = p00, old01 = p01;
+    p00 = (1.0 - k0) * old00;
+    p01 = (1.0 - k0) * old01;
+    p11 -= k1 * old01;
+}
+
+void KalmanTracker::Axis::reinit(double z, double dt, double r) {
+    pos = z;
+    vel = (z - last_z) / dt;
+    p00 = r;
+    p01 = r / dt;
+    p11 = 2.0 * r / (dt * dt);
+}
+
+}  // namespace golf
@@ -0,0 +1,156 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// latency_metrics.cpp  –  Histogram Buckets, Percentiles & Exposition
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "latency_metrics.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+namespace golf {
+
+// ─── Histogram ──────────────────────────────────────────────────────────────
+// Values below kSub ns get one bucket each; above that every power of two
+// [2^m, 2^(m+1)) is split into kSub equal buckets.
+int LatencyHistogram::bucket_of(uint64_t ns) {
+    if (ns < static_cast<uint64_t>(kSub)) return static_cast<int>(ns);
+    const int msb = 63 - __builtin_clzll(ns);
+    const int shift = msb - kSubBits;
+    const int sub = static_cast<int>((ns >> shift) & (kSub - 1));
+    return kSub + shift * kSub + sub;
+}
+
+uint64_t LatencyHistogram::bucket_upper(int idx) {
+    if (idx < kSub) return static_cast<uint64_t>(idx);
+    const int shift = (idx - kSub) / kSub;
+    const uint64_t sub = static_cast<uint64_t>((idx - kSub) % kSub);
+    const uint64_t low = (static_cast<uint64_t>(kSub) + sub) << shift;
+    return low + ((uint64_t{1} << shift) - 1);
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds d) {
+    const uint64_t ns = d.count() > 0 ? static_cast<uint64_t>(d.count()) : 0;
+    buckets_[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t prev = max_ns_.load(std::memory_order_relaxed);
+    while (ns > prev &&
+           !max_ns_.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::record_ms(double ms) {
+    record(std::chrono::nanoseconds(static_cast<int64_t>(ms * 1e6)));
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    uint64_t counts[kNumBuckets];
+    uint64_t total = 0;
+    for (int i = 0; i < kNumBuckets; ++i) {
+        counts[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    Snapshot s;
+    s.count = total;
+    if (total == 0) return s;
+
+    const uint64_t max_ns = max_ns_.load(std::memory_order_relaxed);
+    const double sum_ns = static_cast<double>(sum_ns_.load(std::memory_order_relaxed));
+    s.sum_ms = sum_ns * 1e-6;
+    s.mean_ms = s.sum_ms / static_cast<double>(total);
+    s.max_ms = static_cast<double>(max_ns) * 1e-6;
+
+    // Report each percentile as its bucket's upper edge (never above max)
+    auto percentile = [&](double q) {
+        const uint64_t rank = std::max<uint64_t>(
+            1, static_cast<uint64_t>(q * static_cast<double>(total) + 0.5));
+        uint64_t seen = 0;
+        for (int i = 0; i < kNumBuckets; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return static_cast<double>(std::min(bucket_upper(i), max_ns)) * 1e-6;
+            }
+        }
+        return s.max_ms;
+    };
+    s.p50_ms = percentile(0.50);
+    s.p95_ms = percentile(0.95);
+    s.p99_ms = percentile(0.99);
+    return s;
+}
+
+// ─── Stage names ────────────────────────────────────────────────────────────
+const char* stage_name(Stage s) {
+    switch (s) {
+        case Stage::CAPTURE:      return "capture";
+        case Stage::PREPROCESS:   return "preprocess";
+        case Stage::H2D:          return "h2d";
+        case Stage::INFER:        return "infer";
+        case Stage::D2H:          return "d2h";
+        case Stage::GPU_TOTAL:    return "gpu_total";
+        case Stage::PARSE:        return "parse";
+        case Stage::TRACK:        return "track";
+        case Stage::STATS:        return "stats";
+        case Stage::SEND:         return "send";
+        case Stage::GLASS_TO_UDP: return "glass_to_udp";
+        case Stage::kCount:       break;
+    }
+    return "?";
+}
+
+// ─── Exposition ─────────────────────────────────────────────────────────────
+std::string LatencyMetrics::to_json() const {
+    std::string out = "{\"stages\":{";
+    char buf[256];
+    for (int i = 0; i < static_cast<int>(Stage::kCount); ++i) {
+        const Stage st = static_cast<Stage>(i);
+        const auto s = snapshot(st);
+        std::snprintf(buf, sizeof(buf),
+            "%s\"%s\":{\"count\":%" PRIu64 ",\"mean_ms\":%.4f,"
+            "\"p50_ms\":%.4f,\"p95_ms\":%.4f,\"p99_ms\":%.4f,\"max_ms\":%.4f}",
+            i ? "," : "", stage_name(st), s.count, s.mean_ms,
+            s.p50_ms, s.p95_ms, s.p99_ms, s.max_ms);
+        out += buf;
+    }
+    out += "}}";
+    return out;
+}
+
+std::string LatencyMetrics::to_prometheus() const {
+    std::string out =
+        "# HELP golf_stage_latency_seconds Per-stage pipeline latency.\n"
+        "# TYPE golf_stage_latency_seconds summary\n";
+    std::string max_out =
+        "# HELP golf_stage_latency_max_seconds Largest latency seen per stage.\n"
+        "# TYPE golf_stage_latency_max_seconds gauge\n";
+
+    char buf[256];
+    for (int i = 0; i < static_cast<int>(Stage::kCount); ++i) {
+        const Stage st = static_cast<Stage>(i);
+        const char* name = stage_name(st);
+        const auto s = snapshot(st);
+        const std::pair<const char*, double> quantiles[] = {
+            {"0.5", s.p50_ms}, {"0.95", s.p95_ms}, {"0.99", s.p99_ms}};
+        for (const auto& [q, v] : quantiles) {
+            std::snprintf(buf, sizeof(buf),
+                "golf_stage_latency_seconds{stage=\"%s\",quantile=\"%s\"} %.9f\n",
+                name, q, v * 1e-3);
+            out += buf;
+        }
+        std::snprintf(buf, sizeof(buf),
+            "golf_stage_latency_seconds_sum{stage=\"%s\"} %.9f\n"
+            "golf_stage_latency_seconds_count{stage=\"%s\"} %" PRIu64 "\n",
+            name, s.sum_ms * 1e-3, name, s.count);
+        out += buf;
+        std::snprintf(buf, sizeof(buf),
+            "golf_stage_latency_max_seconds{stage=\"%s\"} %.9f\n",
+            name, s.max_ms * 1e-3);
+        max_out += buf;
+    }
+    return out + max_out;
+}
+
+}  // namespace golf
@@ -3,36 +3,77 @@
 //
 // Brings together all components:
 //   1. Load TensorRT engine
-//   2. Capture frames from OpenCV
-//   3. Run inference and parse detections
+//   2. Capture frames from OpenCV             (capture thread)
+//   3. Pre-process, run inference and parse   (preprocess / inference threads)
 //   4. Track ball & putter
 //   5. Compute putt statistics
 //   6. Send results to Unreal Engine over UDP
 //   7. Expose stats via REST API
 // ─────────────────────────────────────────────────────────────────────────────
 
+#include "engine_pool.h"
 #include "trt_engine.h"
 #include "frame_pipeline.h"
+#include "cpu_preprocess.h"
 #include "tracker.h"
+#include "multi_tracker.h"
 #include "putt_stats.h"
 #include "unreal_sender.h"
+#include "unreal_events.h"
+#include "output_scheduler.h"
+#include "preview_window.h"
+#include "recording.h"
+#include "runtime_config.h"
+#include "video_stream.h"
 #include "stats_api.h"
+#include "staged_pipeline.h"
+#include "latency_metrics.h"
+
+#include <sys/stat.h>
 
 #include <algorithm>
 #include <chrono>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <string>
 #include <vector>
 
 struct Config {
     std::string engine_path;
-    std::string video_source = "0";          // camera index or file path
+    golf::BuildOptions build;                // when engine_path is an .onnx model
+    golf::EnginePoolOptions engines;         // GPUs and contexts per GPU
+    std::vector<std::string> video_sources;  // camera indices / file paths
     std::string unreal_host  = "127.0.0.1";
     uint16_t    unreal_port  = 7001;
+    uint16_t    event_port   = 0;            // 0: no TCP putt event channel
+    bool        udp_stats    = false;        // keep stats in UDP with an event channel
     uint16_t    api_port     = 8080;
-    float       conf_thresh  = 0.5f;
+    std::string api_token;                   // empty: POST /api/config from localhost only
+    double      stream_hz    = 10.0;
+    std::string history_dir;                 // empty: history kept in memory
+    golf::SenderOptions   sender;
+    double      send_hz      = 0.0;          // 0: one state per processed frame
+    double      max_predict_s = 0.1;
+    golf::TrackerOptions  tracker;
+    std::string config_path;                 // empty: tuning from flags only
+    bool        multi_ball   = false;
+    double      idle_fps     = 0.0;          // 0: always infer every frame
+    golf::GovernorOptions governor;
     bool        show_gui     = true;
+    golf::PreviewOptions  preview;
+    double      video_fps    = 0.0;          // 0: no /api/video stream
+    std::string record_path;                 // empty: no recording
+    golf::RecordingWriter::Options record;
+    golf::VideoStreamOptions video;
+    bool        cuda_graph   = false;
+    golf::CpuKernel cpu_kernel = golf::CpuKernel::AUTO;
+    golf::CaptureOptions  capture;
+    golf::PipelineOptions pipeline;
+    bool        drop_policy_set = false;     // --drop-policy given explicitly
 };
 
 static void print_usage(const char* prog) {
@@ -40,15 +81,80 @@ static void print_usage(const char* prog) {
         << "Usage: " << prog << " [OPTIONS]\n"
         << "\n"
         << "Required:\n"
-        << "  --engine PATH        Path to TensorRT .engine file\n"
+        << "  --engine PATH        TensorRT .engine file, or an .onnx model to build\n"
+        << "                       (and cache) an engine for this GPU\n"
         << "\n"
         << "Optional:\n"
-        << "  --source SRC         Video source: camera id or file path (default: 0)\n"
+        << "  --precision P        ONNX build: fp32 | fp16 | int8 (default: fp16)\n"
+        << "  --calib-images DIR   INT8 calibration frames (default: data/images)\n"
+        << "  --engine-cache DIR   Built engines (default: next to the model)\n"
+        << "  --gpus LIST          CUDA devices to run inference on, e.g. 0,1\n"
+        << "                       (default: the current device)\n"
+        << "  --contexts N         Execution contexts per GPU (default: 2)\n"
+        << "  --source SRC         Video source: camera id or file path (default: 0);\n"
+        << "                       repeat or comma-separate for several bays\n"
+        << "  --capture API        Capture backend: opencv | gstreamer | v4l2 | nvdec\n"
+        << "                       (default: opencv)\n"
+        << "  --capture-size WxH   Requested capture size (default: 1920x1080)\n"
+        << "  --capture-fps FPS    Requested capture frame rate (default: device)\n"
+        << "  --replay-speed X     .golfrec sources: recorded timing scaled by X,\n"
+        << "                       0 = as fast as possible (default: 1)\n"
+        << "  --pixel-format CC    V4L2 FOURCC: MJPG | YUYV | UYVY | NV12 | BGR3\n"
+        << "                       (default: MJPG)\n"
         << "  --host HOST          Unreal Engine UDP host (default: 127.0.0.1)\n"
         << "  --port PORT          Unreal Engine UDP port (default: 7001)\n"
+        << "  --protocol P         UDP encoding: json | binary (default: json)\n"
+        << "  --send-policy P      every | delta: skip unchanged idle frames\n"
+        << "                       (default: delta)\n"
+        << "  --idle-hz HZ         Delta: max rate while only positions drift\n"
+        << "                       (default: 10)\n"
+        << "  --keyframe-ms MS     Delta: resend unchanged state every MS (default: 1000)\n"
+        << "  --send-hz HZ         Send at a fixed rate, predicting between frames\n"
+        << "                       (default: 0 = once per processed frame)\n"
+        << "  --predict-ms MS      Longest extrapolation past a frame (default: 100)\n"
+        << "  --event-port PORT    Serve putt start / stop / result events and history\n"
+        << "                       sync to Unreal over TCP; UDP then carries only\n"
+        << "                       ball and putter (default: 0 = off)\n"
+        << "  --udp-stats          Keep the putt stats in UDP with --event-port\n"
         << "  --api-port PORT      REST API port for stats (default: 8080)\n"
+        << "  --api-token TOKEN    Accept POST /api/config from other hosts with\n"
+        << "                       \"Authorization: Bearer TOKEN\" (default: localhost only)\n"
+        << "  --stream-hz HZ       Live update rate on /api/stats/stream (default: 10)\n"
+        << "  --history-dir DIR    Persist putt history to DIR/bay<N>.putts and resume\n"
+        << "                       it on restart (default: in memory only)\n"
         << "  --conf THRESH        Detection confidence threshold (default: 0.5)\n"
+        << "  --tracker MODEL      Motion model: ema | kalman (default: ema)\n"
+        << "  --process-noise Q    Kalman acceleration noise, px^2/s^3 (default: 1e5)\n"
+        << "  --measurement-noise R  Kalman detection noise, px^2 (default: 2)\n"
+        << "  --multi-ball         Track every ball with its own id and putt state\n"
+        << "  --config PATH        YAML / JSON tuning (thresholds, tracker, putt\n"
+        << "                       detection, per-bay overrides) over the flags above;\n"
+        << "                       retune at run time with POST /api/config\n"
+        << "  --idle-fps FPS       Infer at FPS while a bay is idle, full rate on\n"
+        << "                       motion / putter near the ball (default: 0 = off)\n"
+        << "  --idle-hold-ms MS    Quiet time before a bay idles (default: 2000)\n"
+        << "  --record PATH        Record frames, timestamps, detections and tracker\n"
+        << "                       state to PATH (.golfrec; one file per bay)\n"
+        << "  --record-format F    Recorded images: jpeg | raw (default: jpeg)\n"
+        << "  --record-quality Q   JPEG quality of recorded images (default: 95)\n"
         << "  --no-gui             Disable OpenCV preview window\n"
+        << "  --gui-fps FPS        Preview render rate (default: 60)\n"
+        << "  --gui-scale S        Render the preview downscaled by S (default: 1)\n"
+        << "  --video-fps FPS      Serve an annotated MJPEG stream on /api/video at\n"
+        << "                       FPS while someone watches (default: 0 = off)\n"
+        << "  --video-width W      MJPEG stream width, px (default: 640)\n"
+        << "  --video-quality Q    MJPEG JPEG quality 1-100 (default: 70)\n"
+        << "  --drop-policy P      Stage back-pressure: latest | block (default: latest;\n"
+        << "                       block when replaying a .golfrec)\n"
+        << "  --queue-depth N      Frames buffered between stages (default: 2)\n"
+        << "  --preprocess MODE    Pre-processing on gpu | cpu (default: gpu)\n"
+        << "  --cpu-kernel K       CPU pre-processing: auto | scalar | avx2 | neon\n"
+        << "                       (default: auto = best this CPU supports)\n"
+        << "  --postprocess MODE   Detection decoding on gpu | cpu (default: gpu)\n"
+        << "  --letterbox          Keep aspect ratio when resizing (pad with grey)\n"
+        << "  --roi                Crop around the tracked ball at native resolution\n"
+        << "  --roi-full-every N   Full-frame detection every N crops (default: 10)\n"
+        << "  --cuda-graph         Replay inference as a captured CUDA graph\n"
         << "  -h, --help           Show this help\n";
 }
 
@@ -58,18 +164,184 @@ static Config parse_args(int argc, char** argv) {
         std::string arg = argv[i];
         if ((arg == "--engine") && i + 1 < argc) {
             cfg.engine_path = argv[++i];
+        } else if ((arg == "--precision") && i + 1 < argc) {
+            std::string p = argv[++i];
+            if (!golf::parse_precision(p, cfg.build.precision)) {
+                std::cerr << "Unknown precision: " << p << "\n";
+                std::exit(1);
+            }
+        } else if ((arg == "--calib-images") && i + 1 < argc) {
+            cfg.build.calib_dir = argv[++i];
+        } else if ((arg == "--engine-cache") && i + 1 < argc) {
+            cfg.build.cache_dir = argv[++i];
+        } else if ((arg == "--gpus") && i + 1 < argc) {
+            std::stringstream list(argv[++i]);
+            std::string dev;
+            while (std::getline(list, dev, ',')) {
+                if (!dev.empty()) cfg.engines.devices.push_back(std::stoi(dev));
+            }
+        } else if ((arg == "--contexts") && i + 1 < argc) {
+            cfg.engines.contexts = std::clamp(std::stoi(argv[++i]), 1,
+                                              golf::TrtEngine::kMaxSlots);
         } else if ((arg == "--source") && i + 1 < argc) {
-            cfg.video_source = argv[++i];
+            std::stringstream list(argv[++i]);
+            std::string src;
+            while (std::getline(list, src, ',')) {
+                if (!src.empty()) cfg.video_sources.push_back(src);
+            }
+        } else if ((arg == "--capture") && i + 1 < argc) {
+            std::string api = argv[++i];
+            if (!golf::parse_capture_api(api, cfg.capture.api)) {
+                std::cerr << "Unknown capture backend: " << api << "\n";
+                std::exit(1);
+            }
+        } else if ((arg == "--capture-size") && i + 1 < argc) {
+            std::string size = argv[++i];
+            if (std::sscanf(size.c_str(), "%dx%d", &cfg.capture.width,
+                            &cfg.capture.height) != 2) {
+                std::cerr << "Bad capture size (expected WxH): " << size << "\n";
+                std::exit(1);
+            }
+        } else if ((arg == "--capture-fps") && i + 1 < argc) {
+            cfg.capture.fps = std::stod(argv[++i]);
+        } else if ((arg == "--pixel-format") && i + 1 < argc) {
+            cfg.capture.pixel_format = argv[++i];
         } else if ((arg == "--host") && i + 1 < argc) {
             cfg.unreal_host = argv[++i];
         } else if ((arg == "--port") && i + 1 < argc) {
             cfg.unreal_port = static_cast<uint16_t>(std::stoi(argv[++i]));
+        } else if ((arg == "--protocol") && i + 1 < argc) {
+            std::string p = argv[++i];
+            if (!golf::parse_wire_protocol(p, cfg.sender.protocol)) {
+                std::cerr << "Unknown protocol: " << p << "\n";
+                std::exit(1);
+            }
+        } else if ((arg == "--send-policy") && i + 1 < argc) {
+            std::string p = argv[++i];
+            if (p == "every") {
+                cfg.sender.policy = golf::SendPolicy::EVERY_FRAME;
+            } else if (p == "delta") {
+                cfg.sender.policy = golf::SendPolicy::DELTA;
+            } else {
+                std::cerr << "Unknown send policy: " << p << "\n";
+                std::exit(1);
+            }
+        } else if ((arg == "--idle-hz") && i + 1 < argc) {
+            cfg.sender.idle_hz = std::stod(argv[++i]);
+        } else if ((arg == "--keyframe-ms") && i + 1 < argc) {
+            cfg.sender.keyframe_s = std::stod(argv[++i]) / 1000.0;
+        } else if ((arg == "--send-hz") && i + 1 < argc) {
+            cfg.send_hz = std::stod(argv[++i]);
+        } else if ((arg == "--predict-ms") && i + 1 < argc) {
+            cfg.max_predict_s = std::stod(argv[++i]) / 1000.0;
+        } else if ((arg == "--event-port") && i + 1 < argc) {
+            cfg.event_port = static_cast<uint16_t>(std::stoi(argv[++i]));
+        } else if (arg == "--udp-stats") {
+            cfg.udp_stats = true;
         } else if ((arg == "--api-port") && i + 1 < argc) {
             cfg.api_port = static_cast<uint16_t>(std::stoi(argv[++i]));
+        } else if ((arg == "--api-token") && i + 1 < argc) {
+            cfg.api_token = argv[++i];
+        } else if ((arg == "--stream-hz") && i + 1 < argc) {
+            cfg.stream_hz = std::stod(argv[++i]);
+        } else if ((arg == "--history-dir") && i + 1 < argc) {
+            cfg.history_dir = argv[++i];
+        } else if ((arg == "--config") && i + 1 < argc) {
+            cfg.config_path = argv[++i];
         } else if ((arg == "--conf") && i + 1 < argc) {
-            cfg.conf_thresh = std::stof(argv[++i]);
+            cfg.pipeline.conf_thresh = std::stof(argv[++i]);
+        } else if ((arg == "--tracker") && i + 1 < argc) {
+            std::string m = argv[++i];
+            if (!golf::parse_tracker_model(m, cfg.tracker.model)) {
+                std::cerr << "Unknown tracker model: " << m << "\n";
+                std::exit(1);
+            }
+        } else if ((arg == "--process-noise") && i + 1 < argc) {
+            cfg.tracker.kalman.process_noise = std::stof(argv[++i]);
+        } else if ((arg == "--measurement-noise") && i + 1 < argc) {
+            cfg.tracker.kalman.measurement_noise = std::stof(argv[++i]);
+        } else if ((arg == "--idle-fps") && i + 1 < argc) {
+            cfg.idle_fps = std::stod(argv[++i]);
+        } else if ((arg == "--idle-hold-ms") && i + 1 < argc) {
+            cfg.governor.hold_s = std::stod(argv[++i]) / 1000.0;
+        } else if (arg == "--multi-ball") {
+            cfg.multi_ball = true;
+        } else if ((arg == "--replay-speed") && i + 1 < argc) {
+            cfg.capture.replay_speed = std::stod(argv[++i]);
+        } else if ((arg == "--record") && i + 1 < argc) {
+            cfg.record_path = argv[++i];
+        } else if ((arg == "--record-format") && i + 1 < argc) {
+            std::string f = argv[++i];
+            if (!golf::parse_frame_encoding(f, cfg.record.encoding)) {
+                std::cerr << "Unknown record format: " << f << "\n";
+                std::exit(1);
+            }
+        } else if ((arg == "--record-quality") && i + 1 < argc) {
+            cfg.record.quality = std::stoi(argv[++i]);
         } else if (arg == "--no-gui") {
             cfg.show_gui = false;
+        } else if ((arg == "--gui-fps") && i + 1 < argc) {
+            cfg.preview.fps = std::stod(argv[++i]);
+        } else if ((arg == "--gui-scale") && i + 1 < argc) {
+            cfg.preview.scale = std::stod(argv[++i]);
+        } else if ((arg == "--video-fps") && i + 1 < argc) {
+            cfg.video_fps = std::stod(argv[++i]);
+        } else if ((arg == "--video-width") && i + 1 < argc) {
+            cfg.video.width = std::stoi(argv[++i]);
+        } else if ((arg == "--video-quality") && i + 1 < argc) {
+            cfg.video.quality = std::stoi(argv[++i]);
+        } else if ((arg == "--drop-policy") && i + 1 < argc) {
+            std::string p = argv[++i];
+            cfg.drop_policy_set = true;
+            if (p == "latest") {
+                cfg.pipeline.drop_policy = golf::DropPolicy::LATEST;
+            } else if (p == "block") {
+                cfg.pipeline.drop_policy = golf::DropPolicy::BLOCK;
+            } else {
+                std::cerr << "Unknown drop policy: " << p << "\n";
+                std::exit(1);
+            }
+        } else if ((arg == "--queue-depth") && i + 1 < argc) {
+            cfg.pipeline.queue_depth = static_cast<size_t>(std::stoi(argv[++i]));
+        } else if ((arg == "--preprocess") && i + 1 < argc) {
+            std::string p = argv[++i];
+            if (p == "gpu") {
+                cfg.pipeline.preprocess = golf::PreprocessMode::GPU;
+            } else if (p == "cpu") {
+                cfg.pipeline.preprocess = golf::PreprocessMode::CPU;
+            } else {
+                std::cerr << "Unknown preprocess mode: " << p << "\n";
+                std::exit(1);
+            }
+        } else if ((arg == "--cpu-kernel") && i + 1 < argc) {
+            std::string k = argv[++i];
+            if (!golf::parse_cpu_kernel(k, cfg.cpu_kernel)) {
+                std::cerr << "Unknown CPU kernel: " << k << "\n";
+                std::exit(1);
+            }
+        } else if ((arg == "--postprocess") && i + 1 < argc) {
+            std::string p = argv[++i];
+            if (p == "gpu") {
+                cfg.pipeline.postprocess = golf::PostprocessMode::GPU;
+            } else if (p == "cpu") {
+                cfg.pipeline.postprocess = golf::PostprocessMode::CPU;
+            } else {
+                std::cerr << "Unknown postprocess mode: " << p << "\n";
+                std::exit(1);
+            }
+        } else if (arg == "--letterbox") {
+            cfg.pipeline.letterbox = true;
+        } else if (arg == "--roi") {
+            cfg.pipeline.roi = true;
+        } else if ((arg == "--roi-full-every") && i + 1 < argc) {
+            cfg.pipeline.roi_full_interval = std::stoi(argv[++i]);
+            if (cfg.pipeline.roi_full_interval < 1) {
+                std::cerr << "Error: --roi-full-every must be at least 1\n\n";
+                print_usage(argv[0]);
+                std::exit(1);
+            }
+        } else if (arg == "--cuda-graph") {
+            cfg.cuda_graph = true;
         } else if (arg == "-h" || arg == "--help") {
             print_usage(argv[0]);
             std::exit(0);
@@ -79,6 +351,37 @@ static Config parse_args(int argc, char** argv) {
             std::exit(1);
         }
     }
+    // Device-decoding backends only download frames someone needs on the CPU;
+    // for the /api/video stream that is decided per frame (see below)
+    cfg.capture.host_copy = cfg.show_gui || !cfg.record_path.empty() ||
+        cfg.pipeline.preprocess == golf::PreprocessMode::CPU;
+    if (cfg.video_sources.empty()) {
+        cfg.video_sources.push_back("0");
+    }
+    // A replay must see every recorded frame to reproduce the session:
+    // stages block instead of dropping, unless asked otherwise at a speed
+    // where the pipeline can keep up
+    const bool replaying = std::any_of(cfg.video_sources.begin(), cfg.video_sources.end(),
+                                       golf::is_recording);
+    if (replaying && cfg.pipeline.drop_policy == golf::DropPolicy::LATEST) {
+        if (!cfg.drop_policy_set) {
+            cfg.pipeline.drop_policy = golf::DropPolicy::BLOCK;
+        } else if (cfg.capture.replay_speed <= 0) {
+            std::cerr << "Error: --replay-speed 0 replays as fast as possible and needs "
+                         "--drop-policy block (latest would drop frames)\n";
+            std::exit(1);
+        } else {
+            std::cerr << "[WARN] --drop-policy latest: replayed frames may be dropped, "
+                         "so the replay is not deterministic\n";
+        }
+    }
+    // Putt state reaches the game reliably on the event channel
+    cfg.sender.stats = cfg.event_port == 0 || cfg.udp_stats;
+    // An engine built here serves its share of the bays in one enqueue and
+    // is calibrated on frames pre-processed like the live ones
+    const int gpus = std::max<int>(1, static_cast<int>(cfg.engines.devices.size()));
+    cfg.build.max_batch = (static_cast<int>(cfg.video_sources.size()) + gpus - 1) / gpus;
+    cfg.build.letterbox = cfg.pipeline.letterbox;
     if (cfg.engine_path.empty()) {
         std::cerr << "Error: --engine is required\n\n";
         print_usage(argv[0]);
@@ -90,132 +393,377 @@ static Config parse_args(int argc, char** argv) {
 int main(int argc, char** argv) {
     Config cfg = parse_args(argc, argv);
 
-    // ── 1. Load TensorRT Engine ─────────────────────────────────────────
-    golf::TrtEngine engine;
-    if (!engine.load(cfg.engine_path)) {
+    // ── 1. Load TensorRT Engine (one per GPU) ───────────────────────────
+    golf::EnginePool engines;
+    if (!engines.load(cfg.engine_path, cfg.build, cfg.engines)) {
         return 1;
     }
+    engines.enable_cuda_graph(cfg.cuda_graph);
+    engines.enable_timing(true);
+    golf::LatencyMetrics metrics;
 
-    // ── 2. Open Video Source ────────────────────────────────────────────
-    golf::FramePipeline pipeline;
-    if (!pipeline.open(cfg.video_source)) {
-        return 1;
+    // Remote view: annotated MJPEG on /api/video, encoded only while watched
+    std::unique_ptr<golf::VideoStream> video;
+    if (cfg.video_fps > 0) {
+        cfg.video.fps = cfg.video_fps;
+        video = std::make_unique<golf::VideoStream>(
+            static_cast<int>(cfg.video_sources.size()), cfg.video);
+        video->start();
+    }
+
+    // ── 2. Open Video Sources ───────────────────────────────────────────
+    std::vector<std::unique_ptr<golf::FramePipeline>> pipelines;
+    std::vector<golf::FramePipeline*> sources;
+    for (const auto& src : cfg.video_sources) {
+        golf::CaptureOptions capture = cfg.capture;
+        // Spread device decoders over the GPUs running the engine
+        capture.gpu = engines.device_id(static_cast<int>(sources.size()) % engines.num_devices());
+        if (video && !capture.host_copy) {
+            // Only download a bay's frames while a viewer watches it
+            const int index = static_cast<int>(sources.size());
+            capture.host_wanted = [v = video.get(), index] { return v->watching(index); };
+        }
+        pipelines.push_back(std::make_unique<golf::FramePipeline>());
+        if (!pipelines.back()->open(src, capture)) {
+            return 1;
+        }
+        sources.push_back(pipelines.back().get());
+    }
+    if (static_cast<int>(sources.size()) > engines.max_batch() * engines.num_devices()) {
+        std::cerr << "[WARN] " << sources.size() << " sources but engine batch is "
+                  << engines.max_batch() << " on " << engines.num_devices()
+                  << " GPU(s) – sources will share enqueues\n";
     }
 
     // ── 3. Init UDP Sender ──────────────────────────────────────────────
     golf::UnrealSender sender;
-    if (!sender.init(cfg.unreal_host, cfg.unreal_port)) {
+    if (!sender.init(cfg.unreal_host, cfg.unreal_port, cfg.sender)) {
         std::cerr << "[WARN] UDP sender init failed – running without UE link\n";
     }
+    sender.set_metrics(&metrics);
+    std::unique_ptr<golf::OutputScheduler> scheduler;
+    if (cfg.send_hz > 0) {
+        scheduler = std::make_unique<golf::OutputScheduler>(
+            sender, static_cast<int>(sources.size()), cfg.send_hz, cfg.max_predict_s);
+    }
 
-    // ── 4. Init Tracker ─────────────────────────────────────────────────
-    golf::Tracker tracker(/*alpha=*/0.6f, /*max_lost=*/15);
+    // ── 4. Init Tracker & Putt Stats (one per bay) ──────────────────────
+    // Tuning: the flags, overridden by --config, retunable via /api/config
+    golf::BayParams tuning;
+    tuning.conf_thresh = cfg.pipeline.conf_thresh;
+    tuning.tracker = cfg.tracker;
+    golf::RuntimeConfig runtime(static_cast<int>(sources.size()), tuning);
+    if (!cfg.config_path.empty() && !runtime.load(cfg.config_path)) {
+        return 1;
+    }
 
-    // ── 5. Init Putt Stats ──────────────────────────────────────────────
-    golf::PuttStats putt_stats(/*motion_threshold=*/5.f, /*stop_frames=*/15);
+    struct Bay {
+        explicit Bay(const golf::BayParams& p)
+            : tracker(p.tracker), balls(p.tracker),
+              putt_stats(p.motion_threshold, p.stop_frames) {}
 
-    // ── 6. Start REST API ───────────────────────────────────────────────
-    golf::StatsApi api(putt_stats, cfg.api_port);
+        golf::Tracker   tracker;
+        golf::MultiTracker balls;         // --multi-ball
+        golf::PuttStats putt_stats;
+        bool has_prev = false;
+        std::chrono::steady_clock::time_point prev_time;
+        double prev_source_time = -1.0;
+        golf::RecordingWriter recorder;   // --record
+        std::vector<golf::Detection> picked;   // GPU-decoded boxes, for the recorder
+    };
+    std::vector<std::unique_ptr<Bay>> bays;
+    std::vector<golf::PuttStats*> bay_stats;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        bays.push_back(std::make_unique<Bay>(runtime.bay(static_cast<int>(i))));
+        bay_stats.push_back(&bays.back()->putt_stats);
+    }
+    if (!cfg.history_dir.empty()) {
+        mkdir(cfg.history_dir.c_str(), 0755);
+        for (size_t i = 0; i < bays.size(); ++i) {
+            const std::string path = cfg.history_dir + "/bay" + std::to_string(i) + ".putts";
+            if (!bays[i]->putt_stats.open_history(path)) {
+                std::cerr << "[WARN] Bay " << i << ": history not persisted\n";
+            }
+        }
+    }
+    if (!cfg.record_path.empty()) {
+        // Several bays: rec.golfrec → rec.bay0.golfrec, rec.bay1.golfrec, …
+        std::string stem = cfg.record_path;
+        if (golf::is_recording(stem)) stem.erase(stem.size() - std::strlen(".golfrec"));
+        for (size_t i = 0; i < bays.size(); ++i) {
+            const std::string path = bays.size() > 1
+                ? stem + ".bay" + std::to_string(i) + ".golfrec"
+                : stem + ".golfrec";
+            if (!bays[i]->recorder.open(path, static_cast<int>(i), cfg.record)) {
+                std::cerr << "[WARN] Bay " << i << ": not recorded\n";
+            }
+        }
+    }
+
+    // Duty cycling: idle bays infer at --idle-fps
+    std::unique_ptr<golf::FrameGovernor> governor;
+    if (cfg.idle_fps > 0) {
+        cfg.governor.idle_fps = cfg.idle_fps;
+        governor = std::make_unique<golf::FrameGovernor>(
+            static_cast<int>(sources.size()), cfg.governor);
+    }
+
+    // ── 5. Start REST API & Event Channel ───────────────────────────────
+    golf::StatsApi api(bay_stats, cfg.api_port);
+    api.set_metrics(&metrics);
+    api.set_traffic(&sender.counters());
+    api.set_governor(governor.get());
+    api.set_engines(&engines);
+    api.set_video(video.get());
+    api.set_config(&runtime, cfg.api_token);
+    api.set_stream_rate(cfg.stream_hz);
+
+    // Reliable putt events for the game, polled like the SSE stream
+    std::unique_ptr<golf::UnrealEventChannel> events;
+    if (cfg.event_port > 0) {
+        events = std::make_unique<golf::UnrealEventChannel>(bay_stats);
+        if (!events->start(cfg.event_port)) {
+            std::cerr << "[WARN] Event channel init failed – putt stats stay on UDP\n";
+            events.reset();
+            sender.set_stats(true);
+        }
+    }
+    if (events) api.set_events(&events->counters());
     api.start();
 
-    // ── 7. Main Loop ────────────────────────────────────────────────────
-    cv::Mat frame;
-    std::vector<float> blob;
-    std::vector<float> output;
+    // ── 6. Start Capture / Preprocess / Inference Stages ────────────────
+    if (cfg.pipeline.preprocess == golf::PreprocessMode::CPU) {
+        if (!golf::set_cpu_kernel(cfg.cpu_kernel)) {
+            std::cerr << "[WARN] CPU kernel " << golf::cpu_kernel_name(cfg.cpu_kernel)
+                      << " not supported here – using "
+                      << golf::cpu_kernel_name(golf::cpu_kernel()) << "\n";
+        }
+        std::cout << "[Main] CPU pre-processing: "
+                  << golf::cpu_kernel_name(golf::cpu_kernel()) << " kernel\n";
+    }
+    // A ball lost outside the crop must meet a full frame before its track
+    // is dropped: each bay's interval is capped at its tracker's max_lost,
+    // here and whenever /api/config retunes it
+    auto roi_full_interval = [&](const golf::BayParams& p) {
+        return std::min(cfg.pipeline.roi_full_interval, p.tracker.max_lost);
+    };
+    golf::StagedPipeline stages(sources, engines, cfg.pipeline, &metrics);
+    stages.set_governor(governor.get());
+    uint32_t applied_config = runtime.version();
+    for (int b = 0; b < runtime.size(); ++b) {
+        const golf::BayParams p = runtime.bay(b);
+        stages.set_conf_thresh(b, p.conf_thresh);
+        stages.set_roi_full_interval(b, roi_full_interval(p));
+        if (cfg.pipeline.roi && roi_full_interval(p) < cfg.pipeline.roi_full_interval) {
+            std::cout << "[Main] Bay " << b << ": --roi-full-every "
+                      << cfg.pipeline.roi_full_interval << " exceeds the tracker's max_lost"
+                      << " – using " << roi_full_interval(p) << "\n";
+        }
+    }
+    stages.start();
+    if (scheduler) scheduler->start();
+
+    std::unique_ptr<golf::PreviewWindow> preview;
+    if (cfg.show_gui || video) {
+        cfg.preview.window = cfg.show_gui;
+        if (!cfg.show_gui) cfg.preview.fps = cfg.video.fps;   // render for the stream only
+        preview = std::make_unique<golf::PreviewWindow>(
+            static_cast<int>(sources.size()), cfg.preview);
+        preview->set_stream(video.get());
+        preview->start();
+    }
 
-    auto prev_time = std::chrono::steady_clock::now();
+    // ── 7. Main Loop (tracking & output stage) ──────────────────────────
+    golf::FrameItem item;
     int frame_count = 0;
+    std::vector<char> in_round(sources.size(), 0);   // bays queued since the last flush
+    int round_size = 0;
 
     std::cout << "[Main] Entering inference loop (press 'q' to quit)\n";
 
-    while (pipeline.read(frame)) {
-        auto now = std::chrono::steady_clock::now();
-        double dt = std::chrono::duration<double>(now - prev_time).count();
-        prev_time = now;
+    while (stages.next(item)) {
+        // A round still waiting for its other bays leaves once its oldest
+        // datagram has been held for max_hold_s, even if no bay queues
+        // another state (the scheduler thread, if any, owns the sender)
+        if (!scheduler) sender.poll();
 
-        int orig_w = frame.cols;
-        int orig_h = frame.rows;
+        // Retuned via /api/config: this thread owns the trackers, so it
+        // applies the new values between frames; inference keeps running
+        if (runtime.version() != applied_config) {
+            applied_config = runtime.version();
+            for (int b = 0; b < runtime.size(); ++b) {
+                const golf::BayParams p = runtime.bay(b);
+                bays[b]->tracker.set_options(p.tracker);
+                bays[b]->balls.set_options(p.tracker);
+                bays[b]->putt_stats.set_thresholds(p.motion_threshold, p.stop_frames);
+                stages.set_conf_thresh(b, p.conf_thresh);
+                stages.set_roi_full_interval(b, roi_full_interval(p));
+            }
+        }
 
-        // Pre-process
-        golf::FramePipeline::preprocess(
-            frame, engine.input_h(), engine.input_w(), blob);
+        Bay& bay = *bays[item.source];
+        golf::Tracker& tracker = bay.tracker;
+        golf::PuttStats& putt_stats = bay.putt_stats;
 
-        // Infer
-        if (!engine.infer(blob.data(), output)) {
-            std::cerr << "[Main] Inference failed on frame " << frame_count << "\n";
-            continue;
+        // dt between capture timestamps rather than loop iterations, so
+        // queueing jitter doesn't leak into the velocity estimate.  The
+        // source's own timestamps (driver / media time) are preferred; the
+        // host clock at read() is the fallback for sources without them.
+        double dt = 0.0;
+        if (bay.has_prev) {
+            const double source_dt = item.source_time - bay.prev_source_time;
+            dt = (item.source_time >= 0.0 && bay.prev_source_time >= 0.0 && source_dt > 0.0)
+                ? source_dt
+                : std::chrono::duration<double>(item.capture_time - bay.prev_time).count();
         }
+        bay.prev_time = item.capture_time;
+        bay.prev_source_time = item.source_time;
+        bay.has_prev = true;
 
-        // Parse detections
-        int num_dets = static_cast<int>(output.size()) / 6;
-        auto detections = golf::FramePipeline::parse_detections(
-            output.data(), num_dets, cfg.conf_thresh,
-            orig_w, orig_h, engine.input_w(), engine.input_h());
+        const auto& detections = item.detections;
 
-        // Track
-        tracker.update(detections, dt);
+        // Track (the GPU decoder has already picked the best box per class;
+        // with --multi-ball every ball box is associated to its own track
+        // and the primary track stands in for "the" ball downstream)
+        golf::TrackedObject ball;
+        {
+            golf::StageTimer timer(&metrics, golf::Stage::TRACK);
+            if (item.gpu_decoded) {
+                tracker.update(item.best_ball, item.best_putter, dt);
+            } else {
+                tracker.update(detections, dt);
+            }
+            if (cfg.multi_ball) {
+                bay.balls.update(detections, dt);
+                const int primary = bay.balls.primary();
+                if (primary >= 0) ball = bay.balls.track(primary);
+            } else {
+                ball = tracker.ball();
+            }
+        }
+        stages.update_ball_hint(item.source, ball, item.capture_time);
 
         // Compute putt stats
-        putt_stats.update(tracker.ball(), dt);
-
-        // Send to Unreal Engine
-        sender.send(tracker.ball(), tracker.putter(), putt_stats.current());
-
-        // Visualise
-        if (cfg.show_gui) {
-            golf::FramePipeline::draw(frame, detections);
-
-            // Overlay tracker info
-            char info[128];
-            if (tracker.ball_visible()) {
-                std::snprintf(info, sizeof(info),
-                    "Ball: (%.0f, %.0f) v=(%.0f, %.0f) px/s",
-                    tracker.ball().x, tracker.ball().y,
-                    tracker.ball().vx, tracker.ball().vy);
-                cv::putText(frame, info, cv::Point(10, 25),
-                            cv::FONT_HERSHEY_SIMPLEX, 0.6,
-                            cv::Scalar(0, 255, 0), 2);
-            }
-            if (tracker.putter_visible()) {
-                std::snprintf(info, sizeof(info),
-                    "Putter: (%.0f, %.0f)",
-                    tracker.putter().x, tracker.putter().y);
-                cv::putText(frame, info, cv::Point(10, 50),
-                            cv::FONT_HERSHEY_SIMPLEX, 0.6,
-                            cv::Scalar(255, 0, 255), 2);
-            }
-
-            // Putt stats overlay
-            auto stats = putt_stats.current();
-            std::snprintf(info, sizeof(info), "Putt #%d [%s]",
-                stats.putt_number, stats.state_str());
-            cv::putText(frame, info, cv::Point(10, 80),
-                        cv::FONT_HERSHEY_SIMPLEX, 0.5,
-                        cv::Scalar(0, 255, 255), 1);
-
-            std::snprintf(info, sizeof(info),
-                "Speed: %.1f  Peak: %.1f  Dist: %.1f  Break: %.1f",
-                stats.current_speed, stats.peak_speed,
-                stats.total_distance, stats.break_distance);
-            cv::putText(frame, info, cv::Point(10, 100),
-                        cv::FONT_HERSHEY_SIMPLEX, 0.45,
-                        cv::Scalar(0, 255, 255), 1);
-
-            // FPS
-            double fps = (dt > 1e-6) ? 1.0 / dt : 0.0;
-            std::snprintf(info, sizeof(info), "FPS: %.1f", fps);
-            cv::putText(frame, info, cv::Point(10, orig_h - 15),
-                        cv::FONT_HERSHEY_SIMPLEX, 0.6,
-                        cv::Scalar(255, 255, 255), 2);
-
-            cv::imshow("Golf Sim – Detection", frame);
-            if (cv::waitKey(1) == 'q') break;
+        {
+            golf::StageTimer timer(&metrics, golf::Stage::STATS);
+            if (cfg.multi_ball) {
+                static_assert(golf::MultiTracker::kCapacity <= golf::PuttStats::kMaxBalls,
+                              "one putt state machine per ball track");
+                for (int slot = 0; slot < golf::MultiTracker::kCapacity; ++slot) {
+                    putt_stats.update(slot, bay.balls.track(slot), dt);
+                }
+            } else {
+                putt_stats.update(ball, dt);
+            }
+        }
+        const golf::PuttData stats = putt_stats.current();   // one snapshot per frame
+        if (governor) {
+            governor->report(item.source, stats.state, ball, tracker.putter(),
+                             item.capture_time);
+        }
+
+        // Record what this frame was and what was made of it
+        if (!cfg.record_path.empty()) {
+            const std::vector<golf::Detection>* recorded = &detections;
+            if (item.gpu_decoded) {
+                bay.picked.clear();
+                if (item.best_ball) bay.picked.push_back(*item.best_ball);
+                if (item.best_putter) bay.picked.push_back(*item.best_putter);
+                recorded = &bay.picked;
+            }
+            bay.recorder.record(item.frame, item.seq, item.source_time, item.capture_time,
+                                *recorded, ball, tracker.putter(), stats);
+        }
+
+        // Send to Unreal Engine – queued, and flushed in one sendmmsg()
+        // once every bay of the round has its state in, no other frame is
+        // waiting, or the oldest datagram has waited max_hold_s (glass-to-
+        // UDP is recorded by the sender when the datagram actually leaves).
+        // With --send-hz the scheduler thread sends instead, at its own rate.
+        {
+            golf::StageTimer timer(&metrics, golf::Stage::SEND);
+            if (scheduler) {
+                scheduler->publish(item.source, ball, tracker.putter(),
+                                   stats, item.capture_time);
+            } else {
+                if (in_round[item.source]) {
+                    // A bay came round again before the others: new round
+                    sender.flush();
+                    std::fill(in_round.begin(), in_round.end(), 0);
+                    round_size = 0;
+                }
+                in_round[item.source] = 1;
+                ++round_size;
+                sender.queue(ball, tracker.putter(), stats,
+                             item.source, item.capture_time);
+                if (round_size == static_cast<int>(in_round.size()) || !stages.has_ready()) {
+                    sender.flush();
+                    std::fill(in_round.begin(), in_round.end(), 0);
+                    round_size = 0;
+                }
+            }
+        }
+
+        // Visualise – drawn and shown by the preview thread; the mailbox
+        // hands back recycled buffers, so nothing is copied here
+        if (preview) {
+            golf::PreviewState view;
+            view.ball = ball;
+            view.putter = tracker.putter();
+            view.putter_visible = tracker.putter_visible();
+            if (cfg.multi_ball) {
+                for (int slot = 0; slot < golf::MultiTracker::kCapacity; ++slot) {
+                    if (bay.balls.active(slot)) view.balls[view.num_balls++] = bay.balls.track(slot);
+                }
+            }
+            view.stats = stats;
+            view.roi = item.roi;
+            view.fps = (dt > 1e-6) ? 1.0 / dt : 0.0;
+            preview->publish(item.source, item.frame, item.detections, view);
+            if (preview->quit_requested()) break;
         }
 
         frame_count++;
     }
 
+    stages.stop();
+    if (scheduler) scheduler->stop();
+    if (preview) preview->stop();
+    if (video) video->stop();          // ends open /api/video responses
+    for (auto& b : bays) b->recorder.close();
     std::cout << "[Main] Processed " << frame_count << " frames\n";
+    for (const auto& st : stages.stats()) {
+        std::cout << "[Main]   " << st.name << " queue: pushed " << st.pushed
+                  << ", dropped " << st.dropped << "\n";
+    }
+    std::cout << "[Main]   frame pool: " << stages.pool().created() << " contexts\n";
+    for (int i = 0; i < engines.size(); ++i) {
+        std::cout << "[Main]   GPU " << engines.device(i) << " context " << i << ": "
+                  << engines.batches(i) << " batches, " << engines.images(i) << " frames\n";
+    }
+    if (preview) {
+        std::cout << "[Main]   preview: " << preview->rendered() << " rendered, "
+                  << preview->dropped() << " dropped\n";
+    }
+    for (int i = 0; i < static_cast<int>(golf::Stage::kCount); ++i) {
+        const auto stage = static_cast<golf::Stage>(i);
+        const auto s = metrics.snapshot(stage);
+        if (s.count == 0) continue;
+        std::printf("[Main]   %-13s p50 %7.3f  p99 %7.3f  max %7.3f ms\n",
+                    golf::stage_name(stage), s.p50_ms, s.p99_ms, s.max_ms);
+    }
+    const golf::SendCounters& udp = sender.counters();
+    std::cout << "[Main]   udp: " << udp.datagrams << " datagrams ("
+              << udp.keyframes << " keyframes, " << udp.predicted << " predicted, "
+              << udp.skipped << " skipped) in "
+              << udp.syscalls << " syscalls\n";
+    if (events) {
+        const golf::EventCounters& ev = events->counters();
+        std::cout << "[Main]   events: " << ev.events << " published, "
+                  << ev.replayed << " replayed, " << ev.connections << " connections ("
+                  << ev.dropped << " dropped), " << ev.bytes << " bytes\n";
+        events->stop();
+    }
     api.stop();
     sender.close();
     return 0;
@@ -0,0 +1,201 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// mapped_log.cpp  –  mmap'd Record Log: Open / Resume, Append, msync
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "mapped_log.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace golf {
+
+namespace {
+constexpr char     kMagic[8] = {'G', 'O', 'L', 'F', 'L', 'O', 'G', '1'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t   kHeaderSize = 512;
+constexpr auto     kFlushInterval = std::chrono::seconds(1);
+}  // namespace
+
+struct MappedLog::Header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t capacity;
+    std::atomic<uint64_t> count;          // published records
+    uint8_t  reserved[kHeaderSize - 32 - kMetaSize];
+    uint8_t  meta[kMetaSize];
+};
+
+MappedLog::~MappedLog() {
+    close();
+}
+
+std::atomic<uint64_t>* MappedLog::count() const {
+    return &header_->count;
+}
+
+void* MappedLog::meta() {
+    return header_ ? header_->meta : nullptr;
+}
+
+const void* MappedLog::meta() const {
+    return header_ ? header_->meta : nullptr;
+}
+
+bool MappedLog::map(size_t bytes, bool create, uint32_t record_size, size_t capacity) {
+    static_assert(sizeof(Header) == kHeaderSize, "header layout");
+    const int prot = PROT_READ | PROT_WRITE;
+    void* base = fd_ >= 0
+        ? mmap(nullptr, bytes, prot, MAP_SHARED, fd_, 0)
+        : mmap(nullptr, bytes, prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+        std::cerr << "[MappedLog] mmap failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    header_ = static_cast<Header*>(base);
+    records_ = static_cast<uint8_t*>(base) + kHeaderSize;
+    map_size_ = bytes;
+    if (create) {
+        std::memcpy(header_->magic, kMagic, sizeof(kMagic));
+        header_->version = kVersion;
+        header_->record_size = record_size;
+        header_->capacity = capacity;
+        header_->count.store(0, std::memory_order_relaxed);
+    }
+    record_size_ = header_->record_size;
+    capacity_ = static_cast<size_t>(header_->capacity);
+    return true;
+}
+
+bool MappedLog::open(const std::string& path, uint32_t record_size, size_t capacity) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        std::cerr << "[MappedLog] Cannot open " << path << ": "
+                  << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    struct stat st{};
+    fstat(fd_, &st);
+    const bool create = st.st_size == 0;
+    size_t bytes = kHeaderSize + capacity * record_size;
+
+    if (create) {
+        // Sparse: blocks are only allocated as records are written
+        if (ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+            std::cerr << "[MappedLog] ftruncate failed: " << std::strerror(errno) << "\n";
+            close();
+            return false;
+        }
+    } else {
+        Header h;
+        if (static_cast<size_t>(st.st_size) < kHeaderSize ||
+            pread(fd_, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h)) ||
+            std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.version != kVersion) {
+            std::cerr << "[MappedLog] " << path << " is not a putt log\n";
+            close();
+            return false;
+        }
+        if (h.record_size != record_size) {
+            std::cerr << "[MappedLog] " << path << " has " << h.record_size
+                      << "-byte records, expected " << record_size << "\n";
+            close();
+            return false;
+        }
+        bytes = kHeaderSize + static_cast<size_t>(h.capacity) * record_size;
+        if (static_cast<size_t>(st.st_size) < bytes ||
+            h.count.load(std::memory_order_relaxed) > h.capacity) {
+            std::cerr << "[MappedLog] " << path << " is truncated or corrupt\n";
+            close();
+            return false;
+        }
+    }
+
+    if (!map(bytes, create, record_size, capacity)) {
+        close();
+        return false;
+    }
+    path_ = path;
+    synced_ = size();
+    stopping_ = false;
+    flusher_ = std::thread(&MappedLog::flush_loop, this);
+
+    std::cout << "[MappedLog] " << (create ? "Created " : "Resumed ") << path
+              << " (" << size() << " / " << capacity_ << " records)\n";
+    return true;
+}
+
+bool MappedLog::open_anonymous(uint32_t record_size, size_t capacity) {
+    close();
+    return map(kHeaderSize + capacity * record_size, true, record_size, capacity);
+}
+
+bool MappedLog::append(const void* records, size_t n) {
+    if (!header_) return false;
+    const uint64_t size = count()->load(std::memory_order_relaxed);
+    if (n > capacity_ - size) return false;
+
+    std::memcpy(records_ + size * record_size_, records, n * record_size_);
+    count()->store(size + n, std::memory_order_release);
+    return true;
+}
+
+// ─── Durability ─────────────────────────────────────────────────────────────
+void MappedLog::sync() {
+    if (fd_ < 0 || !header_) return;
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    const size_t n = size();
+    if (n == synced_) return;
+
+    // Records first, then the header that publishes them
+    const long page = sysconf(_SC_PAGESIZE);
+    const size_t from = (kHeaderSize + synced_ * record_size_) / page * page;
+    const size_t to = kHeaderSize + n * record_size_;
+    auto* base = reinterpret_cast<uint8_t*>(header_);
+    msync(base + from, to - from, MS_SYNC);
+    msync(base, kHeaderSize, MS_SYNC);
+    synced_ = n;
+}
+
+void MappedLog::flush_loop() {
+    std::unique_lock<std::mutex> lock(flush_mutex_);
+    while (!stopping_) {
+        flush_cv_.wait_for(lock, kFlushInterval, [this] { return stopping_; });
+        lock.unlock();
+        sync();
+        lock.lock();
+    }
+}
+
+void MappedLog::close() {
+    if (flusher_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(flush_mutex_);
+            stopping_ = true;
+        }
+        flush_cv_.notify_all();
+        flusher_.join();
+    }
+    if (header_) {
+        sync();
+        munmap(header_, map_size_);
+        header_ = nullptr;
+        records_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    map_size_ = capacity_ = synced_ = 0;
+}
+
+}  // namespace golf
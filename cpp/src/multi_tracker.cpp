@@ -0,0 +1,164 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// multi_tracker.cpp  –  Gated Greedy Association over an SoA Track Table
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "multi_tracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace golf {
+
+namespace {
+constexpr float kHandoverSpeed = 50.f;   // px/s a track must lead by to take over
+
+/// Candidate track ↔ detection pair inside the gate.
+struct Pair {
+    float    cost;     // squared centre distance (px²)
+    uint16_t track;
+    uint16_t det;
+};
+}  // namespace
+
+MultiTracker::MultiTracker(const TrackerOptions& opts, int class_id, float gate_px)
+    : class_id_(class_id), max_lost_(opts.max_lost), gate_px_(gate_px) {
+    for (KalmanTracker& kf : kf_) kf = KalmanTracker(opts.kalman);
+}
+
+void MultiTracker::set_options(const TrackerOptions& opts) {
+    max_lost_ = opts.max_lost;
+    for (KalmanTracker& kf : kf_) kf.set_options(opts.kalman);
+}
+
+void MultiTracker::update(const std::vector<Detection>& detections, double dt) {
+    update(detections.data(), detections.size(), dt);
+}
+
+void MultiTracker::update(const Detection* detections, size_t count, double dt) {
+    // Centres of this frame's detections of our class
+    float det_x[kMaxDetections], det_y[kMaxDetections];
+    const Detection* det[kMaxDetections];
+    int n = 0;
+    for (size_t i = 0; i < count && n < kMaxDetections; ++i) {
+        if (detections[i].class_id != class_id_) continue;
+        det[n] = &detections[i];
+        det_x[n] = detections[i].cx();
+        det_y[n] = detections[i].cy();
+        ++n;
+    }
+
+    // 1. Predict
+    for (int t = 0; t < kCapacity; ++t) {
+        if (!active_[t]) continue;
+        kf_[t].predict(dt);
+        x_[t] = kf_[t].x();
+        y_[t] = kf_[t].y();
+    }
+
+    // 2. Gated candidate pairs, cheapest first
+    Pair pairs[kCapacity * kMaxDetections];
+    int num_pairs = 0;
+    const float step = static_cast<float>(std::max(dt, 0.0));
+    for (int t = 0; t < kCapacity; ++t) {
+        if (!active_[t]) continue;
+        const float gate = gate_px_ + std::sqrt(vx_[t] * vx_[t] + vy_[t] * vy_[t]) * step;
+        const float gate2 = gate * gate;
+        for (int d = 0; d < n; ++d) {
+            const float dx = det_x[d] - x_[t];
+            const float dy = det_y[d] - y_[t];
+            const float cost = dx * dx + dy * dy;
+            if (cost <= gate2) {
+                pairs[num_pairs++] = {cost, static_cast<uint16_t>(t), static_cast<uint16_t>(d)};
+            }
+        }
+    }
+    std::sort(pairs, pairs + num_pairs,
+              [](const Pair& a, const Pair& b) { return a.cost < b.cost; });
+
+    // 3. Greedy assignment + correction
+    bool track_used[kCapacity] = {};
+    bool det_used[kMaxDetections] = {};
+    for (int i = 0; i < num_pairs; ++i) {
+        const Pair& p = pairs[i];
+        if (track_used[p.track] || det_used[p.det]) continue;
+        track_used[p.track] = det_used[p.det] = true;
+
+        KalmanTracker& kf = kf_[p.track];
+        kf.correct(det_x[p.det], det_y[p.det], det[p.det]->confidence);
+        x_[p.track] = kf.x();
+        y_[p.track] = kf.y();
+        vx_[p.track] = kf.vx();
+        vy_[p.track] = kf.vy();
+        conf_[p.track] = det[p.det]->confidence;
+        lost_[p.track] = 0;
+    }
+    for (int t = 0; t < kCapacity; ++t) {
+        if (!active_[t] || track_used[t]) continue;
+        if (++lost_[t] > max_lost_) {
+            active_[t] = false;
+            --num_active_;
+        }
+    }
+
+    // 4. Spawn – skipping duplicates of a box that was just matched
+    for (int d = 0; d < n; ++d) {
+        if (det_used[d]) continue;
+        bool duplicate = false;
+        for (int t = 0; t < kCapacity && !duplicate; ++t) {
+            if (!track_used[t]) continue;
+            const float dx = det_x[d] - x_[t];
+            const float dy = det_y[d] - y_[t];
+            duplicate = dx * dx + dy * dy < 0.25f * gate_px_ * gate_px_;
+        }
+        if (duplicate) continue;
+
+        int t = 0;
+        while (t < kCapacity && active_[t]) ++t;
+        if (t == kCapacity) break;   // table full
+
+        active_[t] = true;
+        ++num_active_;
+        id_[t] = next_id_++;
+        kf_[t].reset(det_x[d], det_y[d], det[d]->confidence);
+        x_[t] = det_x[d];
+        y_[t] = det_y[d];
+        vx_[t] = vy_[t] = 0.f;
+        conf_[t] = det[d]->confidence;
+        lost_[t] = 0;
+    }
+    choose_primary();
+}
+
+TrackedObject MultiTracker::track(int slot) const {
+    TrackedObject o;
+    o.id = id_[slot];
+    o.class_id = class_id_;
+    o.valid = active_[slot];
+    if (!o.valid) return o;
+    o.x = x_[slot];
+    o.y = y_[slot];
+    o.vx = vx_[slot];
+    o.vy = vy_[slot];
+    o.confidence = conf_[slot];
+    o.frames_since_seen = lost_[slot];
+    return o;
+}
+
+void MultiTracker::choose_primary() {
+    auto speed = [this](int t) { return std::sqrt(vx_[t] * vx_[t] + vy_[t] * vy_[t]); };
+
+    int best = -1;
+    for (int t = 0; t < kCapacity; ++t) {
+        if (!active_[t] || lost_[t] > 0) continue;
+        if (best < 0 || speed(t) > speed(best) ||
+            (speed(t) == speed(best) && id_[t] < id_[best])) {
+            best = t;
+        }
+    }
+    const bool keep = primary_ >= 0 && active_[primary_] &&
+                      (best < 0 || (lost_[primary_] == 0 &&
+                                    speed(best) < speed(primary_) + kHandoverSpeed));
+    if (!keep) primary_ = best;
+}
+
+}  // namespace golf
@@ -0,0 +1,96 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// output_scheduler.cpp  –  Fixed-rate Measured / Predicted State Sender
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "output_scheduler.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace golf {
+
+OutputScheduler::OutputScheduler(UnrealSender& sender, int streams,
+                                 double send_hz, double max_predict_s)
+    : sender_(sender),
+      period_(std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(1.0 / std::max(send_hz, 1.0)))),
+      max_predict_s_(max_predict_s) {
+    for (int i = 0; i < streams; ++i) {
+        streams_.push_back(std::make_unique<Stream>());
+    }
+}
+
+OutputScheduler::~OutputScheduler() {
+    stop();
+}
+
+void OutputScheduler::start() {
+    if (running_.exchange(true)) return;
+    thread_ = std::thread(&OutputScheduler::run, this);
+    std::cout << "[OutputScheduler] Sending at "
+              << 1.0 / std::chrono::duration<double>(period_).count() << " Hz\n";
+}
+
+void OutputScheduler::stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void OutputScheduler::publish(int stream, const TrackedObject& ball,
+                              const TrackedObject& putter, const PuttData& stats,
+                              Clock::time_point capture_time) {
+    if (stream < 0 || stream >= static_cast<int>(streams_.size())) return;
+    Measurement m;
+    m.ball = ball;
+    m.putter = putter;
+    m.stats = stats;
+    m.capture_time = capture_time;
+    m.published_at = Clock::now();
+    streams_[stream]->latest.store(m);
+}
+
+void OutputScheduler::run() {
+    auto next = Clock::now();
+    while (running_) {
+        std::this_thread::sleep_until(next);
+        const auto now = Clock::now();
+        for (size_t i = 0; i < streams_.size(); ++i) {
+            tick(*streams_[i], static_cast<int>(i), now);
+        }
+        sender_.flush();
+
+        next += period_;
+        if (next < now) next = now + period_;   // fell behind: don't burst
+    }
+    sender_.flush();
+}
+
+void OutputScheduler::tick(Stream& s, int stream_id, Clock::time_point now) {
+    uint32_t version;
+    Measurement m = s.latest.load(version);
+    if (version <= 1) return;   // nothing published yet (version 1 = ctor)
+
+    if (version != s.seen_version) {
+        s.seen_version = version;
+        sender_.queue(m.ball, m.putter, m.stats, stream_id, m.capture_time);
+        return;
+    }
+
+    // Extrapolate from when the measurement arrived, keeping the same
+    // latency as measured states so motion stays continuous
+    const double ahead = std::min(
+        std::chrono::duration<double>(now - m.published_at).count(), max_predict_s_);
+    const float a = static_cast<float>(ahead);
+    for (TrackedObject* o : {&m.ball, &m.putter}) {
+        if (!o->valid) continue;
+        o->x += o->vx * a;
+        o->y += o->vy * a;
+    }
+    const auto state_time = m.capture_time +
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(ahead));
+    sender_.queue(m.ball, m.putter, m.stats, stream_id, state_time, /*predicted=*/true);
+}
+
+}  // namespace golf
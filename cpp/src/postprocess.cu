@@ -0,0 +1,110 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// postprocess.cu  –  GPU Detection Decoding & Compaction
+//
+// One block per image.  Rows are thresholded in chunks of kDecodeThreads;
+// survivors are compacted with a ballot / prefix count so they keep their
+// row order (matching the CPU parse_detections() reference), and the best
+// row per class is found with a packed (confidence, row) atomicMax.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "cuda_kernels.h"
+
+#include <cuda_runtime.h>
+
+namespace golf {
+
+constexpr int kDecodeThreads = 256;
+constexpr int kDecodeWarps = kDecodeThreads / 32;
+
+__device__ __forceinline__ CompactDetection decode_row(const float* row,
+                                                       const DecodeParams& p) {
+    CompactDetection d;
+    d.x1 = (row[0] - p.pad_x) / p.scale_x + p.offset_x;
+    d.y1 = (row[1] - p.pad_y) / p.scale_y + p.offset_y;
+    d.x2 = (row[2] - p.pad_x) / p.scale_x + p.offset_x;
+    d.y2 = (row[3] - p.pad_y) / p.scale_y + p.offset_y;
+    d.confidence = row[4];
+    d.class_id = static_cast<int>(row[5]);
+    return d;
+}
+
+__global__ void decode_detections_kernel(const float* __restrict__ output,
+                                         int num_dets, int stride,
+                                         const DecodeParams* __restrict__ params,
+                                         CompactDetections* __restrict__ results) {
+    const int image = blockIdx.x;
+    const float* rows = output + static_cast<size_t>(image) * stride;
+    const DecodeParams p = params[image];
+    CompactDetections& r = results[image];
+
+    __shared__ int s_warp_count[kDecodeWarps];
+    __shared__ int s_base;
+    // High word: confidence bits (positive floats order like uints).
+    // Low word: inverted row, so the earliest row wins ties.  0 = none.
+    __shared__ unsigned long long s_best[kNumClasses];
+
+    const int tid = threadIdx.x;
+    const int lane = tid & 31;
+    const int warp = tid >> 5;
+    if (tid == 0) s_base = 0;
+    if (tid < kNumClasses) s_best[tid] = 0ull;
+    __syncthreads();
+
+    for (int start = 0; start < num_dets; start += kDecodeThreads) {
+        const int i = start + tid;
+        const float* row = rows + i * 6;
+        const float conf = i < num_dets ? row[4] : 0.f;
+        const bool keep = i < num_dets && conf >= p.conf_thresh;
+
+        const unsigned mask = __ballot_sync(0xffffffffu, keep);
+        if (lane == 0) s_warp_count[warp] = __popc(mask);
+        __syncthreads();
+
+        if (keep) {
+            int slot = s_base + __popc(mask & ((1u << lane) - 1u));
+            for (int w = 0; w < warp; ++w) slot += s_warp_count[w];
+
+            const CompactDetection d = decode_row(row, p);
+            if (slot < kMaxCompactDetections) r.dets[slot] = d;
+
+            if (d.class_id >= 0 && d.class_id < kNumClasses && conf > 0.f) {
+                const unsigned long long key =
+                    (static_cast<unsigned long long>(__float_as_uint(conf)) << 32) |
+                    (0xffffffffu - static_cast<unsigned>(i));
+                atomicMax(&s_best[d.class_id], key);
+            }
+        }
+        __syncthreads();
+
+        if (tid == 0) {
+            for (int w = 0; w < kDecodeWarps; ++w) s_base += s_warp_count[w];
+        }
+        __syncthreads();
+    }
+
+    if (tid == 0) {
+        r.total = s_base;
+        r.count = min(s_base, kMaxCompactDetections);
+    }
+    if (tid < kNumClasses) {
+        const unsigned long long key = s_best[tid];
+        if (key == 0ull) {
+            r.best[tid] = CompactDetection();
+        } else {
+            const int i = static_cast<int>(0xffffffffu - static_cast<unsigned>(key));
+            r.best[tid] = decode_row(rows + i * 6, p);
+        }
+    }
+}
+
+cudaError_t launch_decode_detections(const float* output, int num_dets,
+                                     int stride, int images,
+                                     const DecodeParams* params,
+                                     CompactDetections* results,
+                                     cudaStream_t stream) {
+    decode_detections_kernel<<<images, kDecodeThreads, 0, stream>>>(
+        output, num_dets, stride, params, results);
+    return cudaGetLastError();
+}
+
+}  // namespace golf
@@ -0,0 +1,175 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// preview_window.cpp  –  GUI Thread, Mailboxes & Overlay Drawing
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "preview_window.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+namespace golf {
+
+PreviewWindow::PreviewWindow(int sources, const PreviewOptions& opts)
+    : opts_(opts), views_(sources) {
+    opts_.scale = std::clamp(opts_.scale, 0.05, 1.0);
+    for (int i = 0; i < sources; ++i) {
+        mailboxes_.push_back(std::make_unique<Mailbox>());
+        views_[i].title = sources > 1
+            ? "Golf Sim – Bay " + std::to_string(i)
+            : std::string("Golf Sim – Detection");
+    }
+}
+
+PreviewWindow::~PreviewWindow() {
+    stop();
+}
+
+void PreviewWindow::start() {
+    if (running_.exchange(true)) return;
+    thread_ = std::thread(&PreviewWindow::run, this);
+    std::cout << "[PreviewWindow] Rendering at up to " << opts_.fps << " fps";
+    if (opts_.scale < 1.0) std::cout << ", " << opts_.scale << "x scale";
+    if (!opts_.window) std::cout << " (stream only)";
+    std::cout << "\n";
+}
+
+void PreviewWindow::stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+// ─── Tracking side ──────────────────────────────────────────────────────────
+void PreviewWindow::publish(int source, cv::Mat& frame,
+                            std::vector<Detection>& detections,
+                            const PreviewState& state) {
+    if (source < 0 || source >= static_cast<int>(mailboxes_.size()) ||
+        frame.empty() || !wanted(source)) {
+        return;
+    }
+    Mailbox& m = *mailboxes_[source];
+    std::lock_guard<std::mutex> lock(m.mutex);
+    if (m.fresh) dropped_.fetch_add(1, std::memory_order_relaxed);
+    std::swap(m.frame, frame);
+    std::swap(m.detections, detections);
+    m.state = state;
+    m.fresh = true;
+}
+
+// ─── GUI thread ─────────────────────────────────────────────────────────────
+void PreviewWindow::run() {
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / std::max(opts_.fps, 1.0)));
+    auto next = Clock::now();
+    while (running_) {
+        for (int i = 0; i < static_cast<int>(views_.size()); ++i) {
+            if (!take(i)) continue;
+            render(i);
+            rendered_.fetch_add(1, std::memory_order_relaxed);
+        }
+        // Always pump HighGUI events, even without new frames
+        if (opts_.window && cv::waitKey(1) == 'q') quit_ = true;
+
+        next += period;
+        const auto now = Clock::now();
+        if (next < now) next = now;
+        std::this_thread::sleep_until(next);
+    }
+    if (opts_.window) cv::destroyAllWindows();
+}
+
+bool PreviewWindow::take(int source) {
+    Mailbox& m = *mailboxes_[source];
+    View& v = views_[source];
+    std::lock_guard<std::mutex> lock(m.mutex);
+    if (!m.fresh) return false;
+    // The view's previous buffers go back to the mailbox for publish() to
+    // hand out again
+    std::swap(v.frame, m.frame);
+    std::swap(v.detections, m.detections);
+    v.state = m.state;
+    m.fresh = false;
+    return true;
+}
+
+void PreviewWindow::render(int source) {
+    View& v = views_[source];
+    const float s = static_cast<float>(opts_.scale);
+    cv::Mat* canvas = &v.frame;
+    if (opts_.scale < 1.0) {
+        cv::resize(v.frame, v.scaled,
+                   cv::Size(std::max(1, static_cast<int>(v.frame.cols * s)),
+                            std::max(1, static_cast<int>(v.frame.rows * s))),
+                   0, 0, cv::INTER_AREA);
+        canvas = &v.scaled;
+        for (Detection& d : v.detections) {
+            d.x1 *= s; d.y1 *= s;
+            d.x2 *= s; d.y2 *= s;
+        }
+    }
+    cv::Mat& frame = *canvas;
+    const PreviewState& st = v.state;
+
+    FramePipeline::draw(frame, v.detections);
+    if (st.roi.width < v.frame.cols || st.roi.height < v.frame.rows) {
+        cv::rectangle(frame, cv::Rect(static_cast<int>(st.roi.x * s),
+                                      static_cast<int>(st.roi.y * s),
+                                      static_cast<int>(st.roi.width * s),
+                                      static_cast<int>(st.roi.height * s)),
+                      cv::Scalar(255, 255, 0), 1);
+    }
+
+    // Overlay tracker info
+    char info[128];
+    if (st.ball.valid) {
+        std::snprintf(info, sizeof(info),
+            "Ball: (%.0f, %.0f) v=(%.0f, %.0f) px/s",
+            st.ball.x, st.ball.y, st.ball.vx, st.ball.vy);
+        cv::putText(frame, info, cv::Point(10, 25),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.6,
+                    cv::Scalar(0, 255, 0), 2);
+    }
+    for (int i = 0; i < st.num_balls; ++i) {
+        const TrackedObject& b = st.balls[i];
+        std::snprintf(info, sizeof(info), "#%u", b.id);
+        cv::putText(frame, info, cv::Point(static_cast<int>(b.x * s) + 8,
+                                           static_cast<int>(b.y * s) - 8),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.5,
+                    cv::Scalar(0, 255, 0), 1);
+    }
+    if (st.putter_visible) {
+        std::snprintf(info, sizeof(info),
+            "Putter: (%.0f, %.0f)", st.putter.x, st.putter.y);
+        cv::putText(frame, info, cv::Point(10, 50),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.6,
+                    cv::Scalar(255, 0, 255), 2);
+    }
+
+    // Putt stats overlay
+    std::snprintf(info, sizeof(info), "Putt #%d [%s]",
+        st.stats.putt_number, st.stats.state_str());
+    cv::putText(frame, info, cv::Point(10, 80),
+                cv::FONT_HERSHEY_SIMPLEX, 0.5,
+                cv::Scalar(0, 255, 255), 1);
+
+    std::snprintf(info, sizeof(info),
+        "Speed: %.1f  Peak: %.1f  Dist: %.1f  Break: %.1f",
+        st.stats.current_speed, st.stats.peak_speed,
+        st.stats.total_distance, st.stats.break_distance);
+    cv::putText(frame, info, cv::Point(10, 100),
+                cv::FONT_HERSHEY_SIMPLEX, 0.45,
+                cv::Scalar(0, 255, 255), 1);
+
+    // FPS
+    std::snprintf(info, sizeof(info), "FPS: %.1f", st.fps);
+    cv::putText(frame, info, cv::Point(10, frame.rows - 15),
+                cv::FONT_HERSHEY_SIMPLEX, 0.6,
+                cv::Scalar(255, 255, 255), 2);
+
+    if (opts_.window) cv::imshow(v.title, frame);
+    if (stream_) stream_->offer(source, frame);
+}
+
+}  // namespace golf
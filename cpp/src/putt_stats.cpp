@@ -4,162 +4,311 @@
 
 #include "putt_stats.h"
 
+#include <algorithm>
 #include <cmath>
-#include <numeric>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
 
 namespace golf {
 
+static_assert(std::is_trivially_copyable<PuttData>::value &&
+              std::is_trivially_copyable<TrajectorySample>::value,
+              "PuttData / TrajectorySample are stored as raw records");
+
 PuttStats::PuttStats(float motion_threshold, int stop_frames)
     : motion_threshold_(motion_threshold),
-      stop_frames_required_(stop_frames) {}
+      stop_frames_required_(stop_frames) {
+    history_.open_anonymous(sizeof(PuttData), kHistoryCapacity);
+    trajectories_.open_anonymous(sizeof(TrajectorySample), kTrajectoryCapacity);
+    staging_.reset(new TrajectorySample[static_cast<size_t>(kMaxBalls) * kMaxTrajectorySamples]);
+}
+
+bool PuttStats::open_history(const std::string& path) {
+    static_assert(sizeof(Meta) <= MappedLog::kMetaSize, "meta block too small");
+    if (!history_.open(path, sizeof(PuttData), kHistoryCapacity)) {
+        history_.open_anonymous(sizeof(PuttData), kHistoryCapacity);
+        return false;
+    }
+
+    Meta meta;
+    std::memcpy(&meta, history_.meta(), sizeof(meta));
+    if (meta.version == Meta::kVersion && meta.records == history_.size()) {
+        launch_ = meta.launch;
+        distance_ = meta.distance;
+        break_ = meta.brk;
+        time_ = meta.time;
+    } else {
+        // No aggregates stored yet, an older layout, or a crash between a
+        // putt's record and its meta update
+        if (meta.version == Meta::kVersion) {
+            std::cerr << "[PuttStats] Aggregates of " << path << " cover " << meta.records
+                      << " of " << history_.size() << " putts – recomputing\n";
+        }
+        launch_ = distance_ = break_ = time_ = RunningStat{};
+        for (const PuttData& p : history()) {
+            launch_.add(p.launch_speed);
+            distance_.add(p.total_distance);
+            break_.add(p.break_distance);
+            time_.add(p.time_in_motion);
+        }
+    }
+    publish_session();
+
+    if (!trajectories_.open(path + ".traj", sizeof(TrajectorySample), kTrajectoryCapacity)) {
+        std::cerr << "[PuttStats] Trajectories of " << path << " not persisted\n";
+        trajectories_.open_anonymous(sizeof(TrajectorySample), kTrajectoryCapacity);
+    }
+    return true;
+}
+
+PuttStats::Trajectory PuttStats::trajectory(const PuttData& putt) const {
+    const size_t end = static_cast<size_t>(putt.trajectory_begin) + putt.trajectory_count;
+    if (putt.trajectory_count == 0 || end > trajectories_.size()) {
+        return Trajectory(nullptr, 0);
+    }
+    return Trajectory(
+        static_cast<const TrajectorySample*>(trajectories_.record(putt.trajectory_begin)),
+        putt.trajectory_count);
+}
 
 void PuttStats::update(const TrackedObject& ball, double dt) {
-    std::lock_guard<std::mutex> lock(mu_);
+    update(0, ball, dt);
+}
 
+void PuttStats::update(int slot, const TrackedObject& ball, double dt) {
+    if (slot < 0 || slot >= kMaxBalls) return;
+    Motion& m = motion_[slot];
+    PuttData& cur = m.current;
+    if (cur.ball_id != ball.id) {
+        // Slot handed to another ball track – start from scratch, after
+        // closing the previous ball's putt
+        end_track(slot);
+        m = Motion();
+        cur.ball_id = ball.id;
+    }
     if (!ball.valid) {
-        has_prev_ = false;
+        end_track(slot);
         return;
     }
 
     float speed = std::sqrt(ball.vx * ball.vx + ball.vy * ball.vy);
-    current_.current_speed = speed;
+    cur.current_speed = speed;
 
     // Accumulate distance from frame-to-frame movement
-    if (has_prev_) {
-        float dx = ball.x - prev_x_;
-        float dy = ball.y - prev_y_;
+    if (m.has_prev) {
+        float dx = ball.x - m.prev_x;
+        float dy = ball.y - m.prev_y;
         float frame_dist = std::sqrt(dx * dx + dy * dy);
 
-        if (current_.state == PuttState::IN_MOTION) {
-            current_.total_distance += frame_dist;
-            current_.time_in_motion += static_cast<float>(dt);
+        if (cur.state == PuttState::IN_MOTION) {
+            cur.total_distance += frame_dist;
+            cur.time_in_motion += static_cast<float>(dt);
 
-            if (speed > current_.peak_speed) {
-                current_.peak_speed = speed;
+            if (speed > cur.peak_speed) {
+                cur.peak_speed = speed;
             }
 
             // Compute break: perpendicular distance from the initial putt line
-            if (has_direction_) {
-                float rx = ball.x - current_.start_x;
-                float ry = ball.y - current_.start_y;
+            if (m.has_direction) {
+                float rx = ball.x - cur.start_x;
+                float ry = ball.y - cur.start_y;
                 // Cross product gives signed perpendicular distance
-                float cross = std::abs(rx * dir_y_ - ry * dir_x_);
-                if (cross > current_.break_distance) {
-                    current_.break_distance = cross;
+                float cross = std::abs(rx * m.dir_y - ry * m.dir_x);
+                if (cross > cur.break_distance) {
+                    cur.break_distance = cross;
                 }
             }
 
-            current_.final_x = ball.x;
-            current_.final_y = ball.y;
+            cur.final_x = ball.x;
+            cur.final_y = ball.y;
         }
     }
 
-    prev_x_ = ball.x;
-    prev_y_ = ball.y;
-    has_prev_ = true;
+    m.prev_x = ball.x;
+    m.prev_y = ball.y;
+    m.has_prev = true;
 
     // State transitions
-    switch (current_.state) {
+    switch (cur.state) {
         case PuttState::IDLE:
             if (speed > motion_threshold_) {
-                current_.state = PuttState::IN_MOTION;
-                current_.putt_number = static_cast<int>(history_.size()) + 1;
-                current_.launch_speed = speed;
-                current_.peak_speed = speed;
-                current_.total_distance = 0.f;
-                current_.break_distance = 0.f;
-                current_.time_in_motion = 0.f;
-                current_.start_x = ball.x;
-                current_.start_y = ball.y;
-                current_.final_x = ball.x;
-                current_.final_y = ball.y;
-
-                // Capture initial direction for break computation
-                float vmag = std::sqrt(ball.vx * ball.vx + ball.vy * ball.vy);
-                if (vmag > 1e-6f) {
-                    dir_x_ = ball.vx / vmag;
-                    dir_y_ = ball.vy / vmag;
-                    has_direction_ = true;
-                } else {
-                    has_direction_ = false;
-                }
-                frames_below_threshold_ = 0;
+                begin_putt(m, ball, speed);
             }
             break;
 
         case PuttState::IN_MOTION:
             if (speed < motion_threshold_) {
-                frames_below_threshold_++;
-                if (frames_below_threshold_ >= stop_frames_required_) {
-                    current_.state = PuttState::STOPPED;
-                    finalize_putt();
+                m.frames_below_threshold++;
+                if (m.frames_below_threshold >= stop_frames_required_) {
+                    cur.state = PuttState::STOPPED;
+                    finalize_putt(slot);
                 }
             } else {
-                frames_below_threshold_ = 0;
+                m.frames_below_threshold = 0;
             }
             break;
 
         case PuttState::STOPPED:
             if (speed > motion_threshold_) {
-                // New putt begins
-                current_.state = PuttState::IN_MOTION;
-                current_.putt_number = static_cast<int>(history_.size()) + 1;
-                current_.launch_speed = speed;
-                current_.peak_speed = speed;
-                current_.total_distance = 0.f;
-                current_.break_distance = 0.f;
-                current_.time_in_motion = 0.f;
-                current_.start_x = ball.x;
-                current_.start_y = ball.y;
-                current_.final_x = ball.x;
-                current_.final_y = ball.y;
-
-                float vmag = std::sqrt(ball.vx * ball.vx + ball.vy * ball.vy);
-                if (vmag > 1e-6f) {
-                    dir_x_ = ball.vx / vmag;
-                    dir_y_ = ball.vy / vmag;
-                    has_direction_ = true;
-                } else {
-                    has_direction_ = false;
-                }
-                frames_below_threshold_ = 0;
+                begin_putt(m, ball, speed);   // new putt begins
             }
             break;
     }
+
+    if (cur.state == PuttState::IN_MOTION) {
+        record_sample(slot, ball);
+    }
+
+    // current() follows the ball in motion, then stays on its result
+    if (slot != published_slot_ && cur.state == PuttState::IN_MOTION &&
+        motion_[published_slot_].current.state != PuttState::IN_MOTION) {
+        published_slot_ = slot;
+    }
+    if (slot == published_slot_) {
+        published_.store(cur);
+    }
+}
+
+// A track that ends mid-putt (the ball dropped in the cup or left the
+// frame) finishes its putt where the ball was last seen, and current()
+// moves on to a ball still rolling, if any.
+void PuttStats::end_track(int slot) {
+    Motion& m = motion_[slot];
+    m.has_prev = false;
+    if (m.current.state != PuttState::IN_MOTION) return;
+
+    m.current.state = PuttState::STOPPED;
+    m.current.current_speed = 0.f;
+    finalize_putt(slot);
+    if (slot != published_slot_) return;
+
+    published_.store(m.current);
+    for (int other = 0; other < kMaxBalls; ++other) {
+        if (motion_[other].current.state == PuttState::IN_MOTION) {
+            published_slot_ = other;
+            published_.store(motion_[other].current);
+            break;
+        }
+    }
 }
 
-PuttData PuttStats::current() const {
-    std::lock_guard<std::mutex> lock(mu_);
-    return current_;
+void PuttStats::begin_putt(Motion& m, const TrackedObject& ball, float speed) {
+    PuttData& cur = m.current;
+    cur.state = PuttState::IN_MOTION;
+    // Provisional; finalize_putt() numbers putts in the order they finish
+    int moving = 0;
+    for (const Motion& other : motion_) {
+        if (&other != &m && other.current.state == PuttState::IN_MOTION) ++moving;
+    }
+    cur.putt_number = static_cast<int>(history_.size()) + 1 + moving;
+    cur.launch_speed = speed;
+    cur.peak_speed = speed;
+    cur.total_distance = 0.f;
+    cur.break_distance = 0.f;
+    cur.time_in_motion = 0.f;
+    cur.start_x = ball.x;
+    cur.start_y = ball.y;
+    cur.final_x = ball.x;
+    cur.final_y = ball.y;
+    cur.trajectory_begin = 0;
+    cur.trajectory_count = 0;
+
+    // Capture initial direction for break computation
+    float vmag = std::sqrt(ball.vx * ball.vx + ball.vy * ball.vy);
+    if (vmag > 1e-6f) {
+        m.dir_x = ball.vx / vmag;
+        m.dir_y = ball.vy / vmag;
+        m.has_direction = true;
+    } else {
+        m.has_direction = false;
+    }
+    m.frames_below_threshold = 0;
 }
 
-std::vector<PuttData> PuttStats::history() const {
-    std::lock_guard<std::mutex> lock(mu_);
-    return history_;
+// ─── Trajectory ─────────────────────────────────────────────────────────────
+// Samples go to the slot's preallocated staging buffer (balls moving at the
+// same time would interleave in the arena) and are copied to the arena in
+// one block when the putt finishes.  Putts longer than
+// kMaxTrajectorySamples keep their first samples only.
+void PuttStats::record_sample(int slot, const TrackedObject& ball) {
+    PuttData& cur = motion_[slot].current;
+    if (cur.trajectory_count >= kMaxTrajectorySamples) return;
+
+    TrajectorySample& s =
+        staging_[static_cast<size_t>(slot) * kMaxTrajectorySamples + cur.trajectory_count];
+    s.t = cur.time_in_motion;
+    s.x = ball.x;
+    s.y = ball.y;
+    s.vx = ball.vx;
+    s.vy = ball.vy;
+    s.confidence = ball.confidence;
+    ++cur.trajectory_count;
 }
 
-PuttStats::SessionSummary PuttStats::session() const {
-    std::lock_guard<std::mutex> lock(mu_);
-    SessionSummary s;
-    s.total_putts = static_cast<int>(history_.size());
-    if (s.total_putts == 0) return s;
-
-    for (const auto& p : history_) {
-        s.avg_launch_speed += p.launch_speed;
-        s.avg_distance += p.total_distance;
-        s.avg_break += p.break_distance;
-        s.avg_time += p.time_in_motion;
-    }
-    float n = static_cast<float>(s.total_putts);
-    s.avg_launch_speed /= n;
-    s.avg_distance /= n;
-    s.avg_break /= n;
-    s.avg_time /= n;
-    return s;
+// ─── Session aggregates ─────────────────────────────────────────────────────
+void PuttStats::RunningStat::add(float v) {
+    if (n == 0) {
+        min = max = v;
+    } else {
+        min = std::min(min, v);
+        max = std::max(max, v);
+    }
+    ++n;
+    const double delta = v - mean;
+    mean += delta / n;
+    m2 += delta * (v - mean);
 }
 
-void PuttStats::finalize_putt() {
-    history_.push_back(current_);
+PuttStats::Aggregate PuttStats::RunningStat::get() const {
+    Aggregate a;
+    if (n == 0) return a;
+    a.min = min;
+    a.max = max;
+    a.mean = static_cast<float>(mean);
+    a.stddev = static_cast<float>(std::sqrt(m2 / n));
+    return a;
+}
+
+void PuttStats::finalize_putt(int slot) {
+    PuttData& cur = motion_[slot].current;
+    cur.putt_number = static_cast<int>(history_.size()) + 1;
+
+    const TrajectorySample* samples =
+        &staging_[static_cast<size_t>(slot) * kMaxTrajectorySamples];
+    cur.trajectory_begin = static_cast<uint32_t>(trajectories_.size());
+    if (!trajectories_.append(samples, cur.trajectory_count)) {
+        cur.trajectory_count = 0;   // arena full: keep the putt, drop its path
+    }
+
+    if (!history_.append(&cur)) {
+        std::cerr << "[PuttStats] History full – putt " << cur.putt_number
+                  << " not recorded\n";
+        return;
+    }
+
+    launch_.add(cur.launch_speed);
+    distance_.add(cur.total_distance);
+    break_.add(cur.break_distance);
+    time_.add(cur.time_in_motion);
+
+    const Meta meta{Meta::kVersion, history_.size(), launch_, distance_, break_, time_};
+    std::memcpy(history_.meta(), &meta, sizeof(meta));
+    publish_session();
+}
+
+void PuttStats::publish_session() {
+    SessionSummary s;
+    s.total_putts = launch_.n;
+    s.launch_speed = launch_.get();
+    s.distance = distance_.get();
+    s.break_distance = break_.get();
+    s.time_in_motion = time_.get();
+    s.avg_launch_speed = s.launch_speed.mean;
+    s.avg_distance = s.distance.mean;
+    s.avg_break = s.break_distance.mean;
+    s.avg_time = s.time_in_motion.mean;
+    session_.store(s);
 }
 
 }  // namespace golf
@@ -0,0 +1,424 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// recording.cpp  –  .golfrec Writer Thread, mmap Reader & Replay Backend
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "recording.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+
+namespace golf {
+
+namespace {
+
+constexpr char     kFileMagic[8] = "GOLFREC";
+constexpr char     kIndexMagic[8] = "GOLFIDX";
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kChunkMagic = 0x304d5246;      // "FRM0"
+
+struct IndexTrailer {
+    uint64_t count;                   // chunk offsets in the index
+    uint64_t index_offset;
+    char     magic[8];                // "GOLFIDX"
+};
+
+static_assert(sizeof(RecordingHeader) == 64, "header layout");
+static_assert(sizeof(ChunkHeader) % 8 == 0, "chunks stay 8-byte aligned");
+static_assert(alignof(Detection) <= 8, "detections follow the chunk header unpadded");
+static_assert(std::is_trivially_copyable<ChunkHeader>::value &&
+              std::is_trivially_copyable<Detection>::value,
+              "written as raw bytes");
+
+constexpr size_t align8(size_t n) { return (n + 7) & ~size_t(7); }
+
+}  // namespace
+
+bool parse_frame_encoding(const std::string& name, FrameEncoding& out) {
+    if (name == "raw")  { out = FrameEncoding::RAW;  return true; }
+    if (name == "jpeg") { out = FrameEncoding::JPEG; return true; }
+    return false;
+}
+
+const char* frame_encoding_name(FrameEncoding encoding) {
+    switch (encoding) {
+        case FrameEncoding::RAW:  return "raw";
+        case FrameEncoding::JPEG: return "jpeg";
+    }
+    return "?";
+}
+
+bool is_recording(const std::string& path) {
+    static const std::string kExt = ".golfrec";
+    return path.size() > kExt.size() &&
+           path.compare(path.size() - kExt.size(), kExt.size(), kExt) == 0;
+}
+
+// ─── Writer ─────────────────────────────────────────────────────────────────
+RecordingWriter::~RecordingWriter() {
+    close();
+}
+
+bool RecordingWriter::open(const std::string& path, int bay, const Options& opts) {
+    close();
+    opts_ = opts;
+    opts_.slots = std::max(opts_.slots, 1);
+    path_ = path;
+
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        std::cerr << "[Recording] Cannot create " << path << ": "
+                  << std::strerror(errno) << "\n";
+        return false;
+    }
+    std::setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+
+    RecordingHeader header{};
+    std::memcpy(header.magic, kFileMagic, sizeof(header.magic));
+    header.version = kVersion;
+    header.chunk_header_size = sizeof(ChunkHeader);
+    header.detection_size = sizeof(Detection);
+    header.object_size = sizeof(TrackedObject);
+    header.bay = bay;
+    offset_ = 0;
+    if (!write_bytes(&header, sizeof(header))) {
+        std::fclose(file_);
+        file_ = nullptr;
+        return false;
+    }
+
+    slots_.assign(opts_.slots, Slot());
+    free_ = std::make_unique<SpscRing<int>>(opts_.slots);
+    filled_ = std::make_unique<SpscRing<int>>(opts_.slots);
+    for (int i = 0; i < opts_.slots; ++i) {
+        int idx = i;
+        free_->try_push(std::move(idx));
+    }
+    index_.clear();
+    failed_ = false;
+    has_start_ = false;
+    written_ = 0;
+    dropped_ = 0;
+
+    running_ = true;
+    thread_ = std::thread(&RecordingWriter::run, this);
+    std::cout << "[Recording] Writing bay " << bay << " to " << path << " ("
+              << frame_encoding_name(opts_.encoding) << ")\n";
+    return true;
+}
+
+void RecordingWriter::record(const cv::Mat& frame, uint64_t seq, double source_time,
+                             std::chrono::steady_clock::time_point capture_time,
+                             const std::vector<Detection>& detections,
+                             const TrackedObject& ball, const TrackedObject& putter,
+                             const PuttData& stats) {
+    if (!running_) return;
+    if (!has_start_) {
+        start_ = capture_time;
+        has_start_ = true;
+    }
+    int idx = -1;
+    if (!free_->try_pop(idx)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Slot& s = slots_[idx];
+    ChunkHeader& h = s.header;
+    h = ChunkHeader{};
+    h.magic = kChunkMagic;
+    h.seq = seq;
+    h.source_time = source_time;
+    h.capture_time = std::chrono::duration<double>(capture_time - start_).count();
+    h.width = frame.cols;
+    h.height = frame.rows;
+    h.encoding = opts_.encoding;
+    h.num_detections = static_cast<uint32_t>(detections.size());
+    h.putt_number = stats.putt_number;
+    h.putt_state = stats.state;
+    h.ball = ball;
+    h.putter = putter;
+    frame.copyTo(s.frame);                      // reuses the slot's buffer
+    s.detections.assign(detections.begin(), detections.end());
+
+    filled_->try_push(std::move(idx));          // can't fail: one ring slot per Slot
+}
+
+void RecordingWriter::run() {
+    for (;;) {
+        int idx = -1;
+        if (!filled_->try_pop(idx)) {
+            if (!running_) break;               // drained after close()
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            continue;
+        }
+        // After a failed write the file ends mid-chunk: stop appending, so
+        // the reader's chunk walk still recovers everything before it
+        if (failed_ || !write_slot(slots_[idx])) {
+            failed_ = true;
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        free_->try_push(std::move(idx));
+    }
+}
+
+bool RecordingWriter::write_slot(Slot& s) {
+    ChunkHeader& h = s.header;
+    const uint8_t* image = s.frame.data;
+    size_t image_bytes = s.frame.empty() ? 0 : s.frame.total() * s.frame.elemSize();
+    if (image_bytes && h.encoding == FrameEncoding::JPEG) {
+        const std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, opts_.quality};
+        if (!cv::imencode(".jpg", s.frame, jpeg_, params)) return false;
+        image = jpeg_.data();
+        image_bytes = jpeg_.size();
+    } else if (image_bytes && !s.frame.isContinuous()) {
+        s.frame = s.frame.clone();
+        image = s.frame.data;
+    }
+    const size_t det_bytes = s.detections.size() * sizeof(Detection);
+    const size_t unpadded = sizeof(ChunkHeader) + det_bytes + image_bytes;
+    h.image_bytes = static_cast<uint32_t>(image_bytes);
+    h.bytes = static_cast<uint32_t>(align8(unpadded));
+
+    static const uint8_t kPad[8] = {};
+    const uint64_t at = offset_;
+    if (!write_bytes(&h, sizeof(h)) ||
+        (det_bytes && !write_bytes(s.detections.data(), det_bytes)) ||
+        (image_bytes && !write_bytes(image, image_bytes)) ||
+        !write_bytes(kPad, h.bytes - unpadded)) {
+        return false;
+    }
+    index_.push_back(at);
+    written_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool RecordingWriter::write_bytes(const void* data, size_t n) {
+    if (n && std::fwrite(data, 1, n, file_) != n) {
+        std::cerr << "[Recording] Write to " << path_ << " failed: "
+                  << std::strerror(errno) << "\n";
+        return false;
+    }
+    offset_ += n;
+    return true;
+}
+
+void RecordingWriter::close() {
+    if (!file_) return;
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    if (failed_) {                              // index would not match the file
+        std::fclose(file_);
+        file_ = nullptr;
+        return;
+    }
+    IndexTrailer trailer{};
+    trailer.count = index_.size();
+    trailer.index_offset = offset_;
+    std::memcpy(trailer.magic, kIndexMagic, sizeof(trailer.magic));
+    write_bytes(index_.data(), index_.size() * sizeof(uint64_t));
+    write_bytes(&trailer, sizeof(trailer));
+    std::fclose(file_);
+    file_ = nullptr;
+    std::cout << "[Recording] " << path_ << ": " << written() << " frames ("
+              << dropped() << " dropped)\n";
+}
+
+// ─── Reader ─────────────────────────────────────────────────────────────────
+RecordingReader::~RecordingReader() {
+    close();
+}
+
+bool RecordingReader::open(const std::string& path) {
+    close();
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "[Recording] Cannot open " << path << ": "
+                  << std::strerror(errno) << "\n";
+        return false;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(RecordingHeader)) {
+        std::cerr << "[Recording] " << path << " is not a recording\n";
+        ::close(fd);
+        return false;
+    }
+    const size_t file_size = static_cast<size_t>(st.st_size);
+    void* p = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        std::cerr << "[Recording] mmap failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    madvise(p, file_size, MADV_SEQUENTIAL);
+    data_ = static_cast<const uint8_t*>(p);
+    size_ = file_size;
+
+    const auto& h = *reinterpret_cast<const RecordingHeader*>(data_);
+    if (std::memcmp(h.magic, kFileMagic, sizeof(h.magic)) != 0 || h.version != kVersion ||
+        h.chunk_header_size != sizeof(ChunkHeader) ||
+        h.detection_size != sizeof(Detection) || h.object_size != sizeof(TrackedObject)) {
+        std::cerr << "[Recording] " << path << ": unsupported format or layout\n";
+        close();
+        return false;
+    }
+    bay_ = h.bay;
+
+    if (!load_index(file_size)) {
+        scan(file_size);
+        std::cerr << "[Recording] " << path << ": no index (recording was not closed), "
+                  << chunks_.size() << " frames recovered\n";
+    }
+    return true;
+}
+
+// Offsets and sizes come from disk: each is checked against what holds it
+// before it is used, so a damaged file loses frames instead of reading
+// outside the mapping.
+bool RecordingReader::chunk_fits(uint64_t offset, uint64_t end) const {
+    if (offset % 8 != 0 || offset < sizeof(RecordingHeader) || offset > end ||
+        end - offset < sizeof(ChunkHeader)) {
+        return false;
+    }
+    const ChunkHeader& c = chunk_at(offset);
+    const uint64_t contents = sizeof(ChunkHeader) +
+        static_cast<uint64_t>(c.num_detections) * sizeof(Detection) + c.image_bytes;
+    return c.magic == kChunkMagic && c.bytes <= end - offset && contents <= c.bytes;
+}
+
+bool RecordingReader::load_index(size_t file_size) {
+    if (file_size < sizeof(RecordingHeader) + sizeof(IndexTrailer)) return false;
+    IndexTrailer t;
+    std::memcpy(&t, data_ + file_size - sizeof(t), sizeof(t));
+    const uint64_t index_end = file_size - sizeof(t);
+    if (std::memcmp(t.magic, kIndexMagic, sizeof(t.magic)) != 0 ||
+        t.index_offset > index_end ||
+        t.count != (index_end - t.index_offset) / sizeof(uint64_t) ||
+        (index_end - t.index_offset) % sizeof(uint64_t) != 0) {
+        return false;
+    }
+    chunks_.resize(t.count);
+    std::memcpy(chunks_.data(), data_ + t.index_offset, t.count * sizeof(uint64_t));
+    for (uint64_t off : chunks_) {
+        if (!chunk_fits(off, t.index_offset)) {
+            chunks_.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+void RecordingReader::scan(size_t file_size) {
+    chunks_.clear();
+    uint64_t off = sizeof(RecordingHeader);
+    while (chunk_fits(off, file_size)) {   // bytes ≥ sizeof(ChunkHeader)
+        chunks_.push_back(off);
+        off += chunk_at(off).bytes;
+    }
+}
+
+void RecordingReader::close() {
+    if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+    chunks_.clear();
+}
+
+const Detection* RecordingReader::detections(size_t i) const {
+    return reinterpret_cast<const Detection*>(data_ + chunks_[i] + sizeof(ChunkHeader));
+}
+
+bool RecordingReader::decode(size_t i, cv::Mat& frame) const {
+    const ChunkHeader& c = chunk(i);
+    if (c.image_bytes == 0) return false;
+    const uint8_t* image = reinterpret_cast<const uint8_t*>(detections(i) + c.num_detections);
+    if (c.encoding == FrameEncoding::RAW) {
+        if (c.image_bytes != static_cast<size_t>(c.width) * c.height * 3) return false;
+        cv::Mat(c.height, c.width, CV_8UC3, const_cast<uint8_t*>(image)).copyTo(frame);
+        return true;
+    }
+    cv::imdecode(cv::Mat(1, static_cast<int>(c.image_bytes), CV_8UC1,
+                         const_cast<uint8_t*>(image)),
+                 cv::IMREAD_COLOR, &frame);
+    return !frame.empty();
+}
+
+// ─── Replay Backend ─────────────────────────────────────────────────────────
+namespace {
+
+class ReplayCapture : public CaptureBackend {
+public:
+    bool open(const std::string& source, const CaptureOptions& opts) override {
+        if (!reader_.open(source) || reader_.size() == 0) return false;
+        speed_ = std::max(opts.replay_speed, 0.0);
+        const ChunkHeader& first = reader_.chunk(0);
+        std::cout << "[FramePipeline] Replaying: " << source << " (" << reader_.size()
+                  << " frames, " << first.width << "x" << first.height << ", ";
+        if (speed_ > 0) {
+            std::cout << speed_ << "x speed)\n";
+        } else {
+            std::cout << "as fast as possible)\n";
+        }
+        next_ = 0;
+        return true;
+    }
+
+    bool read(cv::Mat& frame, DeviceFrame&) override {
+        while (next_ < reader_.size()) {
+            const size_t i = next_++;
+            const ChunkHeader& c = reader_.chunk(i);
+            if (speed_ > 0) pace(c.capture_time);
+            if (!reader_.decode(i, frame)) continue;   // frame without image
+            timestamp_ = c.source_time >= 0.0 ? c.source_time : c.capture_time;
+            return true;
+        }
+        return false;
+    }
+
+    double timestamp() const override { return timestamp_; }
+    bool is_open() const override { return reader_.size() > 0; }
+    const char* name() const override { return "replay"; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Hold each frame until its recorded offset from the first one
+    void pace(double capture_time) {
+        const auto now = Clock::now();
+        if (!started_) {
+            started_ = true;
+            wall_start_ = now;
+            rec_start_ = capture_time;
+            return;
+        }
+        const auto due = wall_start_ + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>((capture_time - rec_start_) / speed_));
+        if (due > now) std::this_thread::sleep_until(due);
+    }
+
+    RecordingReader reader_;
+    double speed_ = 1.0;
+    size_t next_ = 0;
+    double timestamp_ = -1.0;
+    bool started_ = false;
+    Clock::time_point wall_start_;
+    double rec_start_ = 0.0;
+};
+
+}  // namespace
+
+std::unique_ptr<CaptureBackend> make_replay_capture() {
+    return std::make_unique<ReplayCapture>();
+}
+
+}  // namespace golf
@@ -0,0 +1,429 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// runtime_config.cpp  –  Config Parsing, Validation & Publication
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "runtime_config.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace golf {
+
+// ─── YAML Subset ────────────────────────────────────────────────────────────
+static std::string trim(const std::string& s) {
+    size_t b = 0, e = s.size();
+    while (b < e && std::isspace(static_cast<unsigned char>(s[b]))) ++b;
+    while (e > b && std::isspace(static_cast<unsigned char>(s[e - 1]))) --e;
+    return s.substr(b, e - b);
+}
+
+static std::string unquote(const std::string& s) {
+    if (s.size() >= 2 && (s.front() == '"' || s.front() == '\'') && s.back() == s.front()) {
+        return s.substr(1, s.size() - 2);
+    }
+    return s;
+}
+
+/// Line without its comment ("#" at the start or after whitespace, outside
+/// quotes).
+static std::string strip_comment(const std::string& line) {
+    char quote = 0;
+    for (size_t i = 0; i < line.size(); ++i) {
+        const char c = line[i];
+        if (quote) {
+            if (c == quote) quote = 0;
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '#' && (i == 0 || line[i - 1] == ' ' || line[i - 1] == '\t')) {
+            return line.substr(0, i);
+        }
+    }
+    return line;
+}
+
+static bool parse_yaml(const std::string& text, std::map<std::string, std::string>& out,
+                       std::string& error) {
+    struct Level {
+        int indent;
+        std::string prefix;          // dotted key of the open map
+    };
+    std::vector<Level> open;
+
+    std::istringstream in(text);
+    std::string raw;
+    for (int lineno = 1; std::getline(in, raw); ++lineno) {
+        if (!raw.empty() && raw.back() == '\r') raw.pop_back();
+        const std::string line = strip_comment(raw);
+        if (trim(line).empty()) continue;
+
+        size_t indent = 0;
+        while (indent < line.size() && line[indent] == ' ') ++indent;
+        const std::string content = trim(line.substr(indent));
+        auto fail = [&](const char* msg) {
+            error = "line " + std::to_string(lineno) + ": " + msg;
+            return false;
+        };
+        if (line[indent] == '\t') return fail("tabs are not allowed for indentation");
+        if (content[0] == '-') return fail("lists are not supported");
+
+        // "key: value" or "key:" (opens a nested map)
+        size_t colon = std::string::npos;
+        for (size_t i = 0; i < content.size(); ++i) {
+            if (content[i] == ':' && (i + 1 == content.size() || content[i + 1] == ' ')) {
+                colon = i;
+                break;
+            }
+        }
+        if (colon == std::string::npos) return fail("expected \"key: value\"");
+        const std::string key = unquote(trim(content.substr(0, colon)));
+        const std::string value = trim(content.substr(colon + 1));
+        if (key.empty()) return fail("empty key");
+        if (!value.empty() && (value[0] == '{' || value[0] == '[' ||
+                               value[0] == '&' || value[0] == '*' ||
+                               value[0] == '|' || value[0] == '>')) {
+            return fail("only plain scalar values are supported");
+        }
+
+        while (!open.empty() && open.back().indent >= static_cast<int>(indent)) open.pop_back();
+        const std::string full = open.empty() ? key : open.back().prefix + "." + key;
+        if (value.empty()) {
+            open.push_back({static_cast<int>(indent), full});
+        } else {
+            out[full] = unquote(value);
+        }
+    }
+    return true;
+}
+
+// ─── JSON ───────────────────────────────────────────────────────────────────
+// Objects of strings, numbers and booleans – what a config document needs.
+namespace {
+
+class JsonReader {
+public:
+    JsonReader(const std::string& s, std::map<std::string, std::string>& out)
+        : s_(s), out_(out) {}
+
+    bool document(std::string& error) {
+        ws();
+        if (!object("")) {
+            error = "offset " + std::to_string(i_) + ": " + error_;
+            return false;
+        }
+        ws();
+        if (i_ != s_.size()) {
+            error = "offset " + std::to_string(i_) + ": trailing characters";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    void ws() {
+        while (i_ < s_.size() && std::isspace(static_cast<unsigned char>(s_[i_]))) ++i_;
+    }
+
+    bool fail(const char* msg) {
+        error_ = msg;
+        return false;
+    }
+
+    bool object(const std::string& prefix) {
+        if (i_ >= s_.size() || s_[i_] != '{') return fail("expected an object");
+        ++i_;
+        ws();
+        if (i_ < s_.size() && s_[i_] == '}') {
+            ++i_;
+            return true;
+        }
+        for (;;) {
+            std::string key;
+            ws();
+            if (!string(key)) return false;
+            ws();
+            if (i_ >= s_.size() || s_[i_] != ':') return fail("expected ':'");
+            ++i_;
+            ws();
+            if (!value(prefix.empty() ? key : prefix + "." + key)) return false;
+            ws();
+            if (i_ < s_.size() && s_[i_] == ',') {
+                ++i_;
+                continue;
+            }
+            if (i_ < s_.size() && s_[i_] == '}') {
+                ++i_;
+                return true;
+            }
+            return fail("expected ',' or '}'");
+        }
+    }
+
+    bool value(const std::string& key) {
+        if (i_ >= s_.size()) return fail("unexpected end");
+        const char c = s_[i_];
+        if (c == '{') return object(key);
+        if (c == '[') return fail("arrays are not supported");
+        if (c == '"') {
+            std::string v;
+            if (!string(v)) return false;
+            out_[key] = v;
+            return true;
+        }
+        for (const char* word : {"true", "false"}) {
+            const size_t n = std::strlen(word);
+            if (s_.compare(i_, n, word) == 0) {
+                out_[key] = word;
+                i_ += n;
+                return true;
+            }
+        }
+        const size_t begin = i_;
+        while (i_ < s_.size() && s_[i_] != '\0' &&
+               (std::isdigit(static_cast<unsigned char>(s_[i_])) ||
+                std::strchr("+-.eE", s_[i_]))) {
+            ++i_;
+        }
+        if (i_ == begin) return fail("expected a value");
+        out_[key] = s_.substr(begin, i_ - begin);
+        return true;
+    }
+
+    bool string(std::string& out) {
+        if (i_ >= s_.size() || s_[i_] != '"') return fail("expected a string");
+        ++i_;
+        while (i_ < s_.size() && s_[i_] != '"') {
+            char c = s_[i_++];
+            if (c == '\\') {
+                if (i_ >= s_.size()) break;
+                c = s_[i_++];
+                if (c == 'n') c = '\n';
+                else if (c == 't') c = '\t';
+                else if (c != '"' && c != '\\' && c != '/') return fail("unsupported escape");
+            }
+            out += c;
+        }
+        if (i_ >= s_.size()) return fail("unterminated string");
+        ++i_;
+        return true;
+    }
+
+    const std::string& s_;
+    std::map<std::string, std::string>& out_;
+    size_t i_ = 0;
+    std::string error_;
+};
+
+}  // namespace
+
+bool parse_config(const std::string& text, std::map<std::string, std::string>& out,
+                  std::string& error) {
+    const std::string t = trim(text);
+    if (!t.empty() && t[0] == '{') return JsonReader(t, out).document(error);
+    return parse_yaml(text, out, error);
+}
+
+// ─── Settings ───────────────────────────────────────────────────────────────
+static bool to_float(const std::string& v, float lo, float hi, float& out,
+                     std::string& error) {
+    char* end = nullptr;
+    const double d = std::strtod(v.c_str(), &end);
+    if (v.empty() || *end != '\0' || !(d >= lo && d <= hi)) {
+        char buf[96];
+        std::snprintf(buf, sizeof(buf), "expected a number in [%g, %g]", lo, hi);
+        error = buf;
+        return false;
+    }
+    out = static_cast<float>(d);
+    return true;
+}
+
+static bool to_int(const std::string& v, int lo, int hi, int& out, std::string& error) {
+    char* end = nullptr;
+    const long n = std::strtol(v.c_str(), &end, 10);
+    if (v.empty() || *end != '\0' || n < lo || n > hi) {
+        error = "expected an integer in [" + std::to_string(lo) + ", " +
+                std::to_string(hi) + "]";
+        return false;
+    }
+    out = static_cast<int>(n);
+    return true;
+}
+
+/// Set one per-bay setting by its key below the bay ("tracker.alpha").
+static bool set_param(BayParams& p, const std::string& key, const std::string& v,
+                      std::string& error) {
+    if (key == "detection.conf_thresh")     return to_float(v, 0.f, 1.f, p.conf_thresh, error);
+    if (key == "tracker.alpha")             return to_float(v, 0.01f, 1.f, p.tracker.alpha, error);
+    if (key == "tracker.max_lost")          return to_int(v, 1, 100000, p.tracker.max_lost, error);
+    if (key == "tracker.process_noise")     return to_float(v, 1e-6f, 1e12f, p.tracker.kalman.process_noise, error);
+    if (key == "tracker.measurement_noise") return to_float(v, 1e-6f, 1e6f, p.tracker.kalman.measurement_noise, error);
+    if (key == "tracker.gate")              return to_float(v, 0.1f, 1e6f, p.tracker.kalman.gate, error);
+    if (key == "putt.motion_threshold")     return to_float(v, 0.f, 1e6f, p.motion_threshold, error);
+    if (key == "putt.stop_frames")          return to_int(v, 1, 100000, p.stop_frames, error);
+    if (key == "tracker.model") {
+        if (parse_tracker_model(v, p.tracker.model)) return true;
+        error = "expected ema or kalman";
+        return false;
+    }
+    error = "unknown setting";
+    return false;
+}
+
+// ─── RuntimeConfig ──────────────────────────────────────────────────────────
+RuntimeConfig::RuntimeConfig(int bays, const BayParams& defaults) : defaults_(defaults) {
+    for (int b = 0; b < bays; ++b) {
+        bays_.push_back(std::make_unique<SeqLock<BayParams>>());
+        bays_.back()->store(defaults);
+    }
+}
+
+bool RuntimeConfig::resolve(const Document& doc, std::vector<BayParams>& out,
+                            std::string& error) const {
+    out.assign(bays_.size(), defaults_);
+    static const std::string kBays = "bays.";
+
+    // Settings for every bay first, then the per-bay overrides
+    for (const auto& [key, value] : doc) {
+        if (key.compare(0, kBays.size(), kBays) == 0) continue;
+        for (BayParams& p : out) {
+            if (!set_param(p, key, value, error)) {
+                error = key + ": " + error;
+                return false;
+            }
+        }
+    }
+    for (const auto& [key, value] : doc) {
+        if (key.compare(0, kBays.size(), kBays) != 0) continue;
+        const size_t dot = key.find('.', kBays.size());
+        const std::string index = key.substr(kBays.size(), dot - kBays.size());
+        int bay = -1;
+        if (dot == std::string::npos || !to_int(index, 0, size() - 1, bay, error)) {
+            error = key + ": not a bay (0 .. " + std::to_string(size() - 1) + ")";
+            return false;
+        }
+        if (!set_param(out[bay], key.substr(dot + 1), value, error)) {
+            error = key + ": " + error;
+            return false;
+        }
+    }
+    return true;
+}
+
+void RuntimeConfig::publish(const Document& doc, const std::vector<BayParams>& params) {
+    doc_ = doc;
+    for (size_t b = 0; b < bays_.size(); ++b) bays_[b]->store(params[b]);
+    version_.fetch_add(1, std::memory_order_release);
+}
+
+static bool read_file(const std::string& path, std::string& text, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot read " + path;
+        return false;
+    }
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    text = ss.str();
+    return true;
+}
+
+bool RuntimeConfig::load(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        path_ = path;
+    }
+    std::string error;
+    if (!reload(error)) {
+        std::cerr << "[Config] " << error << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool RuntimeConfig::reload(std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (path_.empty()) {
+        error = "no config file to reload (start with --config)";
+        return false;
+    }
+    std::string text;
+    Document doc;
+    std::vector<BayParams> params;
+    if (!read_file(path_, text, error)) return false;
+    if (!parse_config(text, doc, error) || !resolve(doc, params, error)) {
+        error = path_ + ": " + error;
+        return false;
+    }
+    publish(doc, params);
+    std::cout << "[Config] Loaded " << doc.size() << " setting(s) from " << path_
+              << " (version " << version() << ")\n";
+    return true;
+}
+
+bool RuntimeConfig::apply(const std::string& text, std::string& error) {
+    Document update;
+    if (!parse_config(text, update, error)) return false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Document doc = doc_;
+    for (auto& [key, value] : update) doc[key] = std::move(value);
+    std::vector<BayParams> params;
+    if (!resolve(doc, params, error)) return false;
+    publish(doc, params);
+    std::cout << "[Config] Applied " << update.size() << " setting(s) (version "
+              << version() << ")\n";
+    return true;
+}
+
+static std::string json_string(const std::string& s) {
+    std::string out = "\"";
+    for (const char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+std::string RuntimeConfig::to_json() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out = "{\"version\":" + std::to_string(version()) +
+                      ",\"file\":" + json_string(path_) + ",\"settings\":{";
+    bool first = true;
+    for (const auto& [key, value] : doc_) {
+        out += (first ? "" : ",") + json_string(key) + ":" + json_string(value);
+        first = false;
+    }
+    out += "},\"bays\":[";
+
+    char buf[384];
+    for (int b = 0; b < size(); ++b) {
+        const BayParams p = bay(b);
+        std::snprintf(buf, sizeof(buf),
+            "%s{\"bay\":%d,\"detection\":{\"conf_thresh\":%g},"
+            "\"tracker\":{\"model\":\"%s\",\"alpha\":%g,\"max_lost\":%d,"
+            "\"process_noise\":%g,\"measurement_noise\":%g,\"gate\":%g},"
+            "\"putt\":{\"motion_threshold\":%g,\"stop_frames\":%d}}",
+            b ? "," : "", b, p.conf_thresh,
+            p.tracker.model == TrackerModel::KALMAN ? "kalman" : "ema",
+            p.tracker.alpha, p.tracker.max_lost, p.tracker.kalman.process_noise,
+            p.tracker.kalman.measurement_noise, p.tracker.kalman.gate,
+            p.motion_threshold, p.stop_frames);
+        out += buf;
+    }
+    return out + "]}";
+}
+
+}  // namespace golf
@@ -0,0 +1,607 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// staged_pipeline.cpp  –  Threaded Stage Loops & Queue Hand-off
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "staged_pipeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace golf {
+
+// ─── Helpers ────────────────────────────────────────────────────────────────
+// Spin briefly, then yield, then sleep – keeps hand-off latency in the
+// microsecond range without burning a core while a stage is idle.
+static void backoff(int& spins) {
+    if (spins < 64) {
+        ++spins;
+    } else if (spins < 128) {
+        ++spins;
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+// ─── Lifecycle ──────────────────────────────────────────────────────────────
+StagedPipeline::StagedPipeline(std::vector<FramePipeline*> sources,
+                               EnginePool& engines, const PipelineOptions& opts,
+                               LatencyMetrics* metrics)
+    : sources_(std::move(sources)), engines_(engines), opts_(opts),
+      metrics_(metrics),
+      pool_(pool_capacity(static_cast<int>(sources_.size()), opts, engines),
+            opts.preprocess == PreprocessMode::CPU ? engines.input_volume() : 0,
+            static_cast<size_t>(engines.output_length() / 6)) {
+    capture_q_    = make_queues("capture");
+    preprocess_q_ = make_queues("preprocess");
+    infer_q_      = make_queues("inference");
+    conf_thresh_ = std::make_unique<std::atomic<float>[]>(num_sources());
+    roi_full_interval_ = std::make_unique<std::atomic<int>[]>(num_sources());
+    for (int i = 0; i < num_sources(); ++i) {
+        hints_.push_back(std::make_unique<BallHint>());
+        conf_thresh_[i].store(opts.conf_thresh, std::memory_order_relaxed);
+        roi_full_interval_[i].store(opts.roi_full_interval, std::memory_order_relaxed);
+    }
+
+    // Split a round of cameras over the GPUs rather than queueing it all
+    // on one of them
+    const int devices = engines_.num_devices();
+    batch_limit_ = std::clamp((num_sources() + devices - 1) / devices,
+                              1, engines_.max_batch());
+    for (int i = 0; i < engines_.size(); ++i) {
+        auto ctx = std::make_unique<InferContext>();
+        ctx->batch.reserve(batch_limit_);
+        ctx->order.reserve(batch_limit_);
+        contexts_.push_back(std::move(ctx));
+    }
+    reorder_.resize(num_sources());
+    for (Reorder& r : reorder_) r.ring.resize(kReorderDepth * engines_.size());
+}
+
+StagedPipeline::~StagedPipeline() {
+    stop();
+    // GPU staging is freed on the device it was allocated on
+    for (int i = 0; i < engines_.size(); ++i) {
+        engines_.engine(i).activate();
+        contexts_[i].reset();
+    }
+}
+
+// Enough contexts for every frame that can be alive at once: one being
+// captured and a full ring at each hand-off per source, the frames in
+// flight or waiting for reordering, and the one the output stage holds.
+size_t StagedPipeline::pool_capacity(int sources, const PipelineOptions& opts,
+                                     const EnginePool& engines) {
+    size_t ring = 1;
+    while (ring < opts.queue_depth) ring <<= 1;
+    return static_cast<size_t>(sources) *
+               (3 * ring + 2 + static_cast<size_t>(kReorderDepth * engines.size())) + 1;
+}
+
+void StagedPipeline::start() {
+    if (running_.exchange(true)) return;
+    for (int i = 0; i < num_sources(); ++i) {
+        capture_threads_.emplace_back(&StagedPipeline::capture_loop, this, i);
+    }
+    if (opts_.preprocess == PreprocessMode::CPU) {
+        preprocess_thread_ = std::thread(&StagedPipeline::preprocess_loop, this);
+    } else {
+        close(preprocess_q_);   // inference pulls from capture
+    }
+    infer_thread_ = std::thread(&StagedPipeline::infer_loop, this);
+    std::cout << "[StagedPipeline] Started " << num_sources()
+              << " source(s) (queue depth " << opts_.queue_depth << ", policy "
+              << (opts_.drop_policy == DropPolicy::LATEST ? "latest" : "block")
+              << ", " << (opts_.preprocess == PreprocessMode::GPU ? "GPU" : "CPU")
+              << " preprocess, "
+              << (opts_.postprocess == PostprocessMode::GPU ? "GPU" : "CPU")
+              << " decode, batch <= " << batch_limit_ << ", "
+              << engines_.size() << " contexts on " << engines_.num_devices()
+              << " GPU(s)" << (opts_.roi ? ", ROI tracking" : "") << ")\n";
+}
+
+void StagedPipeline::stop() {
+    running_ = false;
+    for (auto& t : capture_threads_) {
+        if (t.joinable()) t.join();
+    }
+    capture_threads_.clear();
+    if (preprocess_thread_.joinable()) preprocess_thread_.join();
+    if (infer_thread_.joinable())      infer_thread_.join();
+}
+
+// ─── Queue hand-off ─────────────────────────────────────────────────────────
+StagedPipeline::QueueSet StagedPipeline::make_queues(const char* stage) const {
+    QueueSet qs;
+    for (int i = 0; i < num_sources(); ++i) {
+        qs.push_back(std::make_unique<StageQueue>(
+            std::string(stage) + "[" + std::to_string(i) + "]", i,
+            opts_.queue_depth));
+    }
+    return qs;
+}
+
+void StagedPipeline::close(QueueSet& qs) {
+    for (auto& q : qs) q->closed.store(true, std::memory_order_release);
+}
+
+bool StagedPipeline::all_empty(const QueueSet& qs) {
+    for (const auto& q : qs) {
+        if (!q->ring.empty()) return false;
+    }
+    return true;
+}
+
+bool StagedPipeline::push(StageQueue& q, FrameItem&& item) {
+    int spins = 0;
+    while (!q.ring.try_push(std::move(item))) {
+        if (!running_) {
+            q.dropped.fetch_add(1, std::memory_order_relaxed);
+            pool_.release(item);
+            return false;
+        }
+        if (opts_.drop_policy == DropPolicy::LATEST) {
+            // Latest frame wins here too: evict the oldest queued frame
+            // rather than the new one, so a stalled consumer resumes on
+            // fresh frames
+            FrameItem stale;
+            if (q.ring.try_pop(stale)) {
+                q.dropped.fetch_add(1, std::memory_order_relaxed);
+                pool_.release(stale);
+                continue;
+            }
+            // Empty but not free: the consumer is still moving out of the
+            // slot – a moment
+        }
+        backoff(spins);
+    }
+    q.pushed.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool StagedPipeline::try_take(StageQueue& q, FrameItem& item) {
+    pool_.release(item);   // whatever the caller still held
+    if (!q.ring.try_pop(item)) return false;
+
+    if (opts_.drop_policy == DropPolicy::LATEST) {
+        // Latest frame wins: skip everything that queued up behind it.
+        FrameItem newer;
+        while (q.ring.try_pop(newer)) {
+            pool_.release(item);
+            item = std::move(newer);
+            q.dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    return true;
+}
+
+bool StagedPipeline::pop_any(QueueSet& qs, int& cursor, FrameItem& item) {
+    const int n = static_cast<int>(qs.size());
+    int spins = 0;
+    for (;;) {
+        for (int i = 0; i < n; ++i) {
+            const int idx = (cursor + i) % n;
+            if (try_take(*qs[idx], item)) {
+                cursor = (idx + 1) % n;
+                return true;
+            }
+        }
+        if (!running_) return false;
+
+        bool all_closed = true;
+        for (const auto& q : qs) {
+            all_closed = all_closed && q->closed.load(std::memory_order_acquire);
+        }
+        if (all_closed) {
+            // Producers finished – one last look for anything pushed before
+            // the close flags were raised.
+            for (auto& q : qs) {
+                if (try_take(*q, item)) return true;
+            }
+            return false;
+        }
+        backoff(spins);
+    }
+}
+
+bool StagedPipeline::gather(QueueSet& qs, int& cursor,
+                            std::vector<FrameItem>& batch) {
+    batch.clear();
+    FrameItem item;
+    // A frame set aside for another GPU opens the next batch
+    if (!deferred_.empty()) {
+        item = std::move(deferred_.front());
+        deferred_.erase(deferred_.begin());
+    } else if (!pop_any(qs, cursor, item)) {
+        return false;
+    }
+    int device = item.device ? item.device.gpu : -1;
+    const int first = item.source;
+    batch.push_back(std::move(item));
+
+    // Add whatever the other sources already have ready – never wait for
+    // a slow camera, and at most one frame per source per batch.  Device
+    // frames only join a batch on their own GPU; the others wait in
+    // deferred_ (at most one per source) for a batch of their own.
+    const int n = static_cast<int>(qs.size());
+    for (int i = 0; i < n; ++i) {
+        if (static_cast<int>(batch.size()) >= batch_limit_) break;
+        const int idx = (cursor + i) % n;
+        if (idx == first) continue;
+        auto held = std::find_if(deferred_.begin(), deferred_.end(),
+                                 [idx](const FrameItem& d) { return d.source == idx; });
+        if (held != deferred_.end()) {
+            if (held->device && device >= 0 && held->device.gpu != device) continue;
+            item = std::move(*held);
+            deferred_.erase(held);
+        } else if (!try_take(*qs[idx], item)) {
+            continue;
+        }
+        if (item.device && device >= 0 && item.device.gpu != device) {
+            deferred_.push_back(std::move(item));
+            continue;
+        }
+        if (item.device) device = item.device.gpu;
+        batch.push_back(std::move(item));
+    }
+    return true;
+}
+
+bool StagedPipeline::next(FrameItem& item) {
+    return pop_any(infer_q_, next_cursor_, item);
+}
+
+std::vector<StageStats> StagedPipeline::stats() const {
+    std::vector<StageStats> out;
+    for (const QueueSet* qs : {&capture_q_, &preprocess_q_, &infer_q_}) {
+        for (const auto& q : *qs) {
+            out.push_back({q->name, q->source, q->ring.size(), q->ring.capacity(),
+                           q->pushed.load(std::memory_order_relaxed),
+                           q->dropped.load(std::memory_order_relaxed)});
+        }
+    }
+    return out;
+}
+
+// ─── ROI selection ──────────────────────────────────────────────────────────
+void StagedPipeline::update_ball_hint(int source, const TrackedObject& ball,
+                                      std::chrono::steady_clock::time_point at) {
+    BallHint& hint = *hints_[source];
+    std::lock_guard<std::mutex> lock(hint.mutex);
+    hint.valid = ball.valid && ball.frames_since_seen == 0;
+    hint.x = ball.x;
+    hint.y = ball.y;
+    hint.vx = ball.vx;
+    hint.vy = ball.vy;
+    hint.time = at;
+}
+
+cv::Rect StagedPipeline::choose_roi(const FrameItem& item) {
+    const cv::Size size = item.size();
+    const cv::Rect full(0, 0, size.width, size.height);
+    const int w = engines_.input_w();
+    const int h = engines_.input_h();
+    if (!opts_.roi || w >= full.width || h >= full.height) return full;
+
+    BallHint& hint = *hints_[item.source];
+    bool valid;
+    float x, y, vx, vy;
+    std::chrono::steady_clock::time_point t;
+    {
+        std::lock_guard<std::mutex> lock(hint.mutex);
+        valid = hint.valid;
+        x = hint.x;  y = hint.y;
+        vx = hint.vx; vy = hint.vy;
+        t = hint.time;
+    }
+    const int interval = roi_full_interval_[item.source].load(std::memory_order_relaxed);
+    if (!valid || ++hint.crops_since_full > interval) {
+        hint.crops_since_full = 0;
+        return full;
+    }
+
+    // Predict where the ball is in this frame; the hint is usually a frame
+    // or two old by the time the next one reaches this stage.
+    float lead = std::chrono::duration<float>(item.capture_time - t).count();
+    lead = std::clamp(lead, 0.f, 0.25f);
+    const float cx = x + vx * lead;
+    const float cy = y + vy * lead;
+
+    const int x0 = std::clamp(static_cast<int>(std::lround(cx - w * 0.5f)),
+                              0, full.width - w);
+    const int y0 = std::clamp(static_cast<int>(std::lround(cy - h * 0.5f)),
+                              0, full.height - h);
+    return cv::Rect(x0, y0, w, h);
+}
+
+void StagedPipeline::prepare(FrameItem& item) {
+    item.roi = choose_roi(item);
+    const int net_w = engines_.input_w();
+    const int net_h = engines_.input_h();
+    item.transform = opts_.letterbox
+        ? ImageTransform::letterbox(item.roi.width, item.roi.height, net_w, net_h)
+        : ImageTransform::stretch(item.roi.width, item.roi.height, net_w, net_h);
+    item.transform.offset_x = static_cast<float>(item.roi.x);
+    item.transform.offset_y = static_cast<float>(item.roi.y);
+}
+
+// ─── Stage loops ────────────────────────────────────────────────────────────
+void StagedPipeline::capture_loop(int source) {
+    StageQueue& q = *capture_q_[source];
+    uint64_t seq = 0;
+    while (running_) {
+        FrameItem item = pool_.acquire();
+        {
+            StageTimer timer(metrics_, Stage::CAPTURE);
+            if (!sources_[source]->read(item.frame, item.device)) break;
+        }
+        item.source = source;
+        item.seq = seq++;
+        item.capture_time = std::chrono::steady_clock::now();
+        item.source_time = sources_[source]->timestamp();
+        if (governor_ && !governor_->admit(source, item.frame, item.capture_time)) {
+            pool_.release(item);
+            continue;
+        }
+        push(q, std::move(item));
+    }
+    q.closed.store(true, std::memory_order_release);
+}
+
+void StagedPipeline::preprocess_loop() {
+    int cursor = 0;
+    FrameItem item;
+    while (pop_any(capture_q_, cursor, item)) {
+        if (item.frame.empty()) {
+            std::cerr << "[StagedPipeline] CPU pre-processing needs host frames\n";
+            continue;
+        }
+        prepare(item);
+        {
+            StageTimer timer(metrics_, Stage::PREPROCESS);
+            FramePipeline::preprocess(item.frame(item.roi), engines_.input_h(),
+                                      engines_.input_w(), item.blob,
+                                      opts_.letterbox);
+        }
+        push(*preprocess_q_[item.source], std::move(item));
+    }
+    close(preprocess_q_);
+}
+
+void StagedPipeline::infer_loop() {
+    const bool gpu = opts_.preprocess == PreprocessMode::GPU;
+    QueueSet& in_q = gpu ? capture_q_ : preprocess_q_;
+    int cursor = 0;
+    bool warned_device = false;
+
+    std::vector<FrameItem> batch;
+    for (;;) {
+        collect();
+        // Nothing new to overlap with – don't sit on results in flight.
+        if (all_empty(in_q) && deferred_.empty()) drain();
+
+        if (!gather(in_q, cursor, batch)) break;
+
+        // Device-decoded frames are only readable on the GPU holding them
+        const int device = batch_device(batch);
+        if (device >= 0 && !engines_.has_device(device)) {
+            if (!warned_device) {
+                std::cerr << "[StagedPipeline] Frames decoded on GPU " << device
+                          << " but no engine runs there – dropping them\n";
+                warned_device = true;
+            }
+            for (FrameItem& item : batch) pool_.release(item);
+            batch.clear();
+            continue;
+        }
+
+        int ctx;
+        while ((ctx = engines_.acquire(static_cast<int>(batch.size()), device)) < 0) {
+            if (!finish_oldest(device)) break;
+        }
+        if (ctx < 0) {
+            for (FrameItem& item : batch) pool_.release(item);
+            batch.clear();
+            continue;
+        }
+        // A source that is a full ring ahead waits for its oldest frame
+        for (const FrameItem& item : batch) {
+            Reorder& r = reorder_[item.source];
+            while (r.count == r.ring.size()) finish(r.ring[r.head].ctx);
+        }
+
+        if (!enqueue(ctx, batch)) {
+            std::cerr << "[StagedPipeline] Inference failed on batch of "
+                      << batch.size() << " (GPU " << engines_.device(ctx) << ")\n";
+            engines_.release(ctx);
+            for (FrameItem& item : batch) pool_.release(item);
+            batch.clear();
+            continue;
+        }
+        admit(ctx, batch);
+    }
+
+    drain();
+    close(infer_q_);
+}
+
+int StagedPipeline::batch_device(const std::vector<FrameItem>& batch) {
+    for (const FrameItem& item : batch) {
+        if (item.device) return item.device.gpu;
+    }
+    return -1;
+}
+
+bool StagedPipeline::enqueue(int ctx, std::vector<FrameItem>& batch) {
+    const int n = static_cast<int>(batch.size());
+    InferContext& c = *contexts_[ctx];
+    TrtEngine& engine = engines_.engine(ctx);
+    const int slot = engines_.slot(ctx);
+    // Staging allocates and uploads on the context's device
+    if (!engine.activate()) return false;
+    if (opts_.preprocess == PreprocessMode::GPU) {
+        for (FrameItem& item : batch) prepare(item);
+    }
+
+    OutputStage* post = nullptr;
+    if (opts_.postprocess == PostprocessMode::GPU) {
+        GpuPostprocessor& gp = c.post;
+        if (!gp.set_batch(n)) return false;
+        for (int k = 0; k < n; ++k) {
+            const float conf = conf_thresh_[batch[k].source].load(std::memory_order_relaxed);
+            if (!gp.stage(k, batch[k].transform, conf)) return false;
+        }
+        post = &gp;
+    }
+
+    if (opts_.preprocess == PreprocessMode::GPU) {
+        GpuPreprocessor& pre = c.pre;
+        for (int k = 0; k < n; ++k) {
+            FrameItem& item = batch[k];
+            const bool staged = item.device
+                ? pre.stage_device(k, item.device.crop(item.roi),
+                                   engine.input_buffer(slot, k),
+                                   engines_.input_h(), engines_.input_w(),
+                                   item.transform, engine.stream(slot))
+                : pre.stage(k, item.frame(item.roi), engine.input_buffer(slot, k),
+                            engines_.input_h(), engines_.input_w(),
+                            item.transform);
+            if (!staged) return false;
+        }
+        pre.set_batch(n);
+        return engine.infer_async(slot, nullptr, &pre, n, post);
+    }
+
+    // CPU path: gather the per-frame blobs into the slot's pinned staging
+    const size_t image_bytes = engines_.input_volume() * sizeof(float);
+    for (int k = 0; k < n; ++k) {
+        std::memcpy(engine.host_input(slot, k), batch[k].blob.data(), image_bytes);
+    }
+    return engine.infer_async(slot, engine.host_input(slot), nullptr, n, post);
+}
+
+// ─── Completion & reordering ────────────────────────────────────────────────
+void StagedPipeline::admit(int ctx, std::vector<FrameItem>& batch) {
+    InferContext& c = *contexts_[ctx];
+    c.order.clear();
+    for (const FrameItem& item : batch) {
+        Reorder& r = reorder_[item.source];
+        const size_t idx = (r.head + r.count) % r.ring.size();
+        Reorder::Entry& e = r.ring[idx];
+        e.ctx = ctx;
+        e.done = false;
+        e.ok = false;
+        ++r.count;
+        c.order.push_back(idx);
+    }
+    c.ticket = tickets_++;
+    std::swap(c.batch, batch);   // batch gets the context's empty vector back
+}
+
+void StagedPipeline::finish(int ctx) {
+    InferContext& c = *contexts_[ctx];
+    if (c.batch.empty()) return;
+    const float* out = engines_.engine(ctx).wait(engines_.slot(ctx));
+    engines_.release(ctx, out ? record_gpu_timings(ctx) : -1.f);
+    if (!out) {
+        std::cerr << "[StagedPipeline] Inference failed on batch of "
+                  << c.batch.size() << " (GPU " << engines_.device(ctx) << ")\n";
+    }
+
+    for (size_t k = 0; k < c.batch.size(); ++k) {
+        FrameItem& item = c.batch[k];
+        const int source = item.source;
+        Reorder::Entry& e = reorder_[source].ring[c.order[k]];
+        if (out) {
+            item.device = DeviceFrame();   // hand the decode surface back
+            StageTimer timer(metrics_, Stage::PARSE);
+            decode(ctx, static_cast<int>(k), out, item);
+            e.ok = true;
+        } else {
+            pool_.release(item);
+        }
+        std::swap(e.item, item);
+        e.done = true;
+        flush(source);
+    }
+    c.batch.clear();
+}
+
+void StagedPipeline::flush(int source) {
+    Reorder& r = reorder_[source];
+    while (r.count > 0 && r.ring[r.head].done) {
+        Reorder::Entry& e = r.ring[r.head];
+        if (e.ok) push(*infer_q_[source], std::move(e.item));
+        e.ctx = -1;
+        e.done = false;
+        r.head = (r.head + 1) % r.ring.size();
+        --r.count;
+    }
+}
+
+void StagedPipeline::collect() {
+    for (int i = 0; i < engines_.size(); ++i) {
+        if (!contexts_[i]->batch.empty() && engines_.engine(i).ready(engines_.slot(i))) {
+            finish(i);
+        }
+    }
+}
+
+bool StagedPipeline::finish_oldest(int device) {
+    int oldest = -1;
+    for (int i = 0; i < engines_.size(); ++i) {
+        if (contexts_[i]->batch.empty()) continue;
+        if (device >= 0 && engines_.device(i) != device) continue;
+        if (oldest < 0 || contexts_[i]->ticket < contexts_[oldest]->ticket) oldest = i;
+    }
+    if (oldest < 0) return false;
+    finish(oldest);
+    return true;
+}
+
+void StagedPipeline::drain() {
+    while (finish_oldest(-1)) {}
+}
+
+void StagedPipeline::decode(int ctx, int k, const float* out, FrameItem& item) {
+    if (opts_.postprocess == PostprocessMode::GPU) {
+        const CompactDetections& r = contexts_[ctx]->post.result(k);
+        GpuPostprocessor::to_detections(r, item.detections);
+        Detection d;
+        item.gpu_decoded = true;
+        item.best_ball.reset();
+        item.best_putter.reset();
+        if (GpuPostprocessor::best(r, 0, d)) item.best_ball = d;
+        if (GpuPostprocessor::best(r, 1, d)) item.best_putter = d;
+        return;
+    }
+
+    // CPU reference path
+    const int len = engines_.output_length();
+    FramePipeline::parse_detections(
+        out + static_cast<size_t>(k) * len, len / 6,
+        conf_thresh_[item.source].load(std::memory_order_relaxed),
+        item.transform, item.detections);
+}
+
+float StagedPipeline::record_gpu_timings(int ctx) {
+    GpuTimings t;
+    if (!engines_.engine(ctx).timings(engines_.slot(ctx), t)) return -1.f;
+    if (!metrics_) return t.total_ms;
+
+    metrics_->record_ms(Stage::GPU_TOTAL, t.total_ms);
+    // GPU pre-processing is the input stage; CPU mode times it on its thread
+    if (t.stage_ms >= 0.f && opts_.preprocess == PreprocessMode::GPU) {
+        metrics_->record_ms(Stage::PREPROCESS, t.stage_ms);
+    }
+    if (t.h2d_ms >= 0.f && opts_.preprocess == PreprocessMode::CPU) {
+        metrics_->record_ms(Stage::H2D, t.h2d_ms);
+    }
+    if (t.infer_ms >= 0.f)  metrics_->record_ms(Stage::INFER, t.infer_ms);
+    if (t.output_ms >= 0.f) metrics_->record_ms(Stage::D2H, t.output_ms);
+    return t.total_ms;
+}
+
+}  // namespace golf
@@ -3,20 +3,39 @@
 // ─────────────────────────────────────────────────────────────────────────────
 
 #include "stats_api.h"
+#include "engine_pool.h"
 #include "httplib.h"
+#include "runtime_config.h"
+#include "unreal_events.h"
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
-#include <sstream>
 
 namespace golf {
 
+namespace {
+constexpr size_t kStreamBacklog = 256;        // events kept for Last-Event-ID
+constexpr int    kMaxSubscribers = 64;
+constexpr auto   kStreamPoll = std::chrono::milliseconds(20);
+constexpr auto   kHeartbeat = std::chrono::seconds(15);
+constexpr int    kMaxViewers = 8;               // MJPEG clients, all bays
+constexpr auto   kVideoWait = std::chrono::milliseconds(500);
+constexpr int    kRestWorkers = 16;             // requests beside the streams
+constexpr int    kMaxQueued = 256;              // accepted connections waiting
+}  // namespace
+
 static std::string putt_data_json(const PuttData& p) {
     char buf[512];
     std::snprintf(buf, sizeof(buf),
         "{"
             "\"putt_number\":%d,"
             "\"state\":\"%s\","
+            "\"ball_id\":%u,"
             "\"launch_speed\":%.2f,"
             "\"current_speed\":%.2f,"
             "\"peak_speed\":%.2f,"
@@ -24,19 +43,140 @@ static std::string putt_data_json(const PuttData& p) {
             "\"break_distance\":%.2f,"
             "\"time_in_motion\":%.2f,"
             "\"start_x\":%.2f,\"start_y\":%.2f,"
-            "\"final_x\":%.2f,\"final_y\":%.2f"
+            "\"final_x\":%.2f,\"final_y\":%.2f,"
+            "\"trajectory_samples\":%u"
         "}",
-        p.putt_number, p.state_str(),
+        p.putt_number, p.state_str(), p.ball_id,
         p.launch_speed, p.current_speed,
         p.peak_speed, p.total_distance,
         p.break_distance, p.time_in_motion,
         p.start_x, p.start_y,
-        p.final_x, p.final_y);
+        p.final_x, p.final_y,
+        p.trajectory_count);
     return buf;
 }
 
+// Flat row-major array, one row of kTrajectoryFields values per sample.
+static const char kTrajectoryFields[] =
+    "[\"t\",\"x\",\"y\",\"vx\",\"vy\",\"confidence\"]";
+
+static std::string trajectory_json(int bay, const PuttData& p,
+                                   const PuttStats::Trajectory& traj) {
+    std::string body;
+    body.reserve(64 + traj.size() * 48);
+    char buf[160];
+    std::snprintf(buf, sizeof(buf),
+        "{\"bay\":%d,\"putt_number\":%d,\"samples\":%zu,\"fields\":%s,\"data\":[",
+        bay, p.putt_number, traj.size(), kTrajectoryFields);
+    body += buf;
+    for (size_t i = 0; i < traj.size(); ++i) {
+        const TrajectorySample& s = traj[i];
+        std::snprintf(buf, sizeof(buf), "%s%.4f,%.1f,%.1f,%.1f,%.1f,%.2f",
+                      i ? "," : "", s.t, s.x, s.y, s.vx, s.vy, s.confidence);
+        body += buf;
+    }
+    body += "]}";
+    return body;
+}
+
+static std::string aggregate_json(const PuttStats::Aggregate& a) {
+    char buf[160];
+    std::snprintf(buf, sizeof(buf),
+        "{\"min\":%.2f,\"max\":%.2f,\"mean\":%.2f,\"stddev\":%.2f}",
+        a.min, a.max, a.mean, a.stddev);
+    return buf;
+}
+
+// {"error":"<msg>"} with the message escaped.
+static std::string error_json(const std::string& msg) {
+    std::string out = "{\"error\":\"";
+    for (const char c : msg) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += static_cast<unsigned char>(c) < 0x20 ? ' ' : c;
+    }
+    return out + "\"}";
+}
+
+// Resolve ?bay=N (default 0); -1 and a 404 body if it doesn't exist.
+static int select_bay(const std::vector<PuttStats*>& bays,
+                      const httplib::Request& req,
+                      httplib::Response& res) {
+    int bay = 0;
+    if (req.has_param("bay")) {
+        bay = std::atoi(req.get_param_value("bay").c_str());
+    }
+    if (bay < 0 || bay >= static_cast<int>(bays.size())) {
+        res.status = 404;
+        res.set_content("{\"error\":\"unknown bay\"}", "application/json");
+        return -1;
+    }
+    return bay;
+}
+
+static bool is_loopback(const std::string& addr) {
+    return addr.compare(0, 4, "127.") == 0 || addr == "::1" ||
+           addr.compare(0, 11, "::ffff:127.") == 0;
+}
+
+// Content-Type without parameters, lower-cased ("application/json").
+static std::string media_type(const httplib::Request& req) {
+    std::string type = req.get_header_value("Content-Type");
+    type = type.substr(0, type.find(';'));
+    while (!type.empty() && type.back() == ' ') type.pop_back();
+    for (char& c : type) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return type;
+}
+
+// Compares in time independent of where the strings differ.
+static bool same_token(const std::string& a, const std::string& b) {
+    unsigned char diff = a.size() == b.size() ? 0 : 1;
+    for (size_t i = 0; i < a.size(); ++i) {
+        diff |= static_cast<unsigned char>(a[i] ^ (i < b.size() ? b[i] : 0));
+    }
+    return diff == 0;
+}
+
+// Sets the ETag and answers 304 if the client already has this version.
+static bool not_modified(const httplib::Request& req, httplib::Response& res,
+                         const std::string& etag) {
+    res.set_header("ETag", etag);
+    if (req.get_header_value("If-None-Match") == etag) {
+        res.status = 304;
+        return true;
+    }
+    return false;
+}
+
 StatsApi::StatsApi(PuttStats& stats, uint16_t port)
-    : stats_(stats), port_(port) {}
+    : StatsApi(std::vector<PuttStats*>{&stats}, port) {}
+
+StatsApi::StatsApi(std::vector<PuttStats*> bays, uint16_t port)
+    : bays_(std::move(bays)), port_(port),
+      server_(std::make_unique<httplib::Server>()) {
+    for (size_t i = 0; i < bays_.size(); ++i) {
+        caches_.push_back(std::make_unique<HistoryCache>());
+    }
+    // Distinguishes this process's ETags from a previous run's
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%llx",
+        static_cast<unsigned long long>(
+            std::chrono::system_clock::now().time_since_epoch().count()));
+    instance_ = buf;
+}
+
+// ─── History cache ──────────────────────────────────────────────────────────
+// History is append-only, so the cache only ever serialises putts it hasn't
+// seen; `ends[i]` is the offset just past putt i's JSON (and its comma).
+size_t StatsApi::sync_history(int bay) {
+    HistoryCache& cache = *caches_[bay];
+    const auto hist = bays_[bay]->history();
+    for (size_t i = cache.ends.size(); i < hist.size(); ++i) {
+        cache.json += putt_data_json(hist[i]);
+        cache.json += ',';
+        cache.ends.push_back(cache.json.size());
+    }
+    return cache.ends.size();
+}
 
 StatsApi::~StatsApi() {
     stop();
@@ -44,45 +184,193 @@ StatsApi::~StatsApi() {
 
 void StatsApi::start() {
     if (running_.exchange(true)) return;
+    serving_ = true;
     thread_ = std::thread(&StatsApi::run, this);
+    stream_thread_ = std::thread(&StatsApi::stream_loop, this);
     std::cout << "[StatsApi] HTTP server starting on port " << port_ << "\n";
 }
 
 void StatsApi::stop() {
     running_ = false;
+    stream_cv_.notify_all();   // release open event streams
+    if (stream_thread_.joinable()) {
+        stream_thread_.join();
+    }
     if (thread_.joinable()) {
+        // decommission() makes a listen() that hasn't started yet return at
+        // once and stop() closes a running one, but a listen() between its
+        // two checks misses both – and stop() clears the decommission – so
+        // repeat until run() is out.
+        while (serving_) {
+            server_->stop();
+            server_->decommission();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
         thread_.join();
     }
 }
 
+// ─── Event stream ───────────────────────────────────────────────────────────
+void StatsApi::publish(int bay, const char* type, const PuttData& data) {
+    std::lock_guard<std::mutex> lock(stream_mutex_);
+    const uint64_t id = next_event_id_++;
+
+    std::string frame = "id: " + std::to_string(id) + "\nevent: " + type +
+                        "\ndata: {\"bay\":" + std::to_string(bay) +
+                        ",\"putt\":" + putt_data_json(data) + "}\n\n";
+    events_.push_back({id, bay, std::make_shared<const std::string>(std::move(frame))});
+    if (events_.size() > kStreamBacklog) events_.pop_front();
+    stream_cv_.notify_all();
+}
+
+// Polls the seqlock-published snapshots (never touches the tracking
+// thread), so the hot path pays nothing per subscriber.
+void StatsApi::stream_loop() {
+    struct Last {
+        bool valid = false;
+        PuttData data;
+        std::chrono::steady_clock::time_point sent;
+    };
+    std::vector<Last> last(bays_.size());
+    const auto min_gap = std::chrono::duration<double>(
+        stream_hz_ > 0 ? 1.0 / stream_hz_ : 1e9);
+
+    while (running_) {
+        const auto now = std::chrono::steady_clock::now();
+        for (size_t b = 0; b < bays_.size(); ++b) {
+            if (subscribers_ == 0) {
+                last[b].valid = false;
+                continue;
+            }
+            const PuttData d = bays_[b]->current();
+            Last& l = last[b];
+            if (!l.valid || d.state != l.data.state ||
+                d.putt_number != l.data.putt_number) {
+                publish(static_cast<int>(b), "putt", d);
+            } else if (now - l.sent >= min_gap &&
+                       std::memcmp(&d, &l.data, sizeof(d)) != 0) {
+                publish(static_cast<int>(b), "update", d);
+            } else {
+                continue;
+            }
+            l.valid = true;
+            l.data = d;
+            l.sent = now;
+        }
+        std::this_thread::sleep_for(kStreamPoll);
+    }
+}
+
 void StatsApi::run() {
-    httplib::Server svr;
+    httplib::Server& svr = *server_;
+
+    // Every stream subscriber and video viewer holds a worker for as long
+    // as it stays connected; httplib's default pool (4 × cores, at least
+    // 32) would be exhausted by them and stall every REST request behind
+    // them.  Size it so kRestWorkers remain with both caps reached.
+    svr.new_task_queue = [] {
+        return new httplib::ThreadPool(kRestWorkers,
+                                       kMaxSubscribers + kMaxViewers + kRestWorkers,
+                                       kMaxQueued);
+    };
 
     svr.set_default_headers({
         {"Access-Control-Allow-Origin", "*"},
         {"Access-Control-Allow-Methods", "GET, OPTIONS"},
-        {"Access-Control-Allow-Headers", "Content-Type"}
+        {"Access-Control-Allow-Headers", "Content-Type, If-None-Match"},
+        {"Access-Control-Expose-Headers", "ETag, X-Total-Count, X-Next-Since, X-Sample-Count"}
+    });
+
+    svr.Get("/api/bays", [this](const httplib::Request&, httplib::Response& res) {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "{\"bays\":%zu}", bays_.size());
+        res.set_content(buf, "application/json");
     });
 
-    svr.Get("/api/stats/current", [this](const httplib::Request&, httplib::Response& res) {
-        auto data = stats_.current();
+    svr.Get("/api/stats/current", [this](const httplib::Request& req, httplib::Response& res) {
+        const int bay = select_bay(bays_, req, res);
+        if (bay < 0) return;
+        auto data = bays_[bay]->current();
         res.set_content(putt_data_json(data), "application/json");
     });
 
-    svr.Get("/api/stats/history", [this](const httplib::Request&, httplib::Response& res) {
-        auto hist = stats_.history();
-        std::ostringstream oss;
-        oss << "[";
-        for (size_t i = 0; i < hist.size(); ++i) {
-            if (i > 0) oss << ",";
-            oss << putt_data_json(hist[i]);
+    // ?since=<putt_number> returns putts after that one, ?limit=N caps the
+    // page; X-Next-Since carries the cursor for the next page.
+    svr.Get("/api/stats/history", [this](const httplib::Request& req, httplib::Response& res) {
+        const int bay = select_bay(bays_, req, res);
+        if (bay < 0) return;
+        const long since = req.has_param("since")
+            ? std::max(0L, std::atol(req.get_param_value("since").c_str())) : 0L;
+        const long limit = req.has_param("limit")
+            ? std::max(0L, std::atol(req.get_param_value("limit").c_str())) : 0L;
+
+        HistoryCache& cache = *caches_[bay];
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        const size_t total = sync_history(bay);
+        const size_t first = std::min(static_cast<size_t>(since), total);
+        const size_t last = limit > 0
+            ? std::min(total, first + static_cast<size_t>(limit)) : total;
+
+        char etag[96];
+        std::snprintf(etag, sizeof(etag), "\"h%s-%d-%zu-%zu-%zu\"",
+                      instance_.c_str(), bay, total, first, last);
+        res.set_header("X-Total-Count", std::to_string(total));
+        if (last < total) res.set_header("X-Next-Since", std::to_string(last));
+        if (not_modified(req, res, etag)) return;
+
+        std::string body = "[";
+        if (last > first) {
+            const size_t from = first ? cache.ends[first - 1] : 0;
+            body.append(cache.json, from, cache.ends[last - 1] - from - 1);
+        }
+        body += "]";
+        res.set_content(body, "application/json");
+    });
+
+    // Finished putts only; their samples never change, so the ETag is final.
+    // ?format=binary returns the raw little-endian float32 rows instead.
+    svr.Get(R"(/api/stats/putt/(\d+)/trajectory)",
+            [this](const httplib::Request& req, httplib::Response& res) {
+        const int bay = select_bay(bays_, req, res);
+        if (bay < 0) return;
+        const auto hist = bays_[bay]->history();
+        const long n = std::atol(req.matches[1].str().c_str());
+        if (n < 1 || static_cast<size_t>(n) > hist.size()) {
+            res.status = 404;
+            res.set_content("{\"error\":\"unknown putt\"}", "application/json");
+            return;
+        }
+        const PuttData& putt = hist[static_cast<size_t>(n) - 1];
+        const auto traj = bays_[bay]->trajectory(putt);
+
+        // One ETag per representation, so a cached body never answers the
+        // other format's request
+        const bool binary = req.get_param_value("format") == "binary";
+        char etag[96];
+        std::snprintf(etag, sizeof(etag), "\"t%s-%d-%ld-%c\"",
+                      instance_.c_str(), bay, n, binary ? 'b' : 'j');
+        if (not_modified(req, res, etag)) return;
+
+        if (binary) {
+            res.set_header("X-Sample-Count", std::to_string(traj.size()));
+            res.set_content(reinterpret_cast<const char*>(traj.data()),
+                            traj.size() * sizeof(TrajectorySample),
+                            "application/octet-stream");
+        } else {
+            res.set_content(trajectory_json(bay, putt, traj), "application/json");
         }
-        oss << "]";
-        res.set_content(oss.str(), "application/json");
     });
 
-    svr.Get("/api/stats/session", [this](const httplib::Request&, httplib::Response& res) {
-        auto s = stats_.session();
+    svr.Get("/api/stats/session", [this](const httplib::Request& req, httplib::Response& res) {
+        const int bay = select_bay(bays_, req, res);
+        if (bay < 0) return;
+        const auto s = bays_[bay]->session();
+
+        char etag[64];
+        std::snprintf(etag, sizeof(etag), "\"s%s-%d-%d\"",
+                      instance_.c_str(), bay, s.total_putts);
+        if (not_modified(req, res, etag)) return;
+
         char buf[256];
         std::snprintf(buf, sizeof(buf),
             "{"
@@ -90,11 +378,221 @@ void StatsApi::run() {
                 "\"avg_launch_speed\":%.2f,"
                 "\"avg_distance\":%.2f,"
                 "\"avg_break\":%.2f,"
-                "\"avg_time\":%.2f"
-            "}",
+                "\"avg_time\":%.2f,",
             s.total_putts, s.avg_launch_speed,
             s.avg_distance, s.avg_break, s.avg_time);
-        res.set_content(buf, "application/json");
+        std::string body = buf;
+        body += "\"launch_speed\":" + aggregate_json(s.launch_speed);
+        body += ",\"distance\":" + aggregate_json(s.distance);
+        body += ",\"break_distance\":" + aggregate_json(s.break_distance);
+        body += ",\"time_in_motion\":" + aggregate_json(s.time_in_motion);
+        body += "}";
+        res.set_content(body, "application/json");
+    });
+
+    svr.Get("/api/stats/stream", [this](const httplib::Request& req, httplib::Response& res) {
+        int bay = -1;
+        if (req.has_param("bay")) {
+            bay = select_bay(bays_, req, res);
+            if (bay < 0) return;
+        }
+        if (++subscribers_ > kMaxSubscribers) {
+            --subscribers_;
+            res.status = 503;
+            res.set_content("{\"error\":\"too many subscribers\"}", "application/json");
+            return;
+        }
+
+        // Every connection starts with the current state of its bays; a
+        // reconnect with Last-Event-ID also replays what it missed (as far
+        // as the backlog reaches), otherwise only new events follow.
+        uint64_t resume = 0;
+        if (req.has_header("Last-Event-ID")) {
+            resume = std::strtoull(req.get_header_value("Last-Event-ID").c_str(),
+                                   nullptr, 10) + 1;
+        }
+        {
+            // An id from before a restart is ahead of this run's counter;
+            // there is nothing of it to replay
+            std::lock_guard<std::mutex> lock(stream_mutex_);
+            if (resume > next_event_id_) resume = next_event_id_;
+        }
+        auto cursor = std::make_shared<uint64_t>(resume);
+        auto primed = std::make_shared<bool>(false);
+
+        res.set_header("Cache-Control", "no-cache");
+        res.set_header("X-Accel-Buffering", "no");
+        res.set_chunked_content_provider("text/event-stream",
+            [this, bay, cursor, primed](size_t, httplib::DataSink& sink) {
+                std::vector<std::shared_ptr<const std::string>> out;
+                if (!*primed) {
+                    // Initial state straight from the snapshots
+                    *primed = true;
+                    std::string hello = "retry: 2000\n\n";
+                    for (size_t b = 0; b < bays_.size(); ++b) {
+                        if (bay >= 0 && static_cast<int>(b) != bay) continue;
+                        hello += "event: putt\ndata: {\"bay\":" + std::to_string(b) +
+                                 ",\"putt\":" + putt_data_json(bays_[b]->current()) +
+                                 "}\n\n";
+                    }
+                    if (!sink.write(hello.data(), hello.size())) return false;
+                }
+                {
+                    std::unique_lock<std::mutex> lock(stream_mutex_);
+                    if (*cursor == 0) *cursor = next_event_id_;
+                    stream_cv_.wait_for(lock, kHeartbeat, [&] {
+                        return !running_ || next_event_id_ > *cursor;
+                    });
+                    if (!running_) {
+                        lock.unlock();
+                        sink.done();
+                        return true;
+                    }
+                    for (const StreamEvent& e : events_) {
+                        if (e.id < *cursor) continue;
+                        if (bay < 0 || e.bay == bay) out.push_back(e.frame);
+                    }
+                    *cursor = next_event_id_;
+                }
+                if (out.empty()) {
+                    static const char ping[] = ": ping\n\n";
+                    return sink.write(ping, sizeof(ping) - 1);
+                }
+                for (const auto& frame : out) {
+                    if (!sink.write(frame->data(), frame->size())) return false;
+                }
+                return true;
+            },
+            [this](bool) { --subscribers_; });
+    });
+
+    svr.Get("/api/metrics", [this](const httplib::Request& req, httplib::Response& res) {
+        if (!metrics_) {
+            res.status = 404;
+            res.set_content("{\"error\":\"metrics disabled\"}", "application/json");
+            return;
+        }
+        const bool prometheus =
+            req.get_param_value("format") == "prometheus" ||
+            req.get_header_value("Accept").find("text/plain") != std::string::npos;
+        if (prometheus) {
+            std::string body = metrics_->to_prometheus();
+            if (traffic_) body += traffic_->to_prometheus();
+            if (channel_) body += channel_->to_prometheus();
+            if (governor_) body += governor_->to_prometheus();
+            if (engines_) body += engines_->to_prometheus();
+            res.set_content(body, "text/plain; version=0.0.4");
+        } else {
+            std::string body = metrics_->to_json();
+            if (traffic_) {
+                body.pop_back();   // reopen the top-level object
+                body += ",\"udp\":" + traffic_->to_json() + "}";
+            }
+            if (channel_) {
+                body.pop_back();
+                body += ",\"events\":" + channel_->to_json() + "}";
+            }
+            if (governor_) {
+                body.pop_back();
+                body += ",\"governor\":" + governor_->to_json() + "}";
+            }
+            if (engines_) {
+                body.pop_back();
+                body += ",\"engines\":" + engines_->to_json() + "}";
+            }
+            if (video_) {
+                body.pop_back();
+                body += ",\"video\":" + video_->to_json() + "}";
+            }
+            res.set_content(body, "application/json");
+        }
+    });
+
+    svr.Get("/api/config", [this](const httplib::Request&, httplib::Response& res) {
+        if (!config_) {
+            res.status = 404;
+            res.set_content("{\"error\":\"runtime config disabled\"}", "application/json");
+            return;
+        }
+        res.set_content(config_->to_json(), "application/json");
+    });
+
+    // Body (YAML or JSON) merged into the running config; an empty body
+    // re-reads the --config file.  The tracking thread picks the new
+    // values up between frames – nothing restarts.
+    //
+    // The only write endpoint: loopback clients or the --api-token only,
+    // and a JSON / YAML Content-Type, which a browser cannot send cross-
+    // origin without a preflight – and POST is not in the CORS methods.
+    svr.Post("/api/config", [this](const httplib::Request& req, httplib::Response& res) {
+        if (!config_) {
+            res.status = 404;
+            res.set_content("{\"error\":\"runtime config disabled\"}", "application/json");
+            return;
+        }
+        if (config_token_.empty() ? !is_loopback(req.remote_addr)
+                                  : !same_token(req.get_header_value("Authorization"),
+                                                "Bearer " + config_token_)) {
+            res.status = config_token_.empty() ? 403 : 401;
+            res.set_content(error_json(config_token_.empty()
+                                ? "config changes are only accepted from localhost"
+                                : "missing or wrong bearer token"),
+                            "application/json");
+            return;
+        }
+        const std::string mime = media_type(req);
+        if (mime != "application/json" && mime != "application/yaml") {
+            res.status = 415;
+            res.set_content(error_json("Content-Type must be application/json or "
+                                       "application/yaml"), "application/json");
+            return;
+        }
+        std::string error;
+        const bool blank = req.body.find_first_not_of(" \t\r\n") == std::string::npos;
+        if (!(blank ? config_->reload(error) : config_->apply(req.body, error))) {
+            res.status = 400;
+            res.set_content(error_json(error), "application/json");
+            return;
+        }
+        res.set_content(config_->to_json(), "application/json");
+    });
+
+    // Each viewer holds a server worker, so viewers are capped; the stream
+    // only renders and encodes a bay while its viewer count is non-zero.
+    svr.Get("/api/video", [this](const httplib::Request& req, httplib::Response& res) {
+        if (!video_) {
+            res.status = 404;
+            res.set_content("{\"error\":\"video stream disabled\"}", "application/json");
+            return;
+        }
+        const int bay = select_bay(bays_, req, res);
+        if (bay < 0) return;
+        if (++viewers_ > kMaxViewers) {
+            --viewers_;
+            res.status = 503;
+            res.set_content("{\"error\":\"too many viewers\"}", "application/json");
+            return;
+        }
+        video_->subscribe(bay);
+
+        auto seq = std::make_shared<uint64_t>(0);
+        res.set_header("Cache-Control", "no-cache, no-store");
+        res.set_header("X-Accel-Buffering", "no");
+        res.set_chunked_content_provider(
+            std::string("multipart/x-mixed-replace; boundary=") + VideoStream::boundary(),
+            [this, bay, seq](size_t, httplib::DataSink& sink) {
+                if (!running_ || !video_->running()) {
+                    sink.done();
+                    return true;
+                }
+                const auto part = video_->wait_part(bay, *seq, kVideoWait);
+                if (!part) return true;   // nothing new yet
+                return sink.write(part->data(), part->size());
+            },
+            [this, bay](bool) {
+                video_->unsubscribe(bay);
+                --viewers_;
+            });
     });
 
     svr.Options("/(.*)", [](const httplib::Request&, httplib::Response& res) {
@@ -104,6 +602,7 @@ void StatsApi::run() {
     while (running_) {
         svr.listen("0.0.0.0", port_);
     }
+    serving_ = false;
 }
 
 }  // namespace golf
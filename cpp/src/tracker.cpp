@@ -1,5 +1,5 @@
 // ─────────────────────────────────────────────────────────────────────────────
-// tracker.cpp  –  Ball & Putter EMA Tracker
+// tracker.cpp  –  Ball & Putter Tracker (EMA / Kalman)
 // ─────────────────────────────────────────────────────────────────────────────
 
 #include "tracker.h"
@@ -9,12 +9,43 @@
 
 namespace golf {
 
+bool parse_tracker_model(const std::string& name, TrackerModel& model) {
+    if (name == "ema") {
+        model = TrackerModel::EMA;
+    } else if (name == "kalman") {
+        model = TrackerModel::KALMAN;
+    } else {
+        return false;
+    }
+    return true;
+}
+
 Tracker::Tracker(float alpha, int max_lost)
     : alpha_(alpha), max_lost_(max_lost) {
     ball_.class_id = 0;
     putter_.class_id = 1;
 }
 
+Tracker::Tracker(const TrackerOptions& opts)
+    : model_(opts.model), alpha_(opts.alpha), max_lost_(opts.max_lost),
+      ball_kf_(opts.kalman), putter_kf_(opts.kalman) {
+    ball_.class_id = 0;
+    putter_.class_id = 1;
+}
+
+void Tracker::set_options(const TrackerOptions& opts) {
+    if (opts.model != model_) {
+        // Neither model's state can seed the other
+        ball_.valid = false;
+        putter_.valid = false;
+        model_ = opts.model;
+    }
+    alpha_ = opts.alpha;
+    max_lost_ = opts.max_lost;
+    ball_kf_.set_options(opts.kalman);
+    putter_kf_.set_options(opts.kalman);
+}
+
 void Tracker::update(const std::vector<Detection>& detections, double dt) {
     // Find best detection for each class (highest confidence)
     const Detection* best_ball = nullptr;
@@ -32,12 +63,28 @@ void Tracker::update(const std::vector<Detection>& detections, double dt) {
         }
     }
 
-    update_track(ball_, best_ball, dt);
-    update_track(putter_, best_putter, dt);
+    update_track(ball_, ball_kf_, best_ball, dt);
+    update_track(putter_, putter_kf_, best_putter, dt);
 }
 
-void Tracker::update_track(TrackedObject& track, const Detection* det,
-                           double dt) {
+void Tracker::update(const std::optional<Detection>& ball,
+                     const std::optional<Detection>& putter, double dt) {
+    update_track(ball_, ball_kf_, ball ? &*ball : nullptr, dt);
+    update_track(putter_, putter_kf_, putter ? &*putter : nullptr, dt);
+}
+
+void Tracker::update_track(TrackedObject& track, KalmanTracker& kf,
+                           const Detection* det, double dt) {
+    if (model_ == TrackerModel::KALMAN) {
+        update_kalman(track, kf, det, dt);
+    } else {
+        update_ema(track, det, dt);
+    }
+}
+
+// ─── EMA ────────────────────────────────────────────────────────────────────
+void Tracker::update_ema(TrackedObject& track, const Detection* det,
+                         double dt) {
     if (det) {
         float new_x = det->cx();
         float new_y = det->cy();
@@ -87,4 +134,35 @@ void Tracker::update_track(TrackedObject& track, const Detection* det,
     }
 }
 
+// ─── Kalman ─────────────────────────────────────────────────────────────────
+void Tracker::update_kalman(TrackedObject& track, KalmanTracker& kf,
+                            const Detection* det, double dt) {
+    if (det) {
+        if (!track.valid) {
+            kf.reset(det->cx(), det->cy(), det->confidence);
+        } else {
+            kf.predict(dt);
+            kf.correct(det->cx(), det->cy(), det->confidence);
+        }
+        track.confidence = det->confidence;
+        track.frames_since_seen = 0;
+        track.valid = true;
+    } else {
+        track.frames_since_seen++;
+        if (track.frames_since_seen > max_lost_) {
+            track.valid = false;
+            track.vx = 0.f;
+            track.vy = 0.f;
+            return;
+        }
+        if (!track.valid) return;
+        kf.predict(dt);   // coast on the model
+    }
+
+    track.x = kf.x();
+    track.y = kf.y();
+    track.vx = kf.vx();
+    track.vy = kf.vy();
+}
+
 }  // namespace golf
@@ -7,7 +7,14 @@
 #include <cuda_runtime_api.h>
 #include <NvInfer.h>
 
-#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 #include <numeric>
 #include <vector>
@@ -22,9 +29,12 @@ void TrtLogger::log(Severity severity, const char* msg) noexcept {
 }
 
 // ─── Helpers ────────────────────────────────────────────────────────────────
-static size_t volume(const nvinfer1::Dims& d) {
+// Timing events per slot (Slot::marks)
+enum Mark { MARK_START, MARK_STAGE, MARK_H2D, MARK_INFER, MARK_OUTPUT };
+
+static size_t volume(const nvinfer1::Dims& d, int first = 0) {
     size_t v = 1;
-    for (int i = 0; i < d.nbDims; ++i) {
+    for (int i = first; i < d.nbDims; ++i) {
         v *= static_cast<size_t>(d.d[i]);
     }
     return v;
@@ -32,51 +42,92 @@ static size_t volume(const nvinfer1::Dims& d) {
 
 // ─── Destructor ─────────────────────────────────────────────────────────────
 TrtEngine::~TrtEngine() {
+    if (loaded_) activate();
     release_buffers();
 }
 
 // ─── Load ───────────────────────────────────────────────────────────────────
-bool TrtEngine::load(const std::string& engine_path) {
-    // Read serialized engine
-    std::ifstream file(engine_path, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
-        std::cerr << "[TrtEngine] Cannot open " << engine_path << "\n";
+bool TrtEngine::load(const std::string& model_path, const BuildOptions& build,
+                     int device, int slots) {
+    if (device < 0 && cudaGetDevice(&device) != cudaSuccess) {
+        std::cerr << "[TrtEngine] Cannot query the CUDA device\n";
         return false;
     }
-    const size_t file_size = file.tellg();
-    file.seekg(0, std::ios::beg);
+    device_ = device;
+    num_slots_ = std::clamp(slots, 1, kMaxSlots);
+    // The engine cache is keyed on the current device, so select it first
+    if (!activate()) return false;
 
-    std::vector<char> engine_data(file_size);
-    if (!file.read(engine_data.data(), file_size)) {
-        std::cerr << "[TrtEngine] Failed to read engine file\n";
-        return false;
+    std::string engine_path = model_path;
+    if (is_onnx_model(model_path)) {
+        engine_path = engine_cache_path(model_path, build);
+        if (engine_path.empty()) return false;
+
+        struct stat st{};
+        if (stat(engine_path.c_str(), &st) == 0) {
+            std::cout << "[TrtEngine] Engine cache hit: " << engine_path << "\n";
+        } else if (!build_engine(model_path, build, engine_path, logger_)) {
+            return false;
+        }
     }
-    file.close();
 
-    // Deserialize
-    runtime_.reset(nvinfer1::createInferRuntime(logger_));
-    if (!runtime_) {
-        std::cerr << "[TrtEngine] Failed to create runtime\n";
+    if (!deserialize(engine_path)) {
+        return false;
+    }
+    if (!allocate_buffers()) {
         return false;
     }
+    loaded_ = true;
+    return true;
+}
 
-    engine_.reset(runtime_->deserializeCudaEngine(engine_data.data(), file_size));
-    if (!engine_) {
-        std::cerr << "[TrtEngine] Failed to deserialize engine\n";
+bool TrtEngine::activate() const {
+    const cudaError_t err = cudaSetDevice(device_);
+    if (err != cudaSuccess) {
+        std::cerr << "[TrtEngine] Cannot select CUDA device " << device_ << ": "
+                  << cudaGetErrorString(err) << "\n";
         return false;
     }
+    return true;
+}
 
-    context_.reset(engine_->createExecutionContext());
-    if (!context_) {
-        std::cerr << "[TrtEngine] Failed to create execution context\n";
+bool TrtEngine::deserialize(const std::string& engine_path) {
+    // Map the serialized engine instead of copying it through a stream:
+    // the runtime reads straight out of the page cache
+    const int fd = ::open(engine_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "[TrtEngine] Cannot open " << engine_path << "\n";
+        return false;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        std::cerr << "[TrtEngine] Empty engine file " << engine_path << "\n";
+        ::close(fd);
         return false;
     }
+    const size_t file_size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        std::cerr << "[TrtEngine] Failed to map engine file: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    madvise(data, file_size, MADV_WILLNEED);
 
-    if (!allocate_buffers()) {
+    runtime_.reset(nvinfer1::createInferRuntime(logger_));
+    if (!runtime_) {
+        std::cerr << "[TrtEngine] Failed to create runtime\n";
+        munmap(data, file_size);
+        return false;
+    }
+    engine_.reset(runtime_->deserializeCudaEngine(data, file_size));
+    munmap(data, file_size);
+    if (!engine_) {
+        std::cerr << "[TrtEngine] Failed to deserialize engine "
+                  << "(built for another GPU or TensorRT version?)\n";
         return false;
     }
 
-    loaded_ = true;
     std::cout << "[TrtEngine] Engine loaded: " << engine_path
               << " (" << file_size / (1024 * 1024) << " MiB)\n";
     return true;
@@ -91,75 +142,375 @@ bool TrtEngine::allocate_buffers() {
     }
 
     // Input tensor (index 0)
-    const char* input_name = engine_->getIOTensorName(0);
-    nvinfer1::Dims in_dims = engine_->getTensorShape(input_name);
+    input_name_ = engine_->getIOTensorName(0);
+    nvinfer1::Dims in_dims = engine_->getTensorShape(input_name_);
+    input_dims_ = in_dims;
     input_c_ = in_dims.d[1];
     input_h_ = in_dims.d[2];
     input_w_ = in_dims.d[3];
-    input_size_bytes_ = volume(in_dims) * sizeof(float);
+    input_image_bytes_ = volume(in_dims, 1) * sizeof(float);
+
+    // Batch dimension: -1 means dynamic, bounded by optimization profile 0
+    dynamic_batch_ = in_dims.d[0] < 0;
+    if (dynamic_batch_) {
+        if (engine_->getNbOptimizationProfiles() < 1) {
+            std::cerr << "[TrtEngine] Dynamic batch but no optimization profile\n";
+            return false;
+        }
+        max_batch_ = static_cast<int>(engine_->getProfileShape(
+            input_name_, 0, nvinfer1::OptProfileSelector::kMAX).d[0]);
+    } else {
+        max_batch_ = static_cast<int>(in_dims.d[0]);
+    }
+    max_batch_ = std::max(max_batch_, 1);
+
+    // Output tensor (index 1) – leading dimension is the batch
+    output_name_ = engine_->getIOTensorName(1);
+    nvinfer1::Dims out_dims = engine_->getTensorShape(output_name_);
+    output_length_ = static_cast<int>(volume(out_dims, 1));
+    output_image_bytes_ = output_length_ * sizeof(float);
+
+    for (int i = 0; i < num_slots_; ++i) {
+        if (!allocate_slot(slots_[i])) return false;
+    }
+
+    std::cout << "[TrtEngine] Input:  " << input_name_
+              << " [" << in_dims.d[0] << "x" << input_c_ << "x"
+              << input_h_ << "x" << input_w_ << "]"
+              << (dynamic_batch_ ? " dynamic" : "")
+              << " batch <= " << max_batch_ << "\n";
+    std::cout << "[TrtEngine] Output: " << output_name_
+              << " [" << output_length_ << " floats per image]\n";
+    std::cout << "[TrtEngine] " << num_slots_
+              << " inference slots (context + stream + pinned staging each) on GPU "
+              << device_ << "\n";
+    return true;
+}
+
+bool TrtEngine::allocate_slot(Slot& slot) {
+    // One context per slot: a context's activation memory can only serve
+    // one in-flight enqueue at a time.
+    slot.context.reset(engine_->createExecutionContext());
+    if (!slot.context) {
+        std::cerr << "[TrtEngine] Failed to create execution context\n";
+        return false;
+    }
 
-    // Output tensor (index 1)
-    const char* output_name = engine_->getIOTensorName(1);
-    nvinfer1::Dims out_dims = engine_->getTensorShape(output_name);
-    output_length_ = static_cast<int>(volume(out_dims));
-    output_size_bytes_ = output_length_ * sizeof(float);
+    if (cudaStreamCreateWithFlags(&slot.stream, cudaStreamNonBlocking) != cudaSuccess ||
+        cudaEventCreateWithFlags(&slot.done, cudaEventDisableTiming) != cudaSuccess) {
+        std::cerr << "[TrtEngine] Failed to create CUDA stream/event\n";
+        return false;
+    }
+    for (cudaEvent_t& ev : slot.marks) {
+        if (cudaEventCreate(&ev) != cudaSuccess) {
+            std::cerr << "[TrtEngine] Failed to create timing event\n";
+            return false;
+        }
+    }
 
-    // Allocate device memory
-    if (cudaMalloc(&gpu_buffers_[0], input_size_bytes_) != cudaSuccess) {
+    // Allocate device memory for the largest batch
+    const size_t in_bytes = input_image_bytes_ * max_batch_;
+    const size_t out_bytes = output_image_bytes_ * max_batch_;
+    if (cudaMalloc(&slot.d_input, in_bytes) != cudaSuccess) {
         std::cerr << "[TrtEngine] CUDA malloc failed for input\n";
         return false;
     }
-    if (cudaMalloc(&gpu_buffers_[1], output_size_bytes_) != cudaSuccess) {
+    if (cudaMalloc(&slot.d_output, out_bytes) != cudaSuccess) {
         std::cerr << "[TrtEngine] CUDA malloc failed for output\n";
         return false;
     }
 
-    // Bind tensors to addresses
-    context_->setTensorAddress(input_name, gpu_buffers_[0]);
-    context_->setTensorAddress(output_name, gpu_buffers_[1]);
+    // Pinned host staging so the async copies really are async
+    if (cudaHostAlloc(&slot.h_input, in_bytes, cudaHostAllocDefault) != cudaSuccess ||
+        cudaHostAlloc(&slot.h_output, out_bytes, cudaHostAllocDefault) != cudaSuccess) {
+        std::cerr << "[TrtEngine] Pinned host alloc failed\n";
+        return false;
+    }
 
-    std::cout << "[TrtEngine] Input:  " << input_name
-              << " [" << in_dims.d[0] << "x" << input_c_ << "x"
-              << input_h_ << "x" << input_w_ << "]\n";
-    std::cout << "[TrtEngine] Output: " << output_name
-              << " [" << output_length_ << " floats]\n";
+    // Bind tensors to addresses
+    slot.context->setTensorAddress(input_name_, slot.d_input);
+    slot.context->setTensorAddress(output_name_, slot.d_output);
     return true;
 }
 
 void TrtEngine::release_buffers() {
-    if (gpu_buffers_[0]) { cudaFree(gpu_buffers_[0]); gpu_buffers_[0] = nullptr; }
-    if (gpu_buffers_[1]) { cudaFree(gpu_buffers_[1]); gpu_buffers_[1] = nullptr; }
+    for (Slot& slot : slots_) {
+        if (slot.stream) cudaStreamSynchronize(slot.stream);
+        destroy_graphs(slot);
+        slot.context.reset();
+        if (slot.d_input)  { cudaFree(slot.d_input);      slot.d_input = nullptr; }
+        if (slot.d_output) { cudaFree(slot.d_output);     slot.d_output = nullptr; }
+        if (slot.h_input)  { cudaFreeHost(slot.h_input);  slot.h_input = nullptr; }
+        if (slot.h_output) { cudaFreeHost(slot.h_output); slot.h_output = nullptr; }
+        if (slot.done)     { cudaEventDestroy(slot.done);    slot.done = nullptr; }
+        for (cudaEvent_t& ev : slot.marks) {
+            if (ev) { cudaEventDestroy(ev); ev = nullptr; }
+        }
+        if (slot.stream)   { cudaStreamDestroy(slot.stream); slot.stream = nullptr; }
+        slot.in_flight = false;
+    }
 }
 
 // ─── Inference ──────────────────────────────────────────────────────────────
 bool TrtEngine::infer(const float* input_data, std::vector<float>& output_data) {
+    if (!infer_async(0, input_data)) return false;
+
+    const float* out = wait(0);
+    if (!out) return false;
+    output_data.assign(out, out + output_length_);
+    return true;
+}
+
+bool TrtEngine::infer_async(int slot_idx, const float* input_data,
+                            InputStage* stage, int batch, OutputStage* output) {
     if (!loaded_) {
         std::cerr << "[TrtEngine] Engine not loaded\n";
         return false;
     }
+    if (slot_idx < 0 || slot_idx >= num_slots_) {
+        std::cerr << "[TrtEngine] No slot " << slot_idx << "\n";
+        return false;
+    }
+    Slot& slot = slots_[slot_idx];
+    if (slot.in_flight) {
+        std::cerr << "[TrtEngine] Slot " << slot_idx << " is still in flight\n";
+        return false;
+    }
+    if (!activate()) return false;
+    if (batch < 1 || batch > max_batch_) {
+        std::cerr << "[TrtEngine] Batch " << batch << " outside 1.." << max_batch_ << "\n";
+        return false;
+    }
+    if (!set_batch(slot, batch)) return false;
+    slot.images = batch;
+
+    const bool upload = input_data != nullptr;
+    if (upload && input_data != slot.h_input) {
+        std::memcpy(slot.h_input, input_data, input_image_bytes_ * batch);
+    }
+
+    slot.timed = 0;
+    if (timing_) cudaEventRecord(slot.marks[MARK_START], slot.stream);
+
+    bool ok = false;
+    if (use_graph_) {
+        // TensorRT needs one regular enqueue at a shape before a capture.
+        Graph* graph = find_graph(slot, batch, upload, stage, output);
+        if (!graph && slot.warmed_up) {
+            graph = capture_graph(slot, upload, stage, output);
+            if (!graph) {
+                std::cerr << "[TrtEngine] CUDA graph capture failed – "
+                             "falling back to normal launches\n";
+                use_graph_ = false;
+            }
+        }
+        if (graph) {
+            graph->last_used = ++slot.graph_uses;
+            cudaError_t err = cudaGraphLaunch(graph->exec, slot.stream);
+            if (err != cudaSuccess) {
+                std::cerr << "[TrtEngine] Graph launch failed: "
+                          << cudaGetErrorString(err) << "\n";
+                return false;
+            }
+            if (timing_) {
+                cudaEventRecord(slot.marks[MARK_OUTPUT], slot.stream);
+                slot.timed = 1;
+            }
+            ok = true;
+        }
+    }
+    if (!ok) {
+        if (!enqueue_work(slot, upload, stage, output, timing_)) return false;
+        slot.warmed_up = true;
+        if (timing_) slot.timed = 2;
+    }
+
+    cudaEventRecord(slot.done, slot.stream);
+    slot.in_flight = true;
+    return true;
+}
+
+bool TrtEngine::set_batch(Slot& slot, int batch) {
+    // Static-batch engines always execute their full batch; only the first
+    // `images` inputs / outputs are copied.
+    if (!dynamic_batch_ || slot.batch == batch) return true;
+
+    // Graphs captured at other batch sizes stay valid – a replay doesn't
+    // consult the context's shape, and find_graph() only picks one whose
+    // batch matches – but the new shape needs its regular enqueue before
+    // it can be captured.
+    nvinfer1::Dims dims = input_dims_;
+    dims.d[0] = batch;
+    if (!slot.context->setInputShape(input_name_, dims)) {
+        std::cerr << "[TrtEngine] setInputShape failed for batch " << batch << "\n";
+        return false;
+    }
+    slot.batch = batch;
+    slot.warmed_up = false;
+    return true;
+}
+
+bool TrtEngine::enqueue_work(Slot& slot, bool upload, InputStage* stage,
+                             OutputStage* output, bool mark) {
+    auto mark_at = [&](int m) {
+        if (mark) cudaEventRecord(slot.marks[m], slot.stream);
+    };
+
+    if (stage && !stage->enqueue(slot.stream)) {
+        return false;
+    }
+    mark_at(MARK_STAGE);
 
     // Host → Device
-    if (cudaMemcpy(gpu_buffers_[0], input_data, input_size_bytes_,
-                   cudaMemcpyHostToDevice) != cudaSuccess) {
+    if (upload &&
+        cudaMemcpyAsync(slot.d_input, slot.h_input,
+                        input_image_bytes_ * slot.images,
+                        cudaMemcpyHostToDevice, slot.stream) != cudaSuccess) {
         std::cerr << "[TrtEngine] H2D copy failed\n";
         return false;
     }
+    mark_at(MARK_H2D);
 
     // Execute
-    if (!context_->enqueueV3(nullptr)) {
+    if (!slot.context->enqueueV3(slot.stream)) {
         std::cerr << "[TrtEngine] enqueueV3 failed\n";
         return false;
     }
-    cudaStreamSynchronize(nullptr);
+    mark_at(MARK_INFER);
 
-    // Device → Host
-    output_data.resize(output_length_);
-    if (cudaMemcpy(output_data.data(), gpu_buffers_[1], output_size_bytes_,
-                   cudaMemcpyDeviceToHost) != cudaSuccess) {
+    // Post-process on the device, or Device → Host of the raw tensor
+    if (output) {
+        if (!output->enqueue(static_cast<const float*>(slot.d_output),
+                             slot.images, output_length_, slot.stream)) {
+            return false;
+        }
+    } else if (cudaMemcpyAsync(slot.h_output, slot.d_output,
+                               output_image_bytes_ * slot.images,
+                               cudaMemcpyDeviceToHost, slot.stream) != cudaSuccess) {
         std::cerr << "[TrtEngine] D2H copy failed\n";
         return false;
     }
+    mark_at(MARK_OUTPUT);
     return true;
 }
 
+// ─── CUDA graph ─────────────────────────────────────────────────────────────
+TrtEngine::Graph* TrtEngine::find_graph(Slot& slot, int batch, bool upload,
+                                        const InputStage* stage,
+                                        const OutputStage* output) {
+    const uint64_t generation = stage ? stage->generation() : 0;
+    const uint64_t output_generation = output ? output->generation() : 0;
+    for (Graph& g : slot.graphs) {
+        if (g.exec && g.batch == batch && g.uploads == upload &&
+            g.stage == stage && g.generation == generation &&
+            g.output == output && g.output_generation == output_generation) {
+            return &g;
+        }
+    }
+    return nullptr;
+}
+
+TrtEngine::Graph* TrtEngine::capture_graph(Slot& slot, bool upload,
+                                           InputStage* stage,
+                                           OutputStage* output) {
+    // A free entry, else the least recently used one
+    Graph* g = &slot.graphs[0];
+    for (Graph& cand : slot.graphs) {
+        if (!cand.exec) {
+            g = &cand;
+            break;
+        }
+        if (cand.last_used < g->last_used) g = &cand;
+    }
+    if (g->exec) {
+        cudaGraphExecDestroy(g->exec);
+        *g = Graph();
+    }
+
+    if (cudaStreamBeginCapture(slot.stream,
+                               cudaStreamCaptureModeThreadLocal) != cudaSuccess) {
+        cudaGetLastError();
+        return nullptr;
+    }
+    const bool enqueued = enqueue_work(slot, upload, stage, output);
+
+    cudaGraph_t graph = nullptr;
+    cudaError_t err = cudaStreamEndCapture(slot.stream, &graph);
+    if (!enqueued || err != cudaSuccess || !graph) {
+        if (graph) cudaGraphDestroy(graph);
+        cudaGetLastError();   // clear the sticky capture error
+        return nullptr;
+    }
+
+    err = cudaGraphInstantiateWithFlags(&g->exec, graph, 0);
+    cudaGraphDestroy(graph);
+    if (err != cudaSuccess) {
+        g->exec = nullptr;
+        cudaGetLastError();
+        return nullptr;
+    }
+
+    g->batch = slot.images;
+    g->uploads = upload;
+    g->stage = stage;
+    g->generation = stage ? stage->generation() : 0;
+    g->output = output;
+    g->output_generation = output ? output->generation() : 0;
+    return g;
+}
+
+void TrtEngine::destroy_graphs(Slot& slot) {
+    for (Graph& g : slot.graphs) {
+        if (g.exec) cudaGraphExecDestroy(g.exec);
+        g = Graph();
+    }
+}
+
+// ─── Timing ─────────────────────────────────────────────────────────────────
+bool TrtEngine::timings(int slot_idx, GpuTimings& out) const {
+    const Slot& slot = slots_[slot_idx];
+    if (slot.timed == 0 || slot.in_flight) return false;
+
+    auto elapsed = [&](int from, int to) {
+        float ms = -1.f;
+        if (cudaEventElapsedTime(&ms, slot.marks[from], slot.marks[to]) != cudaSuccess) {
+            cudaGetLastError();
+            return -1.f;
+        }
+        return ms;
+    };
+
+    out = GpuTimings();
+    out.total_ms = elapsed(MARK_START, MARK_OUTPUT);
+    if (slot.timed == 2) {
+        out.stage_ms  = elapsed(MARK_START, MARK_STAGE);
+        out.h2d_ms    = elapsed(MARK_STAGE, MARK_H2D);
+        out.infer_ms  = elapsed(MARK_H2D, MARK_INFER);
+        out.output_ms = elapsed(MARK_INFER, MARK_OUTPUT);
+    }
+    return out.total_ms >= 0.f;
+}
+
+bool TrtEngine::ready(int slot_idx) const {
+    const Slot& slot = slots_[slot_idx];
+    return slot.in_flight && cudaEventQuery(slot.done) != cudaErrorNotReady;
+}
+
+const float* TrtEngine::wait(int slot_idx) {
+    Slot& slot = slots_[slot_idx];
+    if (!slot.in_flight) {
+        std::cerr << "[TrtEngine] Slot " << slot_idx << " has nothing in flight\n";
+        return nullptr;
+    }
+    slot.in_flight = false;
+
+    cudaError_t err = cudaEventSynchronize(slot.done);
+    if (err != cudaSuccess) {
+        std::cerr << "[TrtEngine] Inference failed: "
+                  << cudaGetErrorString(err) << "\n";
+        return nullptr;
+    }
+    return slot.h_output;
+}
+
 }  // namespace golf
@@ -0,0 +1,400 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// unreal_events.cpp  –  TCP Putt Event Channel
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "unreal_events.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace golf {
+
+static uint64_t now_us() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static wire::PuttState to_wire(const PuttData& d) {
+    wire::PuttState s;
+    s.putt_number = d.putt_number;
+    s.phase = static_cast<wire::PuttPhase>(d.state);
+    s.launch_speed = d.launch_speed;
+    s.current_speed = d.current_speed;
+    s.peak_speed = d.peak_speed;
+    s.total_distance = d.total_distance;
+    s.break_distance = d.break_distance;
+    s.time_in_motion = d.time_in_motion;
+    s.start_x = d.start_x;
+    s.start_y = d.start_y;
+    s.final_x = d.final_x;
+    s.final_y = d.final_y;
+    return s;
+}
+
+// ─── Counters ───────────────────────────────────────────────────────────────
+std::string EventCounters::to_json() const {
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+        "{\"clients\":%" PRIu64 ",\"connections\":%" PRIu64 ",\"events\":%" PRIu64
+        ",\"replayed\":%" PRIu64 ",\"bytes\":%" PRIu64 ",\"dropped\":%" PRIu64 "}",
+        clients.load(), connections.load(), events.load(), replayed.load(),
+        bytes.load(), dropped.load());
+    return buf;
+}
+
+std::string EventCounters::to_prometheus() const {
+    const std::pair<const char*, uint64_t> counters[] = {
+        {"connections", connections.load()}, {"events", events.load()},
+        {"replayed", replayed.load()},       {"bytes", bytes.load()},
+        {"dropped", dropped.load()}};
+
+    char buf[160];
+    std::snprintf(buf, sizeof(buf),
+        "# TYPE golf_events_clients gauge\n"
+        "golf_events_clients %" PRIu64 "\n", clients.load());
+    std::string out = buf;
+    for (const auto& [name, value] : counters) {
+        std::snprintf(buf, sizeof(buf),
+            "# TYPE golf_events_%s_total counter\n"
+            "golf_events_%s_total %" PRIu64 "\n",
+            name, name, value);
+        out += buf;
+    }
+    return out;
+}
+
+// ─── Lifecycle ──────────────────────────────────────────────────────────────
+UnrealEventChannel::UnrealEventChannel(std::vector<PuttStats*> bays)
+    : bays_(std::move(bays)), state_(bays_.size()) {}
+
+UnrealEventChannel::~UnrealEventChannel() {
+    stop();
+}
+
+bool UnrealEventChannel::start(uint16_t port, const std::string& host) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) <= 0) {
+        std::cerr << "[EventChannel] Invalid address: " << host << "\n";
+        return false;
+    }
+
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "[EventChannel] socket() failed\n";
+        return false;
+    }
+    const int one = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listen_fd_, 16) < 0) {
+        std::cerr << "[EventChannel] Cannot listen on " << host << ":" << port
+                  << ": " << std::strerror(errno) << "\n";
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    running_ = true;
+    thread_ = std::thread(&UnrealEventChannel::run, this);
+    std::cout << "[EventChannel] Putt events on tcp://" << host << ":" << port
+              << " (" << bays_.size() << " bay(s))\n";
+    return true;
+}
+
+void UnrealEventChannel::stop() {
+    running_ = false;
+    if (thread_.joinable()) thread_.join();
+    for (auto& c : clients_) ::close(c->fd);
+    clients_.clear();
+    counters_.clients = 0;
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+    }
+}
+
+// ─── Channel thread ─────────────────────────────────────────────────────────
+void UnrealEventChannel::run() {
+    std::vector<pollfd> fds;
+    while (running_) {
+        poll_bays();
+        for (auto& c : clients_) refill_sync(*c);
+
+        fds.clear();
+        fds.push_back({listen_fd_, POLLIN, 0});
+        for (const auto& c : clients_) {
+            fds.push_back({c->fd, static_cast<short>(POLLIN | (c->out.empty() ? 0 : POLLOUT)), 0});
+        }
+        const int n = ::poll(fds.data(), fds.size(), static_cast<int>(kPoll.count()));
+        if (n < 0 && errno != EINTR) {
+            std::cerr << "[EventChannel] poll() failed: " << std::strerror(errno) << "\n";
+            break;
+        }
+
+        if (n > 0) {
+            // fds[i + 1] belongs to clients_[i]; accept last so the indices hold
+            for (size_t i = 0; i < clients_.size(); ++i) {
+                Client& c = *clients_[i];
+                const short ev = fds[i + 1].revents;
+                if (ev & (POLLERR | POLLHUP | POLLNVAL)) c.dead = true;
+                if (!c.dead && (ev & POLLIN) && !read_client(c)) c.dead = true;
+                if (!c.dead && (ev & POLLOUT) && !write_client(c)) c.dead = true;
+            }
+            if (fds[0].revents & POLLIN) accept_clients();
+        }
+
+        clients_.erase(std::remove_if(clients_.begin(), clients_.end(),
+                                      [](const std::unique_ptr<Client>& c) {
+                                          if (c->dead) ::close(c->fd);
+                                          return c->dead;
+                                      }),
+                       clients_.end());
+        counters_.clients = clients_.size();
+    }
+}
+
+// Polls the seqlock-published snapshots and the history logs, like the SSE
+// broadcaster – the tracking thread never waits on a client.
+void UnrealEventChannel::poll_bays() {
+    for (size_t b = 0; b < bays_.size(); ++b) {
+        BayState& st = state_[b];
+        const PuttData d = bays_[b]->current();
+        const auto hist = bays_[b]->history();
+        const uint16_t bay = static_cast<uint16_t>(b);
+        if (!st.valid) {
+            // Putts from before start are history, served through SYNC
+            st.valid = true;
+            st.state = d.state;
+            st.putt_number = d.putt_number;
+            st.results = hist.size();
+            continue;
+        }
+
+        if (d.state != st.state || d.putt_number != st.putt_number) {
+            if (d.state == PuttState::IN_MOTION) {
+                broadcast(putt_event(bay, wire::PacketType::PUTT_START, st.sequence++, 0, d));
+            } else if (d.state == PuttState::STOPPED) {
+                broadcast(putt_event(bay, wire::PacketType::PUTT_STOP, st.sequence++, 0, d));
+            }
+            st.state = d.state;
+            st.putt_number = d.putt_number;
+        }
+
+        for (; st.results < hist.size(); ++st.results) {
+            broadcast(putt_result(bay, st.sequence++, 0, hist[st.results]));
+        }
+    }
+}
+
+void UnrealEventChannel::accept_clients() {
+    for (;;) {
+        const int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cerr << "[EventChannel] accept() failed: " << std::strerror(errno) << "\n";
+            }
+            return;
+        }
+        const int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        auto c = std::make_unique<Client>();
+        c->fd = fd;
+        send_to(*c, hello());
+        clients_.push_back(std::move(c));
+        counters_.connections.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool UnrealEventChannel::read_client(Client& c) {
+    char buf[1024];
+    for (;;) {
+        const ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+        if (n == 0) return false;                       // orderly close
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return false;
+        }
+        c.in.append(buf, static_cast<size_t>(n));
+        if (c.in.size() > kMaxRequest) return false;
+    }
+
+    size_t used = 0;
+    for (;;) {
+        wire::EventHeader h;
+        const uint8_t* body = nullptr;
+        size_t body_len = 0;
+        const long m = wire::decode_event(c.in.data() + used, c.in.size() - used,
+                                          h, body, body_len);
+        if (m < 0) return false;                        // not our protocol
+        if (m == 0) break;
+        used += static_cast<size_t>(m);
+
+        int32_t since = 0;
+        if (h.type == wire::PacketType::SYNC && wire::decode_sync(body, body_len, since)) {
+            if (c.pending.size() >= kMaxPendingSyncs) return false;
+            c.pending.push_back({h.stream_id, since});
+        }
+    }
+    c.in.erase(0, used);
+    return true;
+}
+
+bool UnrealEventChannel::write_client(Client& c) {
+    while (!c.out.empty()) {
+        const std::string& msg = *c.out.front();
+        const ssize_t n = send(c.fd, msg.data() + c.offset, msg.size() - c.offset,
+                               MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        counters_.bytes.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+        c.offset += static_cast<size_t>(n);
+        c.backlog -= static_cast<size_t>(n);
+        if (c.offset == msg.size()) {
+            c.out.pop_front();
+            c.offset = 0;
+        }
+    }
+    return true;
+}
+
+// Queues the next few results of the SYNC being served, while the client
+// keeps up.  Only results already published live are replayed, so every
+// putt reaches the client exactly once per request.
+void UnrealEventChannel::refill_sync(Client& c) {
+    while (!c.dead && c.backlog < kSyncWindow) {
+        if (c.sync_bay < 0) {
+            if (c.pending.empty()) return;
+            const Sync req = c.pending.front();
+            c.pending.pop_front();
+            c.sync_bay = req.bay;
+            c.sync_last = req.since;
+            c.sync_next = c.sync_end = 0;
+            if (req.bay < bays_.size()) {
+                const auto hist = bays_[req.bay]->history();
+                const size_t end = std::min(state_[req.bay].results, hist.size());
+                c.sync_next = static_cast<size_t>(
+                    std::partition_point(hist.begin(), hist.begin() + end,
+                                         [&](const PuttData& p) {
+                                             return p.putt_number <= req.since;
+                                         }) - hist.begin());
+                c.sync_end = end;
+            }
+        }
+
+        const uint16_t bay = static_cast<uint16_t>(c.sync_bay);
+        if (c.sync_next < c.sync_end) {
+            const PuttData& p = bays_[bay]->history()[c.sync_next++];
+            send_to(c, putt_result(bay, 0, wire::kReplay, p));
+            c.sync_last = p.putt_number;
+            counters_.replayed.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        wire::EventHeader h;
+        h.type = wire::PacketType::SYNC_DONE;
+        h.stream_id = bay;
+        h.send_time_us = now_us();
+        h.capture_time_us = h.send_time_us;
+        std::string out(wire::event_size(4), '\0');
+        wire::encode_sync(h, c.sync_last, reinterpret_cast<uint8_t*>(&out[0]), out.size());
+        send_to(c, std::make_shared<const std::string>(std::move(out)));
+        c.sync_bay = -1;
+    }
+}
+
+// ─── Messages ───────────────────────────────────────────────────────────────
+void UnrealEventChannel::broadcast(Message msg) {
+    counters_.events.fetch_add(1, std::memory_order_relaxed);
+    for (auto& c : clients_) send_to(*c, msg);
+}
+
+void UnrealEventChannel::send_to(Client& c, Message msg) {
+    if (c.dead) return;
+    if (c.backlog + msg->size() > kMaxBacklog) {
+        std::cerr << "[EventChannel] Dropping a client that stopped reading ("
+                  << c.backlog << " bytes queued)\n";
+        counters_.dropped.fetch_add(1, std::memory_order_relaxed);
+        c.dead = true;
+        return;
+    }
+    c.backlog += msg->size();
+    c.out.push_back(std::move(msg));
+}
+
+UnrealEventChannel::Message UnrealEventChannel::putt_event(
+        uint16_t bay, wire::PacketType type, uint32_t sequence, uint16_t flags,
+        const PuttData& putt) const {
+    wire::EventHeader h;
+    h.type = type;
+    h.sequence = sequence;
+    h.stream_id = bay;
+    h.flags = flags;
+    h.send_time_us = now_us();
+    h.capture_time_us = h.send_time_us;
+
+    std::string out(wire::event_size(wire::kPuttStateSize), '\0');
+    wire::encode_putt_event(h, to_wire(putt), reinterpret_cast<uint8_t*>(&out[0]), out.size());
+    return std::make_shared<const std::string>(std::move(out));
+}
+
+UnrealEventChannel::Message UnrealEventChannel::putt_result(
+        uint16_t bay, uint32_t sequence, uint16_t flags, const PuttData& putt) const {
+    const PuttStats::Trajectory traj = bays_[bay]->trajectory(putt);
+    std::vector<wire::TrajectoryPoint> points(traj.size());
+    for (size_t i = 0; i < traj.size(); ++i) {
+        const TrajectorySample& s = traj[i];
+        points[i] = {s.t, s.x, s.y, s.vx, s.vy, s.confidence};
+    }
+
+    wire::EventHeader h;
+    h.type = wire::PacketType::PUTT_RESULT;
+    h.sequence = sequence;
+    h.stream_id = bay;
+    h.flags = flags;
+    h.send_time_us = now_us();
+    h.capture_time_us = h.send_time_us;
+
+    const uint32_t count = static_cast<uint32_t>(points.size());
+    std::string out(wire::event_size(wire::kPuttStateSize + 8 +
+                                     count * wire::kTrajectoryPointSize), '\0');
+    wire::encode_putt_result(h, to_wire(putt), putt.ball_id, points.data(), count,
+                             reinterpret_cast<uint8_t*>(&out[0]), out.size());
+    return std::make_shared<const std::string>(std::move(out));
+}
+
+UnrealEventChannel::Message UnrealEventChannel::hello() const {
+    std::vector<int32_t> last(bays_.size(), 0);
+    for (size_t b = 0; b < bays_.size(); ++b) {
+        const auto hist = bays_[b]->history();
+        const size_t n = std::min(state_[b].results, hist.size());
+        if (n > 0) last[b] = hist[n - 1].putt_number;
+    }
+
+    wire::EventHeader h;
+    h.type = wire::PacketType::HELLO;
+    h.send_time_us = now_us();
+    h.capture_time_us = h.send_time_us;
+    const uint16_t bays = static_cast<uint16_t>(bays_.size());
+    std::string out(wire::event_size(4 + 4 * static_cast<size_t>(bays)), '\0');
+    wire::encode_hello(h, last.data(), bays, reinterpret_cast<uint8_t*>(&out[0]), out.size());
+    return std::make_shared<const std::string>(std::move(out));
+}
+
+}  // namespace golf
@@ -1,27 +1,81 @@
 // ─────────────────────────────────────────────────────────────────────────────
-// unreal_sender.cpp  –  UDP JSON Sender for Unreal Engine
+// unreal_sender.cpp  –  UDP JSON / Binary Sender for Unreal Engine
 // ─────────────────────────────────────────────────────────────────────────────
 
 #include "unreal_sender.h"
+#include "unreal_protocol.h"
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <unistd.h>
 
+#include <cerrno>
 #include <chrono>
 #include <cinttypes>
+#include <cmath>
 #include <cstdio>
 #include <cstring>
 #include <iostream>
 
 namespace golf {
 
+bool parse_wire_protocol(const std::string& name, WireProtocol& out) {
+    if (name == "json") {
+        out = WireProtocol::JSON;
+    } else if (name == "binary") {
+        out = WireProtocol::BINARY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static uint64_t to_us(std::chrono::steady_clock::time_point t) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        t.time_since_epoch()).count());
+}
+
+// ─── Counters ───────────────────────────────────────────────────────────────
+std::string SendCounters::to_json() const {
+    char buf[384];
+    std::snprintf(buf, sizeof(buf),
+        "{\"frames\":%" PRIu64 ",\"datagrams\":%" PRIu64 ",\"keyframes\":%" PRIu64
+        ",\"predicted\":%" PRIu64 ",\"skipped\":%" PRIu64 ",\"bytes\":%" PRIu64
+        ",\"syscalls\":%" PRIu64 ",\"errors\":%" PRIu64 "}",
+        frames.load(), datagrams.load(), keyframes.load(), predicted.load(),
+        skipped.load(), bytes.load(), syscalls.load(), errors.load());
+    return buf;
+}
+
+std::string SendCounters::to_prometheus() const {
+    const std::pair<const char*, uint64_t> counters[] = {
+        {"frames", frames.load()},     {"datagrams", datagrams.load()},
+        {"keyframes", keyframes.load()}, {"predicted", predicted.load()},
+        {"skipped", skipped.load()},
+        {"bytes", bytes.load()},       {"syscalls", syscalls.load()},
+        {"errors", errors.load()}};
+
+    std::string out;
+    char buf[160];
+    for (const auto& [name, value] : counters) {
+        std::snprintf(buf, sizeof(buf),
+            "# TYPE golf_udp_%s_total counter\n"
+            "golf_udp_%s_total %" PRIu64 "\n",
+            name, name, value);
+        out += buf;
+    }
+    return out;
+}
+
+// ─── Sender ─────────────────────────────────────────────────────────────────
 UnrealSender::~UnrealSender() {
     close();
 }
 
-bool UnrealSender::init(const std::string& host, uint16_t port) {
+bool UnrealSender::init(const std::string& host, uint16_t port,
+                        const SenderOptions& opts) {
+    opts_ = opts;
     sock_fd_ = socket(AF_INET, SOCK_DGRAM, 0);
     if (sock_fd_ < 0) {
         std::cerr << "[UnrealSender] socket() failed\n";
@@ -38,23 +92,175 @@ bool UnrealSender::init(const std::string& host, uint16_t port) {
         return false;
     }
 
-    std::cout << "[UnrealSender] Sending to " << host << ":" << port << "\n";
+    std::cout << "[UnrealSender] Sending to " << host << ":" << port << " ("
+              << (opts_.protocol == WireProtocol::BINARY ? "binary" : "json")
+              << (opts_.policy == SendPolicy::DELTA ? ", delta" : ", every frame")
+              << (opts_.stats ? "" : ", no stats")
+              << ")\n";
     return true;
 }
 
-bool UnrealSender::send(const TrackedObject& ball, const TrackedObject& putter,
-                        const PuttData& stats) {
-    if (sock_fd_ < 0) return false;
+UnrealSender::Decision UnrealSender::decide(
+        const StreamState& st, const TrackedObject& ball,
+        const TrackedObject& putter, const PuttData& stats,
+        std::chrono::steady_clock::time_point now) const {
+    if (opts_.policy == SendPolicy::EVERY_FRAME) return Decision::SEND;
+    if (!st.has_sent) return Decision::KEYFRAME;
+
+    // Full rate during a putt and on every discrete change
+    if (stats.state == PuttState::IN_MOTION) return Decision::SEND;
+    if (stats.state != st.state || stats.putt_number != st.putt_number ||
+        ball.valid != st.ball_valid || putter.valid != st.putter_valid) {
+        return Decision::SEND;
+    }
+
+    const double since = std::chrono::duration<double>(now - st.sent_at).count();
+    const float eps = opts_.epsilon_px;
+    const bool moved =
+        (ball.valid && std::hypot(ball.x - st.ball_x, ball.y - st.ball_y) > eps) ||
+        (putter.valid && std::hypot(putter.x - st.putter_x, putter.y - st.putter_y) > eps);
+    if (moved && opts_.idle_hz > 0 && since >= 1.0 / opts_.idle_hz) {
+        return Decision::SEND;
+    }
+    return since >= opts_.keyframe_s ? Decision::KEYFRAME : Decision::SKIP;
+}
+
+bool UnrealSender::queue(const TrackedObject& ball, const TrackedObject& putter,
+                         const PuttData& stats, int stream_id,
+                         std::chrono::steady_clock::time_point capture_time,
+                         bool predicted) {
+    if (sock_fd_ < 0 || stream_id < 0) return false;
+    counters_.frames.fetch_add(1, std::memory_order_relaxed);
+
+    if (static_cast<size_t>(stream_id) >= streams_.size()) {
+        streams_.resize(stream_id + 1);
+    }
+    StreamState& st = streams_[stream_id];
+
+    const auto now = std::chrono::steady_clock::now();
+    const Decision d = decide(st, ball, putter, stats, now);
+    if (d == Decision::SKIP) {
+        counters_.skipped.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    const bool keyframe = d == Decision::KEYFRAME;
+
+    if (queued_ == kMaxQueued && !flush()) return false;
+    Datagram& dg = queue_[queued_];
+
+    const uint64_t now_us = to_us(now);
+    const bool has_capture = capture_time.time_since_epoch().count() != 0;
+    const uint64_t capture_us = has_capture ? to_us(capture_time) : now_us;
+    if (opts_.protocol == WireProtocol::BINARY) {
+        dg.length = encode_binary(reinterpret_cast<uint8_t*>(dg.data), sizeof(dg.data),
+                                  ball, putter, stats, stream_id, st.sequence,
+                                  keyframe, predicted, capture_us, now_us);
+    } else {
+        dg.length = encode_json(dg.data, sizeof(dg.data), ball, putter, stats,
+                                stream_id, keyframe, predicted, capture_us, now_us);
+    }
+    if (dg.length <= 0) {
+        std::cerr << "[UnrealSender] Encode error\n";
+        return false;
+    }
+    dg.capture_time = has_capture ? capture_time : now;
+    dg.predicted = predicted;
+    if (queued_++ == 0) oldest_queued_ = now;
+    if (keyframe) counters_.keyframes.fetch_add(1, std::memory_order_relaxed);
+    if (predicted) counters_.predicted.fetch_add(1, std::memory_order_relaxed);
+
+    st.has_sent = true;
+    ++st.sequence;
+    st.state = stats.state;
+    st.putt_number = stats.putt_number;
+    st.ball_valid = ball.valid;
+    st.putter_valid = putter.valid;
+    st.ball_x = ball.x;
+    st.ball_y = ball.y;
+    st.putter_x = putter.x;
+    st.putter_y = putter.y;
+    st.sent_at = now;
+
+    // Batching must not cost latency: bound how long a datagram waits
+    return hold_expired(now) ? flush() : true;
+}
 
-    auto now = std::chrono::steady_clock::now();
-    uint64_t ts_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                         now.time_since_epoch())
-                         .count();
+bool UnrealSender::poll() {
+    return hold_expired(std::chrono::steady_clock::now()) ? flush() : true;
+}
+
+bool UnrealSender::hold_expired(std::chrono::steady_clock::time_point now) const {
+    return queued_ > 0 &&
+           std::chrono::duration<double>(now - oldest_queued_).count() >= opts_.max_hold_s;
+}
+
+bool UnrealSender::flush() {
+    if (queued_ == 0) return true;
+    if (sock_fd_ < 0) {
+        queued_ = 0;
+        return false;
+    }
+
+    iovec iov[kMaxQueued];
+    mmsghdr msgs[kMaxQueued];
+    std::memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < queued_; ++i) {
+        iov[i].iov_base = queue_[i].data;
+        iov[i].iov_len = static_cast<size_t>(queue_[i].length);
+        msgs[i].msg_hdr.msg_name = dest_addr_;
+        msgs[i].msg_hdr.msg_namelen = sizeof(*dest_addr_);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // sendmmsg() may stop early; resend the remainder, drop on error
+    int done = 0;
+    bool ok = true;
+    while (done < queued_) {
+        const int n = sendmmsg(sock_fd_, msgs + done,
+                               static_cast<unsigned>(queued_ - done), 0);
+        counters_.syscalls.fetch_add(1, std::memory_order_relaxed);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            std::cerr << "[UnrealSender] sendmmsg() failed: "
+                      << std::strerror(errno) << "\n";
+            counters_.errors.fetch_add(queued_ - done, std::memory_order_relaxed);
+            ok = false;
+            break;
+        }
+
+        const auto sent_at = std::chrono::steady_clock::now();
+        for (int i = done; i < done + n; ++i) {
+            counters_.bytes.fetch_add(msgs[i].msg_len, std::memory_order_relaxed);
+            if (metrics_ && !queue_[i].predicted) {
+                metrics_->record(Stage::GLASS_TO_UDP, sent_at - queue_[i].capture_time);
+            }
+        }
+        counters_.datagrams.fetch_add(n, std::memory_order_relaxed);
+        done += n;
+    }
+    queued_ = 0;
+    return ok;
+}
+
+bool UnrealSender::send(const TrackedObject& ball, const TrackedObject& putter,
+                        const PuttData& stats, int stream_id,
+                        std::chrono::steady_clock::time_point capture_time) {
+    const bool queued = queue(ball, putter, stats, stream_id, capture_time);
+    return flush() && queued;
+}
 
-    char buf[1024];
-    int n = std::snprintf(buf, sizeof(buf),
+int UnrealSender::encode_json(char* buf, size_t cap, const TrackedObject& ball,
+                              const TrackedObject& putter, const PuttData& stats,
+                              int stream_id, bool keyframe, bool predicted,
+                              uint64_t capture_us, uint64_t now_us) const {
+    int n = std::snprintf(buf, cap,
         "{"
             "\"timestamp_ms\":%" PRIu64 ","
+            "\"state_time_ms\":%" PRIu64 ","
+            "\"stream_id\":%d,"
+            "\"keyframe\":%s,"
+            "\"predicted\":%s,"
             "\"ball\":{"
                 "\"x\":%.2f,\"y\":%.2f,"
                 "\"vx\":%.2f,\"vy\":%.2f,"
@@ -64,8 +270,24 @@ bool UnrealSender::send(const TrackedObject& ball, const TrackedObject& putter,
                 "\"x\":%.2f,\"y\":%.2f,"
                 "\"vx\":%.2f,\"vy\":%.2f,"
                 "\"conf\":%.3f,\"visible\":%s"
-            "},"
-            "\"stats\":{"
+            "}",
+        now_us / 1000, capture_us / 1000, stream_id,
+        keyframe ? "true" : "false", predicted ? "true" : "false",
+        ball.x, ball.y, ball.vx, ball.vy,
+        ball.confidence, ball.valid ? "true" : "false",
+        putter.x, putter.y, putter.vx, putter.vy,
+        putter.confidence, putter.valid ? "true" : "false");
+    if (n < 0 || n >= static_cast<int>(cap)) return -1;
+
+    // Putt state travels on the event channel instead, if one is running
+    if (!opts_.stats) {
+        if (n + 2 > static_cast<int>(cap)) return -1;
+        buf[n++] = '}';
+        buf[n] = '\0';
+        return n;
+    }
+    const int m = std::snprintf(buf + n, cap - n,
+            ",\"stats\":{"
                 "\"putt_number\":%d,"
                 "\"state\":\"%s\","
                 "\"launch_speed\":%.2f,"
@@ -78,34 +300,52 @@ bool UnrealSender::send(const TrackedObject& ball, const TrackedObject& putter,
                 "\"final_x\":%.2f,\"final_y\":%.2f"
             "}"
         "}",
-        ts_ms,
-        ball.x, ball.y, ball.vx, ball.vy,
-        ball.confidence, ball.valid ? "true" : "false",
-        putter.x, putter.y, putter.vx, putter.vy,
-        putter.confidence, putter.valid ? "true" : "false",
         stats.putt_number, stats.state_str(),
         stats.launch_speed, stats.current_speed,
         stats.peak_speed, stats.total_distance,
         stats.break_distance, stats.time_in_motion,
         stats.start_x, stats.start_y,
         stats.final_x, stats.final_y);
+    return m >= 0 && m < static_cast<int>(cap) - n ? n + m : -1;
+}
 
-    if (n < 0 || n >= static_cast<int>(sizeof(buf))) {
-        std::cerr << "[UnrealSender] JSON format error\n";
-        return false;
-    }
+int UnrealSender::encode_binary(uint8_t* buf, size_t cap, const TrackedObject& ball,
+                                const TrackedObject& putter, const PuttData& stats,
+                                int stream_id, uint32_t sequence, bool keyframe,
+                                bool predicted, uint64_t capture_us,
+                                uint64_t now_us) const {
+    wire::StatePacket pkt;
+    pkt.type = opts_.stats ? wire::PacketType::STATE : wire::PacketType::KINEMATICS;
+    pkt.sequence = sequence;
+    pkt.stream_id = static_cast<uint16_t>(stream_id);
+    pkt.flags = (ball.valid ? wire::kBallVisible : 0) |
+                (putter.valid ? wire::kPutterVisible : 0) |
+                (keyframe ? wire::kKeyframe : 0) |
+                (predicted ? wire::kPredicted : 0);
+    pkt.capture_time_us = capture_us;
+    pkt.send_time_us = now_us;
+    pkt.ball = {ball.x, ball.y, ball.vx, ball.vy, ball.confidence};
+    pkt.putter = {putter.x, putter.y, putter.vx, putter.vy, putter.confidence};
 
-    ssize_t sent = sendto(sock_fd_, buf, n, 0,
-                          reinterpret_cast<sockaddr*>(dest_addr_),
-                          sizeof(*dest_addr_));
-    if (sent < 0) {
-        std::cerr << "[UnrealSender] sendto() failed\n";
-        return false;
-    }
-    return true;
+    wire::PuttState& s = pkt.stats;
+    s.putt_number = stats.putt_number;
+    s.phase = static_cast<wire::PuttPhase>(stats.state);
+    s.launch_speed = stats.launch_speed;
+    s.current_speed = stats.current_speed;
+    s.peak_speed = stats.peak_speed;
+    s.total_distance = stats.total_distance;
+    s.break_distance = stats.break_distance;
+    s.time_in_motion = stats.time_in_motion;
+    s.start_x = stats.start_x;
+    s.start_y = stats.start_y;
+    s.final_x = stats.final_x;
+    s.final_y = stats.final_y;
+
+    return static_cast<int>(wire::encode(pkt, buf, cap));
 }
 
 void UnrealSender::close() {
+    flush();
     if (sock_fd_ >= 0) {
         ::close(sock_fd_);
         sock_fd_ = -1;
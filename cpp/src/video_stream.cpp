@@ -0,0 +1,159 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// video_stream.cpp  –  MJPEG Encoder Thread & Client Hand-off
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "video_stream.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <iostream>
+
+namespace golf {
+
+VideoStream::VideoStream(int sources, const VideoStreamOptions& opts)
+    : opts_(opts),
+      period_(std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(1.0 / std::max(opts.fps, 0.1)))) {
+    opts_.width = std::max(opts_.width, 16);
+    opts_.quality = std::clamp(opts_.quality, 1, 100);
+    for (int i = 0; i < sources; ++i) {
+        bays_.push_back(std::make_unique<Bay>());
+    }
+}
+
+VideoStream::~VideoStream() {
+    stop();
+}
+
+void VideoStream::start() {
+    if (running_.exchange(true)) return;
+    thread_ = std::thread(&VideoStream::run, this);
+    std::cout << "[VideoStream] MJPEG at " << opts_.fps << " fps, "
+              << opts_.width << " px wide, quality " << opts_.quality << "\n";
+}
+
+void VideoStream::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    encode_cv_.notify_all();
+    part_cv_.notify_all();     // release open streams
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool VideoStream::watching(int source) const {
+    return source >= 0 && source < sources() &&
+           bays_[source]->clients.load(std::memory_order_relaxed) > 0;
+}
+
+// ─── Preview side ───────────────────────────────────────────────────────────
+void VideoStream::offer(int source, const cv::Mat& annotated) {
+    if (!watching(source) || annotated.empty()) return;
+    Bay& b = *bays_[source];
+    const auto now = Clock::now();
+    if (now < b.next_due) return;
+    b.next_due += period_;
+    if (b.next_due < now) b.next_due = now + period_;
+
+    if (annotated.cols > opts_.width) {
+        const int h = std::max(1, annotated.rows * opts_.width / annotated.cols);
+        cv::resize(annotated, b.staged, cv::Size(opts_.width, h), 0, 0, cv::INTER_AREA);
+    } else {
+        annotated.copyTo(b.staged);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::swap(b.pending, b.staged);
+        b.fresh = true;
+    }
+    encode_cv_.notify_one();
+}
+
+// ─── Encoder thread ─────────────────────────────────────────────────────────
+void VideoStream::run() {
+    const std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, opts_.quality};
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        encode_cv_.wait(lock, [&] {
+            if (!running_) return true;
+            for (const auto& b : bays_) {
+                if (b->fresh) return true;
+            }
+            return false;
+        });
+        for (auto& bp : bays_) {
+            Bay& b = *bp;
+            if (!running_ || !b.fresh) continue;
+            std::swap(b.encoding, b.pending);
+            b.fresh = false;
+
+            lock.unlock();
+            auto part = std::make_shared<std::string>();
+            if (cv::imencode(".jpg", b.encoding, b.jpeg, params)) {
+                char head[128];
+                const int n = std::snprintf(head, sizeof(head),
+                    "--%s\r\nContent-Type: image/jpeg\r\nContent-Length: %zu\r\n\r\n",
+                    boundary(), b.jpeg.size());
+                part->reserve(n + b.jpeg.size() + 2);
+                part->append(head, n);
+                part->append(reinterpret_cast<const char*>(b.jpeg.data()), b.jpeg.size());
+                part->append("\r\n");
+                b.frames.fetch_add(1, std::memory_order_relaxed);
+                b.bytes.fetch_add(part->size(), std::memory_order_relaxed);
+            } else {
+                part.reset();
+            }
+            lock.lock();
+
+            if (part) {
+                b.part = std::move(part);
+                ++b.seq;
+                part_cv_.notify_all();
+            }
+        }
+    }
+}
+
+// ─── HTTP side ──────────────────────────────────────────────────────────────
+void VideoStream::subscribe(int source) {
+    if (source < 0 || source >= sources()) return;
+    bays_[source]->clients.fetch_add(1, std::memory_order_relaxed);
+}
+
+void VideoStream::unsubscribe(int source) {
+    if (source < 0 || source >= sources()) return;
+    bays_[source]->clients.fetch_sub(1, std::memory_order_relaxed);
+}
+
+std::shared_ptr<const std::string> VideoStream::wait_part(
+    int source, uint64_t& seq, std::chrono::milliseconds timeout) {
+    if (source < 0 || source >= sources()) return nullptr;
+    Bay& b = *bays_[source];
+    std::unique_lock<std::mutex> lock(mutex_);
+    part_cv_.wait_for(lock, timeout, [&] { return !running_ || b.seq > seq; });
+    if (!running_ || b.seq <= seq || !b.part) return nullptr;
+    seq = b.seq;
+    return b.part;
+}
+
+std::string VideoStream::to_json() const {
+    char buf[192];
+    std::snprintf(buf, sizeof(buf), "{\"fps\":%.2f,\"width\":%d,\"quality\":%d,\"bays\":[",
+                  opts_.fps, opts_.width, opts_.quality);
+    std::string out = buf;
+    for (size_t i = 0; i < bays_.size(); ++i) {
+        const Bay& b = *bays_[i];
+        std::snprintf(buf, sizeof(buf),
+            "%s{\"bay\":%zu,\"clients\":%d,\"frames\":%" PRIu64 ",\"bytes\":%" PRIu64 "}",
+            i ? "," : "", i, b.clients.load(), b.frames.load(), b.bytes.load());
+        out += buf;
+    }
+    out += "]}";
+    return out;
+}
+
+}  // namespace golf
@@ -0,0 +1,108 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// cpu_preprocess_test.cpp  –  CPU Kernel Exactness
+//
+// Every kernel this machine supports must reproduce the original OpenCV
+// path bit for bit:
+//
+//   cvtColor(BGR2RGB) → convertTo(CV_32F, 1/255) → split into CHW planes
+//
+// Sizes cover the vector tails (widths that are not a multiple of 16 / 32),
+// single-row and odd-height images, images tall enough to be split across
+// threads, and non-continuous ROI views with odd offsets.  A guard after
+// the output catches a kernel writing past it.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "cpu_preprocess.h"
+
+#include <opencv2/opencv.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+constexpr size_t kGuard = 64;                 // floats after the planes
+constexpr float  kSentinel = -1.0f;
+
+/// The pre-kernel implementation of FramePipeline::preprocess's last pass.
+void reference(const cv::Mat& bgr, std::vector<float>& out) {
+    cv::Mat rgb, f32;
+    cv::cvtColor(bgr, rgb, cv::COLOR_BGR2RGB);
+    rgb.convertTo(f32, CV_32F, 1.0 / 255.0);
+
+    const size_t plane = static_cast<size_t>(bgr.rows) * bgr.cols;
+    out.assign(3 * plane, 0.f);
+    std::vector<cv::Mat> planes;
+    for (int c = 0; c < 3; ++c) {
+        planes.emplace_back(bgr.rows, bgr.cols, CV_32F, out.data() + c * plane);
+    }
+    cv::split(f32, planes);
+}
+
+/// Run `kernel` on `bgr` and compare with the reference.
+bool check(golf::CpuKernel kernel, const cv::Mat& bgr, const char* what) {
+    std::vector<float> expected;
+    reference(bgr, expected);
+
+    std::vector<float> actual(expected.size() + kGuard, kSentinel);
+    golf::bgr_to_planar_rgb(bgr, actual.data(), kernel);
+
+    for (size_t i = 0; i < expected.size(); ++i) {
+        if (std::memcmp(&actual[i], &expected[i], sizeof(float)) != 0) {
+            const size_t plane = static_cast<size_t>(bgr.rows) * bgr.cols;
+            std::cerr << "[cpu_preprocess_test] " << golf::cpu_kernel_name(kernel) << " "
+                      << what << " " << bgr.cols << "x" << bgr.rows << ": channel "
+                      << i / plane << " pixel " << i % plane << " is " << actual[i]
+                      << ", OpenCV gives " << expected[i] << "\n";
+            return false;
+        }
+    }
+    for (size_t i = expected.size(); i < actual.size(); ++i) {
+        if (actual[i] != kSentinel) {
+            std::cerr << "[cpu_preprocess_test] " << golf::cpu_kernel_name(kernel) << " "
+                      << what << " " << bgr.cols << "x" << bgr.rows
+                      << ": wrote past the output\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    const int widths[] = {1, 2, 7, 15, 16, 17, 31, 32, 33, 47, 63, 64, 65, 641, 1283};
+    const int heights[] = {1, 2, 3, 17, 31, 67};   // 67: split across threads
+
+    cv::RNG rng(0x601f);
+    int rc = 0;
+    int kernels = 0;
+    for (const golf::CpuKernel kernel : {golf::CpuKernel::SCALAR, golf::CpuKernel::AVX2,
+                                         golf::CpuKernel::NEON, golf::CpuKernel::AUTO}) {
+        if (!golf::cpu_kernel_supported(kernel)) continue;
+        ++kernels;
+        int cases = 0;
+        for (const int w : widths) {
+            for (const int h : heights) {
+                cv::Mat frame(h, w, CV_8UC3);
+                rng.fill(frame, cv::RNG::UNIFORM, 0, 256);
+                if (!check(kernel, frame, "continuous")) rc = 1;
+
+                // ROI of a wider, taller image: padded rows, odd x offset
+                cv::Mat parent(h + 4, w + 13, CV_8UC3);
+                rng.fill(parent, cv::RNG::UNIFORM, 0, 256);
+                const cv::Mat roi = parent(cv::Rect(5, 3, w, h));
+                if (!check(kernel, roi, "roi")) rc = 1;
+                cases += 2;
+            }
+        }
+        std::printf("[cpu_preprocess_test] %s: %d images match OpenCV\n",
+                    golf::cpu_kernel_name(kernel), cases);
+    }
+    if (kernels < 2) {
+        std::printf("[cpu_preprocess_test] only SCALAR is supported here\n");
+    }
+    return rc;
+}
@@ -0,0 +1,102 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// putt_stats_test.cpp  –  Putts Whose Ball Track Ends
+//
+// A multi-ball slot whose track goes invalid mid-putt (the ball dropped in
+// the cup or left the frame) must finish that putt: it is recorded, and
+// current() stops reporting IN_MOTION – or follows a ball still rolling.
+// A slot handed to a new track id must not swallow the unfinished putt.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "putt_stats.h"
+#include "tracker.h"
+
+#include <cstdio>
+#include <iostream>
+
+namespace {
+
+constexpr double kDt = 1.0 / 60.0;
+
+golf::TrackedObject rolling(uint32_t id, float x) {
+    golf::TrackedObject b;
+    b.id = id;
+    b.x = x;
+    b.y = 100.f;
+    b.vx = 300.f;
+    b.confidence = 0.9f;
+    b.valid = true;
+    return b;
+}
+
+/// Feed `frames` frames of a ball rolling right on `slot`.
+void roll(golf::PuttStats& stats, int slot, uint32_t id, float& x, int frames) {
+    for (int i = 0; i < frames; ++i, x += 5.f) stats.update(slot, rolling(id, x), kDt);
+}
+
+bool expect(bool ok, const char* what) {
+    if (!ok) std::cerr << "[putt_stats_test] " << what << "\n";
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    int rc = 0;
+
+    // Track goes invalid mid-putt
+    {
+        golf::PuttStats stats;
+        float x = 0.f;
+        roll(stats, 2, 7, x, 10);
+        if (!expect(stats.current().state == golf::PuttState::IN_MOTION,
+                    "rolling ball is not IN_MOTION")) rc = 1;
+
+        golf::TrackedObject lost = rolling(7, x);
+        lost.valid = false;
+        stats.update(2, lost, kDt);
+        const golf::PuttData cur = stats.current();
+        if (!expect(cur.state == golf::PuttState::STOPPED,
+                    "current() still IN_MOTION after the track ended") ||
+            !expect(stats.history().size() == 1, "ended putt was not recorded") ||
+            !expect(cur.total_distance > 0.f, "ended putt lost its distance")) {
+            rc = 1;
+        }
+    }
+
+    // The published ball ends while another is still rolling
+    {
+        golf::PuttStats stats;
+        float xa = 0.f, xb = 500.f;
+        roll(stats, 0, 1, xa, 5);
+        roll(stats, 1, 2, xb, 5);
+        golf::TrackedObject lost = rolling(1, xa);
+        lost.valid = false;
+        stats.update(0, lost, kDt);
+        roll(stats, 1, 2, xb, 1);
+        const golf::PuttData cur = stats.current();
+        if (!expect(cur.state == golf::PuttState::IN_MOTION && cur.ball_id == 2,
+                    "current() did not move on to the ball still rolling") ||
+            !expect(stats.history().size() == 1, "ended putt was not recorded")) {
+            rc = 1;
+        }
+    }
+
+    // Slot reused by a new track while the old putt was in progress
+    {
+        golf::PuttStats stats;
+        float x = 0.f;
+        roll(stats, 3, 4, x, 10);
+        golf::TrackedObject other = rolling(9, 0.f);
+        other.vx = 0.f;
+        stats.update(3, other, kDt);
+        if (!expect(stats.history().size() == 1,
+                    "unfinished putt dropped when the slot was reused") ||
+            !expect(stats.current().state != golf::PuttState::IN_MOTION,
+                    "current() still IN_MOTION after the slot was reused")) {
+            rc = 1;
+        }
+    }
+
+    if (rc == 0) std::printf("[putt_stats_test] ended tracks finish their putts\n");
+    return rc;
+}
@@ -0,0 +1,166 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// spsc_ring_test.cpp  –  Ring Ordering and Latest-Wins Eviction
+//
+// A producer and a consumer thread pass numbered items through a small
+// ring.  Blocking pushes must deliver every item once and in order.  With
+// latest-wins pushes (pop the oldest when full, as StagedPipeline does for
+// DropPolicy::LATEST) the consumer must see increasing numbers, every item
+// either delivered or evicted – never both, never neither – and the last
+// item delivered.  Items are heap-allocated, so a slot read twice or
+// before it was written shows up as a null pointer.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "spsc_ring.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Item = std::unique_ptr<uint64_t>;
+
+std::string describe(const Item& item) {
+    return item ? std::to_string(*item) : std::string("an empty slot");
+}
+
+constexpr uint64_t kItems = 200000;
+constexpr size_t   kCapacity = 4;
+
+// A consumer slightly slower than the producer keeps the ring full, so
+// the producer's evictions race the consumer's pops for the oldest slot
+constexpr int kProducerWork = 100;
+constexpr int kConsumerWork = 150;
+
+void spin(int n) {
+    for (volatile int i = 0; i < n; i = i + 1) {}
+}
+
+/// Blocking producer: every item reaches the consumer once, in order.
+bool check_order() {
+    golf::SpscRing<Item> ring(kCapacity);
+    std::atomic<bool> done{false};
+    std::thread producer([&] {
+        for (uint64_t i = 1; i <= kItems; ++i) {
+            Item item = std::make_unique<uint64_t>(i);
+            while (!ring.try_push(std::move(item))) std::this_thread::yield();
+        }
+        done = true;
+    });
+
+    // Drain until the producer is done even after a failure, so it never
+    // blocks on a full ring
+    bool ok = true;
+    uint64_t expected = 1;
+    for (;;) {
+        const bool finished = done;
+        Item item;
+        if (!ring.try_pop(item)) {
+            if (finished) break;
+            std::this_thread::yield();
+            continue;
+        }
+        if (ok && (!item || *item != expected)) {
+            std::cerr << "[spsc_ring_test] order: expected " << expected << ", got "
+                      << describe(item) << "\n";
+            ok = false;
+        }
+        ++expected;
+    }
+    producer.join();
+    if (ok && expected != kItems + 1) {
+        std::cerr << "[spsc_ring_test] order: " << expected - 1 << " of " << kItems
+                  << " items delivered\n";
+        ok = false;
+    }
+    if (ok) {
+        std::printf("[spsc_ring_test] %llu items delivered in order\n",
+                    static_cast<unsigned long long>(kItems));
+    }
+    return ok;
+}
+
+/// Latest-wins producer racing the consumer for the oldest item.
+bool check_latest() {
+    golf::SpscRing<Item> ring(kCapacity);
+    std::vector<uint8_t> evicted(kItems + 1, 0);     // producer only
+    std::vector<uint8_t> delivered(kItems + 1, 0);   // consumer only
+    bool producer_ok = true;
+    std::atomic<bool> done{false};
+
+    std::thread producer([&] {
+        for (uint64_t i = 1; i <= kItems; ++i) {
+            Item item = std::make_unique<uint64_t>(i);
+            while (!ring.try_push(std::move(item))) {
+                Item oldest;
+                if (!ring.try_pop(oldest)) continue;   // the consumer took it
+                if (!oldest) {
+                    producer_ok = false;
+                } else {
+                    evicted[*oldest] = 1;
+                }
+            }
+            spin(kProducerWork);
+        }
+        done = true;
+    });
+
+    bool ok = true;
+    uint64_t last = 0;
+    for (;;) {
+        const bool finished = done;
+        Item item;
+        if (!ring.try_pop(item)) {
+            if (finished) break;
+            std::this_thread::yield();
+            continue;
+        }
+        if (ok && (!item || *item <= last)) {
+            std::cerr << "[spsc_ring_test] latest: got " << describe(item)
+                      << " after " << last << "\n";
+            ok = false;
+        }
+        if (!item) continue;
+        last = *item;
+        delivered[last] = 1;
+        spin(kConsumerWork);
+    }
+    producer.join();
+    if (!producer_ok) {
+        std::cerr << "[spsc_ring_test] latest: evicted an empty slot\n";
+        return false;
+    }
+    if (!ok) return false;
+
+    uint64_t dropped = 0;
+    for (uint64_t i = 1; i <= kItems; ++i) {
+        if (evicted[i] == delivered[i]) {
+            std::cerr << "[spsc_ring_test] latest: item " << i << " was "
+                      << (evicted[i] ? "evicted and delivered" : "lost") << "\n";
+            return false;
+        }
+        dropped += evicted[i];
+    }
+    if (!delivered[kItems]) {
+        std::cerr << "[spsc_ring_test] latest: the last item was not delivered\n";
+        return false;
+    }
+    std::printf("[spsc_ring_test] latest: %llu delivered, %llu evicted, last one "
+                "delivered\n", static_cast<unsigned long long>(kItems - dropped),
+                static_cast<unsigned long long>(dropped));
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    int rc = 0;
+    if (!check_order()) rc = 1;
+    if (!check_latest()) rc = 1;
+    return rc;
+}
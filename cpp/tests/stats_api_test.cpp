@@ -0,0 +1,155 @@
+// ─────────────────────────────────────────────────────────────────────────────
+// stats_api_test.cpp  –  REST API Responsiveness and Write Protection
+//
+// Opens /api/stats/stream connections until the server turns one away with
+// 503 (the subscriber cap), then checks that /api/stats/history and
+// /api/bays still answer while every one of those streams is held open.
+//
+// POST /api/config must refuse clients without the token and bodies a
+// browser could send cross-origin without a preflight.
+//
+// stop() straight after start() must return even though the server thread
+// may not have reached listen() yet.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#include "httplib.h"
+#include "putt_stats.h"
+#include "runtime_config.h"
+#include "stats_api.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr uint16_t kPort = 18431;
+constexpr int kMaxStreams = 512;      // give up if no cap shows up by then
+constexpr char kToken[] = "test-token";
+
+/// Open a stream and return its socket once the response status is known;
+/// `status` is the HTTP status code (-1 if the server didn't answer).
+int open_stream(int& status) {
+    status = -1;
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    timeval tv{5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(kPort);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    static const char request[] =
+        "GET /api/stats/stream HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        send(fd, request, sizeof(request) - 1, 0) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    char buf[64] = {};
+    if (recv(fd, buf, sizeof(buf) - 1, 0) > 9 && std::strncmp(buf, "HTTP/1.1 ", 9) == 0) {
+        status = std::atoi(buf + 9);
+    }
+    return fd;
+}
+
+bool check_get(httplib::Client& cli, const char* path) {
+    const auto t0 = std::chrono::steady_clock::now();
+    const auto res = cli.Get(path);
+    const double ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - t0).count();
+    if (!res || res->status != 200) {
+        std::cerr << "[stats_api_test] GET " << path << " failed with the stream cap reached"
+                  << " (" << (res ? std::to_string(res->status) : httplib::to_string(res.error()))
+                  << ")\n";
+        return false;
+    }
+    std::printf("[stats_api_test] GET %s -> 200 in %.1f ms\n", path, ms);
+    return true;
+}
+
+bool check_post(httplib::Client& cli, const httplib::Headers& headers,
+                const char* type, int expected) {
+    const auto res = cli.Post("/api/config", headers, "{\"detection\":{\"conf_thresh\":0.4}}",
+                              type);
+    const int status = res ? res->status : -1;
+    if (status != expected) {
+        std::cerr << "[stats_api_test] POST /api/config (" << type << ") -> " << status
+                  << ", expected " << expected << "\n";
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    golf::PuttStats stats;
+    golf::RuntimeConfig runtime(1, golf::BayParams{});
+    golf::StatsApi api(stats, kPort);
+    api.set_config(&runtime, kToken);
+    api.start();
+
+    httplib::Client cli("127.0.0.1", kPort);
+    cli.set_connection_timeout(2);
+    cli.set_read_timeout(2);
+    for (int i = 0; i < 100 && !cli.Get("/api/bays"); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    std::vector<int> streams;
+    int status = 200;
+    while (status == 200 && static_cast<int>(streams.size()) < kMaxStreams) {
+        const int fd = open_stream(status);
+        if (fd < 0) break;
+        if (status == 200) {
+            streams.push_back(fd);
+        } else {
+            ::close(fd);
+        }
+    }
+
+    int rc = 0;
+    if (status != 503) {
+        std::cerr << "[stats_api_test] expected 503 after " << streams.size()
+                  << " streams, got " << status << "\n";
+        rc = 1;
+    } else {
+        std::printf("[stats_api_test] %zu streams open, next one refused\n", streams.size());
+        if (!check_get(cli, "/api/stats/history")) rc = 1;
+        if (!check_get(cli, "/api/bays")) rc = 1;
+    }
+
+    for (const int fd : streams) ::close(fd);
+
+    const httplib::Headers auth = {{"Authorization", std::string("Bearer ") + kToken}};
+    if (!check_post(cli, {}, "application/json", 401) ||
+        !check_post(cli, {{"Authorization", "Bearer wrong"}}, "application/json", 401) ||
+        !check_post(cli, auth, "text/plain", 415) ||
+        !check_post(cli, auth, "application/json", 200)) {
+        rc = 1;
+    } else if (runtime.bay(0).conf_thresh != 0.4f) {
+        std::cerr << "[stats_api_test] accepted POST did not change the config\n";
+        rc = 1;
+    } else {
+        std::printf("[stats_api_test] POST /api/config: token and Content-Type enforced\n");
+    }
+    api.stop();
+
+    golf::StatsApi early(stats, kPort + 1);
+    early.start();
+    early.stop();
+    std::printf("[stats_api_test] stop() right after start() returned\n");
+    return rc;
+}